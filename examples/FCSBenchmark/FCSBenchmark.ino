@@ -0,0 +1,78 @@
+#include <BLE.h>
+#include <ti/npi/npi_util.h>
+
+/*
+ * Times the NPI frame check sequence kernel against a byte at a time XOR
+ * loop and prints, for a few frame sizes, the microseconds per frame each
+ * one takes. Both must agree on the FCS.
+ *
+ * No BoosterPack needed, nothing is sent to the network processor.
+ *
+ * This runs on the LaunchPad only. The kernel lives in npi_util.c, which
+ * is built against TI-RTOS, so there is no workstation build to time it in.
+ */
+
+/* Largest frame the default NPI buffer holds. */
+#define MAX_FRAME 530
+
+/* Frames checksummed per measurement. */
+#define ROUNDS 1000
+
+uint8_t frame[MAX_FRAME];
+uint16_t sizes[] = {4, 24, 64, 256, MAX_FRAME};
+
+/* volatile so the compiler cannot drop the loops below. */
+volatile uint8_t sink;
+
+uint8_t byteFCS(const uint8_t *buf, uint16_t len) {
+  uint8_t fcs = 0;
+  while (len--)
+  {
+    fcs ^= *buf++;
+  }
+  return fcs;
+}
+
+void setup() {
+  Serial.begin(115200);
+  for (uint16_t i = 0; i < MAX_FRAME; i++)
+  {
+    frame[i] = i * 7 + 3;
+  }
+}
+
+void loop() {
+  for (uint8_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+  {
+    uint16_t len = sizes[s];
+
+    unsigned long start = micros();
+    for (uint16_t r = 0; r < ROUNDS; r++)
+    {
+      /* Odd start offset exercises the unaligned head as a frame would. */
+      sink = byteFCS(&frame[1], len - 1);
+    }
+    unsigned long byteTime = micros() - start;
+
+    start = micros();
+    for (uint16_t r = 0; r < ROUNDS; r++)
+    {
+      sink = NPIUtil_calcFCS(0, &frame[1], len - 1);
+    }
+    unsigned long wordTime = micros() - start;
+
+    Serial.print("bytes:");
+    Serial.print(len - 1);
+    Serial.print(" byte loop ns/frame:");
+    Serial.print(byteTime * 1000 / ROUNDS);
+    Serial.print(" word kernel ns/frame:");
+    Serial.print(wordTime * 1000 / ROUNDS);
+    if (byteFCS(&frame[1], len - 1) != NPIUtil_calcFCS(0, &frame[1], len - 1))
+    {
+      Serial.print(" MISMATCH");
+    }
+    Serial.println();
+  }
+  Serial.println();
+  delay(5000);
+}
@@ -0,0 +1,84 @@
+#include <BLE.h>
+
+/*
+ * Streams notifications on the serial-over-BLE TX characteristic while
+ * asking the network processor for its status every few milliseconds, and
+ * prints once per second how long frames on each NPI TX lane took to reach
+ * the wire. Notifications already queued keep going out while a status
+ * request waits for its response; "interleaved" counts them.
+ *
+ * Build with NPITASK_SYNC_INTERLEAVE set to 0 to compare with holding every
+ * async frame back until the response arrives.
+ *
+ * Connect with any BLE UART app and enable notifications on "Client RX".
+ */
+
+/* Bytes per notification; 20 fits a default 23 byte ATT MTU. */
+#define CHUNK_SIZE 20
+
+/* Time between status requests, in ms. */
+#define STATUS_PERIOD 20
+
+const char *laneNames[NPITASK_LANES] = {"control", "cnf", "bulk"};
+
+uint8_t chunk[CHUNK_SIZE];
+
+unsigned long windowStart = 0;
+unsigned long lastStatus = 0;
+
+void setup() {
+  Serial.begin(115200);
+  ble.setLogLevel(BLE_LOG_ERRORS);
+  for (uint8_t i = 0; i < CHUNK_SIZE; i++)
+  {
+    chunk[i] = 'A' + i;
+  }
+  ble.begin();
+  ble.serial();
+  ble.setAdvertName("Energia Lanes");
+  ble.startAdvert();
+}
+
+void report(unsigned long now) {
+  BLE_Transport_Stats stats;
+
+  ble.getTransportStats(&stats, true);
+  for (uint8_t i = 0; i < NPITASK_LANES; i++)
+  {
+    Serial.print(laneNames[i]);
+    Serial.print(" frames:");
+    Serial.print(stats.lane[i].frames);
+    Serial.print(" avg us:");
+    Serial.print(stats.lane[i].avgUs);
+    Serial.print(" p99 us:");
+    Serial.print(stats.lane[i].p99Us);
+    Serial.print(" max us:");
+    Serial.print(stats.lane[i].maxUs);
+    Serial.print("  ");
+  }
+  Serial.print("sync rpcs:");
+  Serial.print(stats.syncRpcCount);
+  Serial.print(" interleaved:");
+  Serial.println(stats.syncInterleaved);
+  windowStart = now;
+}
+
+void loop() {
+  ble.handleEvents();
+  if (ble.isConnected())
+  {
+    ble.write(chunk, CHUNK_SIZE);
+  }
+  unsigned long now = millis();
+  if (now - lastStatus >= STATUS_PERIOD)
+  {
+    BLE_Get_Status_Rsp status;
+
+    ble.getStatus(&status);
+    lastStatus = now;
+  }
+  if (now - windowStart >= 1000)
+  {
+    report(now);
+  }
+}
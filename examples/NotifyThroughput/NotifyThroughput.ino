@@ -0,0 +1,69 @@
+#include <BLE.h>
+
+/*
+ * Streams notifications on the serial-over-BLE TX characteristic as fast as
+ * the link allows and prints, once per second, how many bytes were sent and
+ * how long the MSP432 spent inside ble.write() per frame.
+ *
+ * Connect with any BLE UART app and enable notifications on "Client RX".
+ */
+
+/* Bytes per notification; 20 fits a default 23 byte ATT MTU. */
+#define CHUNK_SIZE 20
+
+uint8_t chunk[CHUNK_SIZE];
+
+unsigned long windowStart = 0;
+unsigned long bytesSent = 0;
+unsigned long framesSent = 0;
+unsigned long writeMicros = 0;
+
+void setup() {
+  Serial.begin(115200);
+  ble.setLogLevel(BLE_LOG_ERRORS);
+  for (uint8_t i = 0; i < CHUNK_SIZE; i++)
+  {
+    chunk[i] = 'A' + i;
+  }
+  ble.begin();
+  ble.serial();
+  ble.setAdvertName("Energia Throughput");
+  ble.startAdvert();
+}
+
+void report(unsigned long now) {
+  Serial.print("bytes/s:");
+  Serial.print(bytesSent * 1000 / (now - windowStart));
+  Serial.print(" frames:");
+  Serial.print(framesSent);
+  if (framesSent)
+  {
+    Serial.print(" us/write:");
+    Serial.print(writeMicros / framesSent);
+  }
+  Serial.println();
+  bytesSent = 0;
+  framesSent = 0;
+  writeMicros = 0;
+  windowStart = now;
+}
+
+void loop() {
+  ble.handleEvents();
+  if (ble.isConnected())
+  {
+    unsigned long start = micros();
+    size_t sent = ble.write(chunk, CHUNK_SIZE);
+    writeMicros += micros() - start;
+    if (sent)
+    {
+      bytesSent += sent;
+      framesSent++;
+    }
+  }
+  unsigned long now = millis();
+  if (now - windowStart >= 1000)
+  {
+    report(now);
+  }
+}
@@ -0,0 +1,85 @@
+#include <BLE.h>
+
+/*
+ * Runs a typical advertising setup (three advertising payloads, two GAP
+ * parameters, then starting to advertise) every few seconds and prints
+ * how long it took and how each command went.
+ *
+ * With USE_PIPELINE set to 1 the advertising commands are sent back to
+ * back and their confirmations collected at the end. With 0 each one waits
+ * for its own confirmation first, a full round trip to the network
+ * processor apiece.
+ */
+
+#define USE_PIPELINE 1
+
+/* Time between runs, in ms. */
+#define PERIOD 3000
+
+static uint8_t notConnData[] =
+{
+  0x02, SAP_GAP_ADTYPE_FLAGS,
+  SAP_GAP_ADTYPE_FLAGS_GENERAL | SAP_GAP_ADTYPE_FLAGS_BREDR_NOT_SUPPORTED,
+  0x05, 0xFF, LO_UINT16(TI_COMPANY_ID), HI_UINT16(TI_COMPANY_ID), 0x01, 0x02
+};
+
+static uint8_t connData[] =
+{
+  0x02, SAP_GAP_ADTYPE_FLAGS,
+  SAP_GAP_ADTYPE_FLAGS_GENERAL | SAP_GAP_ADTYPE_FLAGS_BREDR_NOT_SUPPORTED
+};
+
+static uint8_t scanRspData[] =
+{
+  0x0E, SAP_GAP_ADTYPE_LOCAL_NAME_COMPLETE,
+  'E', 'n', 'e', 'r', 'g', 'i', 'a', ' ', 'P', 'i', 'p', 'e', 's'
+};
+
+void setup() {
+  Serial.begin(115200);
+  ble.setLogLevel(BLE_LOG_ERRORS);
+  ble.begin();
+}
+
+void configure(BLE_Pipeline_Result *result) {
+#if USE_PIPELINE
+  ble.beginPipeline();
+#endif
+  ble.setAdvertData(BLE_ADV_DATA_NOTCONN, sizeof(notConnData), notConnData);
+  ble.setAdvertData(BLE_ADV_DATA_CONN, sizeof(connData), connData);
+  ble.setAdvertData(BLE_ADV_DATA_SCANRSP, sizeof(scanRspData), scanRspData);
+  ble.setGapParam(SAP_CONN_ADV_INT_MIN, 160);
+  ble.setGapParam(SAP_CONN_ADV_INT_MAX, 160);
+  ble.startAdvert();
+#if USE_PIPELINE
+  ble.endPipeline(result);
+#else
+  result->count = 0;
+#endif
+}
+
+void loop() {
+  BLE_Pipeline_Result result;
+
+  if (ble.isAdvertising())
+  {
+    ble.stopAdvert();
+  }
+  unsigned long start = micros();
+  configure(&result);
+  unsigned long elapsed = micros() - start;
+
+  Serial.print("pipeline:");
+  Serial.print(USE_PIPELINE);
+  Serial.print(" setup us:");
+  Serial.print(elapsed);
+  for (uint8_t i = 0; i < result.count; i++)
+  {
+    Serial.print(" 0x");
+    Serial.print(result.cmd[i].opcode, HEX);
+    Serial.print(":0x");
+    Serial.print(result.cmd[i].status, HEX);
+  }
+  Serial.println();
+  delay(PERIOD);
+}
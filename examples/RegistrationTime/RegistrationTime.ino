@@ -0,0 +1,58 @@
+#include <BLE.h>
+
+/*
+ * Registers a service with NUM_CHARS characteristics every few seconds,
+ * restarting the network processor in between, and prints how long
+ * addService took in total and per characteristic.
+ *
+ * The declarations of a service are sent in batches of up to
+ * SNP_SYNC_BATCH_DEPTH requests, each one going out as soon as the previous
+ * one is answered. Build with SNP_SYNC_BATCH_DEPTH set to 2 to compare with
+ * waiting for the answers to every characteristic before declaring the
+ * next.
+ */
+
+#define NUM_CHARS 40
+
+/* Time between runs, in ms. */
+#define PERIOD 3000
+
+BLE_Char benchChars[NUM_CHARS];
+BLE_Char *benchServiceChars[NUM_CHARS];
+
+BLE_Service benchService =
+{
+  {0xF0, 0xFF},
+  NUM_CHARS, benchServiceChars
+};
+
+void setup() {
+  Serial.begin(115200);
+  ble.setLogLevel(BLE_LOG_ERRORS);
+  for (uint8_t i = 0; i < NUM_CHARS; i++)
+  {
+    benchChars[i].UUID[0] = i + 1;
+    benchChars[i].UUID[1] = 0xFF;
+    benchChars[i].properties = BLE_READABLE | BLE_NOTIFIABLE;
+    benchChars[i].charDesc = "Bench";
+    benchServiceChars[i] = &benchChars[i];
+  }
+}
+
+void loop() {
+  ble.begin();
+  unsigned long start = millis();
+  int status = ble.addService(&benchService);
+  unsigned long elapsed = millis() - start;
+  ble.end();
+
+  Serial.print("chars:");
+  Serial.print(NUM_CHARS);
+  Serial.print(" status:");
+  Serial.print(status);
+  Serial.print(" ms:");
+  Serial.print(elapsed);
+  Serial.print(" ms per char:");
+  Serial.println((float) elapsed / NUM_CHARS);
+  delay(PERIOD);
+}
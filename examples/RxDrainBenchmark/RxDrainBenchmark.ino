@@ -0,0 +1,83 @@
+#include <BLE.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/npi/npi_task.h>
+#include <ti/npi/npi_tl_loopback.h>
+
+/*
+ * Prints how many received NPI frames per second the NPI task routes when
+ * they arrive back to back, the way characteristic writes do when a client
+ * sends them in a burst.
+ *
+ * The loopback transport stands in for the network processor, so no
+ * BoosterPack is needed. Each burst is delivered with task switching held
+ * off, which leaves the frames waiting in the RX queue for the NPI task to
+ * drain. Build with NPITASK_RX_BUDGET set to 1 to compare with routing one
+ * frame per wake-up.
+ */
+
+/* Frames per burst, at most what the loopback transport holds. */
+#define BURST NPITLLOOP_RX_DEPTH
+
+/* Bytes a client writes per frame; 20 fits a default 23 byte ATT MTU. */
+#define WRITE_SIZE 20
+
+/* How long each measurement runs for, in ms. */
+#define WINDOW 2000
+
+/* SNP_CHAR_WRITE_IND parameters: connection, attribute, no response
+ * needed, offset 0, then the value written. */
+uint8_t writeInd[7 + WRITE_SIZE] = {0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00};
+
+volatile unsigned long routed = 0;
+
+void countFrame(_npiFrame_t *pMsg) {
+  routed++;
+  NPITask_freeFrame(pMsg);
+}
+
+void setup() {
+  NPI_Params params;
+
+  Serial.begin(115200);
+  NPITask_Params_init(&params);
+  NPITask_Params_initPortType(&params, NPI_SERIAL_TYPE_LOOPBACK);
+  if (NPITask_open(&params) != NPI_SUCCESS)
+  {
+    Serial.println("NPI open failed");
+    while (1);
+  }
+  NPITask_regSSFromHostCB(RPC_SYS_BLE_SNP, countFrame);
+}
+
+void loop() {
+  unsigned long sent = 0;
+  unsigned long start = millis();
+
+  routed = 0;
+  while (millis() - start < WINDOW)
+  {
+    UInt key = Task_disable();
+    for (uint8_t i = 0; i < BURST; i++)
+    {
+      if (NPITLLOOP_inject(SNP_NPI_ASYNC_CMD_TYPE, SNP_CHAR_WRITE_IND,
+                           writeInd, sizeof(writeInd)) == NPI_SUCCESS)
+      {
+        sent++;
+      }
+    }
+    while (NPITLLOOP_poll());
+    Task_restore(key);
+
+    /* Let the NPI task catch up before the next burst. */
+    while (routed < sent)
+    {
+      Task_yield();
+    }
+  }
+
+  Serial.print("rx budget:");
+  Serial.print(NPITASK_RX_BUDGET);
+  Serial.print(" frames/s:");
+  Serial.println(routed * 1000 / (millis() - start));
+  delay(3000);
+}
@@ -0,0 +1,73 @@
+#include <BLE.h>
+
+/*
+ * Brings the network processor up at each UART bit rate in turn and prints
+ * how many NPI bytes per second a stream of back to back getRevision()
+ * round trips moves at that rate.
+ *
+ * Rates above the default need an SNP image that implements
+ * SNP_SET_PORT_BIT_RATE_REQ, and no SNP image published so far does. With
+ * the stock image every faster rate is rejected, so only the default rate
+ * is measured and the other lines just say they were not. A rate that is
+ * accepted but does not hold up is not measured either.
+ */
+
+/* Wire bytes of one round trip: SOF, header and FCS around each payload. */
+#define FRAME_OVERHEAD 6
+#define ROUND_TRIP_BYTES (2 * FRAME_OVERHEAD + sizeof(BLE_Get_Revision_Rsp))
+
+/* How long each rate is measured for, in ms. */
+#define WINDOW 2000
+
+uint32_t rates[] = {BLE_DEFAULT_UART_BIT_RATE, 460800, 921600, 1000000};
+
+void setup() {
+  Serial.begin(115200);
+  ble.setLogLevel(BLE_LOG_ERRORS);
+}
+
+void measure(uint32_t rate) {
+  BLE_Get_Revision_Rsp rsp;
+  unsigned long roundTrips = 0;
+
+  ble.error = BLE_SUCCESS;
+  if (ble.begin(rate) != BLE_SUCCESS)
+  {
+    Serial.print("begin failed at ");
+    Serial.println(rate);
+    return;
+  }
+  Serial.print("requested:");
+  Serial.print(rate);
+  Serial.print(" running:");
+  Serial.print(ble.getUARTBitRate());
+  if (ble.getUARTBitRate() != rate)
+  {
+    /* Measuring the default rate again says nothing about this one. */
+    Serial.print(" not measured, error:");
+    Serial.println(ble.error, HEX);
+    ble.end();
+    return;
+  }
+
+  unsigned long start = millis();
+  while (millis() - start < WINDOW)
+  {
+    ble.getRevision(&rsp);
+    roundTrips++;
+  }
+  Serial.print(" round trips/s:");
+  Serial.print(roundTrips * 1000 / WINDOW);
+  Serial.print(" bytes/s:");
+  Serial.println(roundTrips * ROUND_TRIP_BYTES * 1000 / WINDOW);
+  ble.end();
+}
+
+void loop() {
+  for (uint8_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+  {
+    measure(rates[i]);
+  }
+  Serial.println();
+  delay(5000);
+}
@@ -0,0 +1,96 @@
+#include <BLE.h>
+
+/*
+ * A control loop driven from a phone: the client writes a brightness to the
+ * "Setpoint" characteristic and the sketch drives the red LED with it.
+ * Once per second it prints how many writes arrived and how long the MSP432
+ * took from receiving each one from the network processor to having handled
+ * it.
+ *
+ * With USE_WRITE_CALLBACK set to 0 the loop polls the characteristic
+ * between runs of its (simulated) control work, the way sketches without a
+ * write callback do. With 1 each write is applied from the write callback
+ * as soon as it arrives.
+ *
+ * Connect with any BLE app and write single bytes to "Setpoint" as fast as
+ * it allows.
+ */
+
+#define USE_WRITE_CALLBACK 1
+
+/* Time the control loop spends computing between BLE calls, in ms. */
+#define CONTROL_WORK 10
+
+BLE_Char setpointChar =
+{
+  {0xF1, 0xFF},
+  BLE_WRITABLE_NORSP | BLE_WRITABLE | BLE_READABLE,
+  "Setpoint"
+};
+
+BLE_Char *controlServiceChars[] = {&setpointChar};
+
+BLE_Service controlService =
+{
+  {0xF0, 0xFF},
+  1, controlServiceChars
+};
+
+volatile unsigned long writes = 0;
+unsigned char lastSetpoint = 0;
+unsigned long windowStart = 0;
+
+void onSetpoint(BLE_Char *bleChar) {
+  analogWrite(RED_LED, *(unsigned char *) bleChar->_value);
+  writes++;
+}
+
+void setup() {
+  Serial.begin(115200);
+  ble.setLogLevel(BLE_LOG_ERRORS);
+  pinMode(RED_LED, OUTPUT);
+  ble.begin();
+  ble.addService(&controlService);
+  ble.writeValue(&setpointChar, lastSetpoint);
+#if USE_WRITE_CALLBACK
+  ble.setWriteCallback(&setpointChar, onSetpoint);
+#endif
+  ble.setAdvertName("Energia Control");
+  ble.startAdvert();
+}
+
+void report(unsigned long now) {
+  BLE_Transport_Stats stats;
+
+  ble.getTransportStats(&stats, true);
+  Serial.print("writes:");
+  Serial.print(writes);
+  Serial.print(" handled avg us:");
+  Serial.print(stats.rxRouteAvgUs);
+  Serial.print(" max us:");
+  Serial.println(stats.rxRouteMaxUs);
+  writes = 0;
+  windowStart = now;
+}
+
+void loop() {
+  ble.handleEvents();
+#if !USE_WRITE_CALLBACK
+  unsigned char setpoint = ble.readValue_uchar(&setpointChar);
+  if (setpoint != lastSetpoint)
+  {
+    analogWrite(RED_LED, setpoint);
+    lastSetpoint = setpoint;
+    writes++;
+  }
+#endif
+  /* Control work that makes no BLE calls. */
+  unsigned long start = millis();
+  while (millis() - start < CONTROL_WORK);
+
+  unsigned long now = millis();
+  if (now - windowStart >= 1000)
+  {
+    report(now);
+  }
+}
@@ -95,23 +95,77 @@ static uint8_t advertIndex(uint8_t advertType);
 BLE::BLE(byte portType)
 {
   _portType = portType;
+  _uartBitRate = BLE_DEFAULT_UART_BIT_RATE;
+  _writeTimeout = BLE_WRITE_BLOCKING;
+  _writeSent = 0;
   for (uint8_t idx = 0; idx < MAX_ADVERT_IDX; idx++) {advertDataArr[idx] = NULL;}
   resetPublicMembers();
 }
 
-int BLE::begin(void)
+int BLE::begin(uint32_t uartBitRate)
 {
   /* Do board specific initializations */
-  initBoard();
+  initBoard(_portType);
 
   apEvent = Event_create(NULL, NULL);
   logSetAPTask(Task_self());
 
+  _uartBitRate = BLE_DEFAULT_UART_BIT_RATE;
+  if (isError(openSAP(_uartBitRate)))
+  {
+    return BLE_CHECK_ERROR;
+  }
+
+  /*
+   * Give the NP time to send a power up indicator, if we receive one then
+   * we can assume the NP has just started and we don't need to send a reset
+   * otherwise, we can assume the NP was running previously and needs to be
+   * reset to a known state
+   */
+  if (!apEventPend(AP_EVT_PUI)) {
+    // Assuming that at SAP start up that SNP is already running
+    logRPC("Reseting SNP");
+    logRelease();
+    if (isError(SAP_reset()))
+    {
+      SAP_close();
+      return BLE_CHECK_ERROR;
+    }
+    if (!apEventPend(AP_EVT_PUI))
+    {
+      return BLE_CHECK_ERROR;
+    }
+  }
+
+  /*
+   * Failing to go faster is not fatal, the link stays at the default and
+   * error says why. getUARTBitRate() tells which rate is in use.
+   */
+  if (_portType == BLE_PORT_UART && uartBitRate != _uartBitRate &&
+      setUARTBitRate(uartBitRate) != BLE_SUCCESS)
+  {
+    return BLE_CHECK_ERROR;
+  }
+
+  return BLE_SUCCESS;
+}
+
+/*
+ * Opens SAP at bitRate and registers the callbacks. SAP_close() drops
+ * them, so this runs again whenever the port is reopened.
+ */
+int BLE::openSAP(uint32_t bitRate)
+{
   SAP_Params sapParams;
   SAP_initParams(_portType, &sapParams);
-  sapParams.port.remote.boardID = BLE_UART_ID;
+  sapParams.port.remote.boardID =
+    (_portType == BLE_PORT_SPI) ? BLE_SPI_ID : BLE_UART_ID;
   sapParams.port.remote.mrdyPinID = BLE_Board_MRDY;
   sapParams.port.remote.srdyPinID = BLE_Board_SRDY;
+  if (_portType == BLE_PORT_UART)
+  {
+    sapParams.port.remote.bitRate = bitRate;
+  }
   logRPC("Opening SAP");
   logRelease();
   if (isError(SAP_open(&sapParams)))
@@ -142,30 +196,74 @@ int BLE::begin(void)
     return BLE_CHECK_ERROR;
   }
 
-  /*
-   * Give the NP time to send a power up indicator, if we receive one then
-   * we can assume the NP has just started and we don't need to send a reset
-   * otherwise, we can assume the NP was running previously and needs to be
-   * reset to a known state
-   */
-  if (!apEventPend(AP_EVT_PUI)) {
-    // Assuming that at SAP start up that SNP is already running
-    logRPC("Reseting SNP");
-    logRelease();
-    if (isError(SAP_reset()))
+  return BLE_SUCCESS;
+}
+
+/*
+ * Moves both ends of the UART to bitRate and checks the link with a
+ * SNP_GET_STATUS_REQ round trip. Reopening SAP drops registered services,
+ * so this only runs from begin(). Needs an SNP image that implements
+ * SNP_SET_PORT_BIT_RATE_REQ; the stock image answers it with
+ * SNP_SYNC_ERROR_CMD_IND, so error is set to SNP_CMD_REJECTED and the link
+ * stays at the current rate without a reset. If the NP does not answer at
+ * the new rate,
+ * e.g. because FCS errors drop every frame, it is reset and both sides go
+ * back to BLE_DEFAULT_UART_BIT_RATE. Returns BLE_SUCCESS whenever the link
+ * is usable afterwards, at whichever rate, with error set on a fallback.
+ */
+int BLE::setUARTBitRate(uint32_t bitRate)
+{
+  logRPC("Set UART bit rate");
+  logParam("Bit rate", bitRate);
+  logRelease();
+  uint8_t status = SAP_setPortBitRate(bitRate, AP_EVENT_PEND_TIMEOUT);
+  if (status == SNP_SUCCESS)
+  {
+    /* The NP has switched, follow it. */
+    SAP_close();
+    if (openSAP(bitRate) == BLE_SUCCESS)
     {
+      if (SAP_verifyLink(AP_EVENT_PEND_TIMEOUT) == SNP_SUCCESS)
+      {
+        _uartBitRate = bitRate;
+        return BLE_SUCCESS;
+      }
       SAP_close();
-      return BLE_CHECK_ERROR;
-    }
-    if (!apEventPend(AP_EVT_PUI))
-    {
-      return BLE_CHECK_ERROR;
     }
   }
+  else if (status != SNP_FAILURE)
+  {
+    /* The NP answered and stayed at the current bit rate. */
+    isError(status);
+    return BLE_SUCCESS;
+  }
+  else
+  {
+    SAP_close();
+  }
 
+  /* No answer, the NP's bit rate is unknown. Restart it at the default. */
+  logError(BLE_TIMEOUT);
+  logRelease();
+  _uartBitRate = BLE_DEFAULT_UART_BIT_RATE;
+  if (isError(openSAP(_uartBitRate)))
+  {
+    return BLE_CHECK_ERROR;
+  }
+  resetBoardNP();
+  if (!apEventPend(AP_EVT_PUI))
+  {
+    return BLE_CHECK_ERROR;
+  }
+  error = BLE_TIMEOUT;
   return BLE_SUCCESS;
 }
 
+uint32_t BLE::getUARTBitRate(void)
+{
+  return _uartBitRate;
+}
+
 void BLE::end(void)
 {
   /* Reset private members of BLE.h */
@@ -184,6 +282,12 @@ void BLE::end(void)
   connected = false;
   advertising = false;
   SAP_close();
+  if (_uartBitRate != BLE_DEFAULT_UART_BIT_RATE)
+  {
+    /* So the next begin() finds the NP at the default bit rate. */
+    resetBoardNP();
+    _uartBitRate = BLE_DEFAULT_UART_BIT_RATE;
+  }
 }
 
 int BLE::resetPublicMembers(void)
@@ -232,6 +336,15 @@ int BLE::addService(BLE_Service *bleService)
   return BLE_SUCCESS;
 }
 
+int BLE::setWriteCallback(BLE_Char *bleChar, charWriteFxn_t writeFxn)
+{
+  if (isError(BLE_setWriteCallback(bleChar, writeFxn)))
+  {
+    return BLE_CHECK_ERROR;
+  }
+  return BLE_SUCCESS;
+}
+
 /* Converts advertisement type defines to indices for the array of data. */
 static uint8_t advertIndex(uint8_t advertType)
 {
@@ -295,8 +408,16 @@ int BLE::startAdvert(BLE_Advert_Settings *advertSettings)
     reqSize = (uint16_t) sizeof(lReq);
     pData = (uint8_t *) &lReq;
   }
-  if (isError(SAP_setParam(SAP_PARAM_ADV, SAP_ADV_STATE, reqSize, pData)) ||
-      !apEventPend(AP_EVT_ADV_ENB))
+  bool piped = apPipeIssue(SNP_START_ADV_REQ);
+  if (isError(SAP_setParam(SAP_PARAM_ADV, SAP_ADV_STATE, reqSize, pData)))
+  {
+    if (piped)
+    {
+      apPipeCancel(BLE_CHECK_ERROR);
+    }
+    return BLE_CHECK_ERROR;
+  }
+  if (!piped && !apEventPend(AP_EVT_ADV_ENB))
   {
     return BLE_CHECK_ERROR;
   }
@@ -322,8 +443,16 @@ int BLE::setAdvertData(uint8_t advertType, uint8_t len, uint8_t *advertData)
   logRPC("Set adv data");
   logParam("Type", advertType);
   logRelease();
-  if (isError(SAP_setParam(SAP_PARAM_ADV, advertType, len, advertData)) ||
-      !apEventPend(AP_EVT_ADV_DATA_RSP))
+  bool piped = apPipeIssue(SNP_SET_ADV_DATA_REQ);
+  if (isError(SAP_setParam(SAP_PARAM_ADV, advertType, len, advertData)))
+  {
+    if (piped)
+    {
+      apPipeCancel(BLE_CHECK_ERROR);
+    }
+    return BLE_CHECK_ERROR;
+  }
+  if (!piped && !apEventPend(AP_EVT_ADV_DATA_RSP))
   {
     return BLE_CHECK_ERROR;
   }
@@ -456,10 +585,21 @@ int BLE::setConnParams(BLE_Conn_Params_Update_Req *connParams)
   logParam("slaveLatency", connParams->slaveLatency);
   logParam("supervisionTimeout", connParams->supervisionTimeout);
   logRelease();
-  if ((!connected && isError(BLE_NOT_CONNECTED)) ||
-      isError(SAP_setParam(SAP_PARAM_CONN, SAP_CONN_PARAM,
-                           sizeof(*connParams), (uint8_t *) connParams)) ||
-      !apEventPend(AP_EVT_CONN_PARAMS_CNF))
+  if (!connected && isError(BLE_NOT_CONNECTED))
+  {
+    return BLE_CHECK_ERROR;
+  }
+  bool piped = apPipeIssue(SNP_UPDATE_CONN_PARAM_REQ);
+  if (isError(SAP_setParam(SAP_PARAM_CONN, SAP_CONN_PARAM,
+                           sizeof(*connParams), (uint8_t *) connParams)))
+  {
+    if (piped)
+    {
+      apPipeCancel(BLE_CHECK_ERROR);
+    }
+    return BLE_CHECK_ERROR;
+  }
+  if (!piped && !apEventPend(AP_EVT_CONN_PARAMS_CNF))
   {
     return BLE_CHECK_ERROR;
   }
@@ -509,6 +649,24 @@ int BLE::apCharWriteValue(BLE_Char *bleChar, void *pData,
   logChar("App writing");
   BLE_charWriteValue(bleChar, pData, size, isBigEnd);
   logRelease();
+  /* Values stored on the NP are only read from there. */
+  if (bleChar->_npMaxLen)
+  {
+    if (size > bleChar->_npMaxLen)
+    {
+      logError(BLE_INVALID_PARAMETERS);
+      error = BLE_INVALID_PARAMETERS;
+      return BLE_CHECK_ERROR;
+    }
+    logRPC("Set NP value");
+    logParam("Handle", bleChar->_handle);
+    logRelease();
+    if (isError(SAP_setAttrValue(bleChar->_handle, bleChar->_valueLen,
+                                 (uint8_t *) bleChar->_value)))
+    {
+      return BLE_CHECK_ERROR;
+    }
+  }
   return writeNotifInd(bleChar);
 }
 
@@ -534,12 +692,29 @@ uint8_t BLE::writeNotifInd(BLE_Char *bleChar)
     }
     logParam("Total bytes", bleChar->_valueLen);
     uint16_t sent = 0;
+    unsigned long start = millis();
     /* Send at least one notification, in case data is 0 length. */
     do
     {
       /* Send at most ble.mtu per packet. */
       uint16_t size = MIN(bleChar->_valueLen - sent, mtu);
       localReq.pData = ((uint8_t *) bleChar->_value) + sent;
+      /* Wait for room in the NPI transmit queue, for what is left of the
+         write timeout. */
+      uint32_t ticks = BIOS_WAIT_FOREVER;
+      if (_writeTimeout != BLE_WRITE_BLOCKING)
+      {
+        unsigned long elapsed = millis() - start;
+        ticks = elapsed < _writeTimeout ?
+          (uint64_t) (_writeTimeout - elapsed) * 1000 / Clock_tickPeriod : 0;
+      }
+      if (SNP_RPC_waitNotifIndCredit(size, ticks) != SNP_SUCCESS)
+      {
+        logError(BLE_TIMEOUT);
+        error = BLE_TIMEOUT;
+        status = BLE_CHECK_ERROR;
+        break;
+      }
       logParam("Sending", size);
       if (isError(SNP_RPC_sendNotifInd(&localReq, size)))
       {
@@ -554,6 +729,7 @@ uint8_t BLE::writeNotifInd(BLE_Char *bleChar)
         break;
       }
       sent += size;
+      _writeSent = sent;
     } while (sent < bleChar->_valueLen);
   }
   logRelease();
@@ -799,6 +975,26 @@ void BLE::setValueFormat(BLE_Char *bleChar, uint8_t valueFormat,
   bleChar->_valueExponent = valueExponent;
 }
 
+/*
+ * Have the NP store the value of bleChar and answer client reads itself,
+ * without asking the MSP432. writeValue then pushes each new value, at most
+ * maxLen bytes, to the NP. Call before addService; 0 switches back. The NP
+ * reserves maxLen bytes for the value and handles client writes without
+ * telling the MSP432, so only read-only characteristics qualify.
+ */
+int BLE::useNPValue(BLE_Char *bleChar, uint16_t maxLen)
+{
+  if (bleChar->_handle ||
+      (maxLen && (bleChar->properties & (BLE_WRITABLE | BLE_WRITABLE_NORSP))))
+  {
+    logError(BLE_INVALID_PARAMETERS);
+    error = BLE_INVALID_PARAMETERS;
+    return BLE_CHECK_ERROR;
+  }
+  bleChar->_npMaxLen = maxLen;
+  return BLE_SUCCESS;
+}
+
 /* Uses macros from sap.h and snp.h. */
 int BLE::setSecurityParam(uint16_t paramId, uint16_t len, uint8_t *pData)
 {
@@ -894,6 +1090,26 @@ int BLE::testCommand(BLE_Test_Command_Rsp *testRsp)
   return BLE_SUCCESS;
 }
 
+/*
+ * Counts since begin() or the last reset. Nothing is sent to the
+ * network processor, so this is cheap enough to poll.
+ */
+void BLE::getTransportStats(BLE_Transport_Stats *stats, bool reset)
+{
+  NPITask_getStats(stats, reset);
+}
+
+/*
+ * Bounds how long a call waiting on a synchronous NP response blocks, in
+ * ms; 0 restores the default of one second. A call that runs out of time
+ * fails, and the link keeps working for the next one.
+ * syncRpcTimeouts in getTransportStats() counts them.
+ */
+void BLE::setRpcTimeout(unsigned long timeout)
+{
+  SNP_RPC_setSyncTimeout((uint64_t) timeout * 1000 / Clock_tickPeriod);
+}
+
 
 int BLE::serial(void)
 {
@@ -12,9 +12,14 @@ class BLE : public Stream
 {
   private:
     uint8_t _portType; // UART or SPI connection with network processor
+    uint32_t _uartBitRate; // UART bit rate both sides currently run at
+    unsigned long _writeTimeout; // ms a write waits for NPI transmit room
+    size_t _writeSent; // Bytes the last notification write queued
     uint8_t *advertDataArr[MAX_ADVERT_IDX];
 
     int resetPublicMembers(void);
+    int openSAP(uint32_t bitRate);
+    int setUARTBitRate(uint32_t bitRate);
     uint8_t advertDataInit(void);
     int setAdvertName(uint8_t advertNameLen, const char *advertName);
     int setSingleConnParam(size_t offset, uint16_t value);
@@ -52,7 +57,8 @@ class BLE : public Stream
     BLE(byte portType=BLE_PORT_UART);
 
     /* BLE state */
-    int begin(void);
+    int begin(uint32_t uartBitRate=BLE_DEFAULT_UART_BIT_RATE);
+    uint32_t getUARTBitRate(void);
     void setLogLevel(uint8_t newLogLevel);
     int handleEvents(void); // BLEEventHandling.cpp
     int terminateConn(void);
@@ -84,6 +90,10 @@ class BLE : public Stream
     int setRespLatency(uint16_t slaveLatency); // Measured in number of connection intervals the slave can miss.
     int setBleTimeout(uint16_t supervisionTimeout);
 
+    /* Confirmation pipelining */
+    int beginPipeline(void); // BLEEventHandling.cpp
+    int endPipeline(BLE_Pipeline_Result *result=NULL); // BLEEventHandling.cpp
+
     /* Services and characteristics */
     int addService(BLE_Service *bleService);
     int writeValue(BLE_Char *bleChar, bool value); //_bool
@@ -112,6 +122,8 @@ class BLE : public Stream
     String readValue_String(BLE_Char *bleChar);
     void setValueFormat(BLE_Char *bleChar, uint8_t valueFormat,
                         int8_t valueExponent=0);
+    int setWriteCallback(BLE_Char *bleChar, charWriteFxn_t writeFxn);
+    int useNPValue(BLE_Char *bleChar, uint16_t maxLen);
 
     /* Security */
     int setPairingMode(uint8_t pairingMode);
@@ -127,9 +139,13 @@ class BLE : public Stream
     void getRevision(BLE_Get_Revision_Rsp *getRevisionRsp);
     void getStatus(BLE_Get_Status_Rsp *getStatusRsp);
     int testCommand(BLE_Test_Command_Rsp *testRsp);
+    void getTransportStats(BLE_Transport_Stats *stats, bool reset = false);
+    void setRpcTimeout(unsigned long timeout);
 
     /* Serial over BLE */
     int serial(void);
+    void setWriteTimeout(unsigned long timeout);
+    virtual int availableForWrite(void);
     virtual int available(void);
     virtual int read(void);
     virtual int peek(void);
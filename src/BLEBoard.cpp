@@ -3,13 +3,15 @@
 #ifdef __MSP432P401R__
 #include <gpio.h>
 #include <rom_map.h>
+#include <ti/drivers/SPI.h>
 #endif //__MSP432P401R__
 
 #include <Energia.h>
 
 #include "BLEBoard.h"
+#include "BLETypes.h"
 
-void initBoard(void)
+void initBoard(uint8_t portType)
 {
   /*
    * When a MSP432 and a CC2650 are stacked, pin 6.7 of the MSP is
@@ -21,10 +23,24 @@ void initBoard(void)
   digitalWrite(CC2650_RESET_PIN, HIGH);
 
 /*
- * Usually NPI's driver calls are enough to open the UART. Energia does pin
- * configuration on its own though, so we have to override that.
+ * Usually NPI's driver calls are enough to open the UART or SPI. Energia
+ * does pin configuration on its own though, so we have to override that.
  */
 #ifdef __MSP432P401R__
+  if (portType == BLE_PORT_SPI)
+  {
+    /* P1.5 CLK, P1.6 SIMO, P1.7 SOMI. MRDY doubles as chip select. */
+    SPI_init();
+    MAP_GPIO_setAsPeripheralModuleFunctionOutputPin(GPIO_PORT_P1,
+                                                    GPIO_PIN5 | GPIO_PIN6,
+                                                    GPIO_PRIMARY_MODULE_FUNCTION);
+
+    MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P1,
+                                                   GPIO_PIN7,
+                                                   GPIO_PRIMARY_MODULE_FUNCTION);
+    return;
+  }
+
   UART_init();
   MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P3,
                                                  GPIO_PIN2,
@@ -35,3 +51,11 @@ void initBoard(void)
                                                   GPIO_PRIMARY_MODULE_FUNCTION);
 #endif //__MSP432P401R__
 }
+
+void resetBoardNP(void)
+{
+  /* Active low, the CC2650 needs well under a millisecond. */
+  digitalWrite(CC2650_RESET_PIN, LOW);
+  delay(1);
+  digitalWrite(CC2650_RESET_PIN, HIGH);
+}
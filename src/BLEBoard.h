@@ -30,9 +30,13 @@
 #define BLE_SBL_BL_PIN     PIN6_0
 
 #define BLE_UART_ID        Board_UARTA2 // =1, USB Serial is Board_UARTA0=0
+#define BLE_SPI_ID         Board_SPI0   // eUSCI_B0 on the BoosterPack header
 #endif //__MSP432P401R__
 
 /* Performs all necessary board initialization in ble.begin(). */
-void initBoard(void);
+void initBoard(uint8_t portType);
+
+/* Pulses the CC2650 reset pin, the NP restarts at its default bit rate. */
+void resetBoardNP(void);
 
 #endif
@@ -22,6 +22,26 @@ bool advertising = false;
 /* Used to pass event data to the handleEvents() function. */
 snpEventParam_t eventHandlerData = {};
 
+/*
+ * Commands sent since beginPipeline() whose confirmation endPipeline()
+ * collects. Only the AP task adds entries and only the NPI task confirms
+ * them: an entry is filled in before pipeCount covers it, so neither side
+ * needs a lock.
+ */
+static bool pipeOpen = false;
+static volatile uint8_t pipeCount = 0;
+static volatile BLE_Pipeline_Cmd pipeCmds[BLE_PIPELINE_DEPTH];
+
+/*
+ * Opcodes of pipelined commands endPipeline() gave up on, oldest first.
+ * The NP still confirms them eventually; those confirmations are dropped
+ * here instead of being taken as the answer to a later command. Written
+ * by the AP task with tasking disabled, so the NPI task sees whole
+ * updates.
+ */
+static volatile uint8_t pipeExpiredCount = 0;
+static volatile uint8_t pipeExpired[BLE_PIPELINE_DEPTH];
+
 /* Interrupt for the button that indicates an equal numeric comparison. */
 static void numCmpInterruptEqual(void);
 
@@ -31,6 +51,12 @@ static void numCmpInterruptDifferent(void);
 /* Helper function for posting AP_ERROR, setting error, and logging. */
 static void apPostError(uint8_t status, const char errMsg[]);
 
+/* Hands a confirmation to the pipeline if it is waiting for one. */
+static bool apPipeConfirm(uint8_t opcode, uint8_t status, const char errMsg[]);
+
+/* Whether a pipelined command still waits for its confirmation. */
+static bool apPipePending(void);
+
 /*
  * Must be called in the main loop to poll for events that must be
  * handled outside of the NPI task. Required for sending NPI messages
@@ -167,6 +193,89 @@ static void numCmpInterruptDifferent(void)
   Event_post(apEvent, AP_EVT_NUM_CMP_BTN);
 }
 
+/*
+ * Until endPipeline(), commands the NP confirms asynchronously are sent
+ * without waiting for the confirmation of the ones before them. That is
+ * setAdvertData(), setAdvertName(), startAdvert() and setConnParams().
+ * Their return value then only says whether the command was sent.
+ * Calling this again before endPipeline() keeps adding to the same
+ * pipeline.
+ */
+int BLE::beginPipeline(void)
+{
+  logRPC("Begin pipeline");
+  logRelease();
+  error = BLE_SUCCESS;
+  if (!pipeOpen)
+  {
+    pipeCount = 0;
+    pipeOpen = true;
+  }
+  return BLE_SUCCESS;
+}
+
+/*
+ * Waits for the confirmation of every command sent since beginPipeline()
+ * and closes the pipeline. result, if given, gets each command's status.
+ * Returns BLE_CHECK_ERROR if any failed, with error and opcode set from
+ * the first that did.
+ */
+int BLE::endPipeline(BLE_Pipeline_Result *result)
+{
+  logRPC("End pipeline");
+  logRelease();
+  /* Confirmations may come in any order, so check after every post. */
+  while (apPipePending() &&
+         Event_pend(apEvent, AP_NONE, AP_EVT_PIPELINE_DONE,
+                    AP_EVENT_PEND_TIMEOUT));
+  pipeOpen = false;
+
+  /* Keep the NPI task from confirming an entry while it expires. */
+  UInt key = Task_disable();
+  for (uint8_t idx = 0; idx < pipeCount; idx++)
+  {
+    if (pipeCmds[idx].status == BLE_PENDING)
+    {
+      pipeCmds[idx].status = BLE_TIMEOUT;
+      if (pipeExpiredCount == BLE_PIPELINE_DEPTH)
+      {
+        /* Forget the oldest; its confirmation is the least likely to come. */
+        memmove((void *) pipeExpired, (void *) &pipeExpired[1],
+                BLE_PIPELINE_DEPTH - 1);
+        pipeExpiredCount--;
+      }
+      pipeExpired[pipeExpiredCount++] = pipeCmds[idx].opcode;
+    }
+  }
+  Task_restore(key);
+
+  error = BLE_SUCCESS;
+  for (uint8_t idx = 0; idx < pipeCount; idx++)
+  {
+    if (error == BLE_SUCCESS && pipeCmds[idx].status != BLE_SUCCESS)
+    {
+      error = pipeCmds[idx].status;
+      opcode = pipeCmds[idx].opcode;
+    }
+    if (result)
+    {
+      result->cmd[idx].opcode = pipeCmds[idx].opcode;
+      result->cmd[idx].status = pipeCmds[idx].status;
+    }
+  }
+  if (result)
+  {
+    result->count = pipeCount;
+  }
+  if (error != BLE_SUCCESS)
+  {
+    logError(error);
+    logRelease();
+    return BLE_CHECK_ERROR;
+  }
+  return BLE_SUCCESS;
+}
+
 /*
  * Even though many events and resposes are asynchronous, we still handle them
  * synchronously. Any request that generates an asynchronous response should
@@ -186,6 +295,8 @@ void AP_asyncCB(uint8_t cmd1, void *pParams)
           logAsync("SNP_POWER_UP_IND", cmd1);
           // Notify state machine of Power Up Indication
           // Log_info0("Got PowerUp indication from NP");
+          /* A reset NP won't confirm what it was sent before. */
+          pipeExpiredCount = 0;
           Event_post(apEvent, AP_EVT_PUI);
         } break;
         case SNP_HCI_CMD_RSP:
@@ -231,6 +342,11 @@ void AP_asyncCB(uint8_t cmd1, void *pParams)
         {
           logAsync("SNP_SET_ADV_DATA_CNF", cmd1);
           snpSetAdvDataCnf_t *advDataRsp = (snpSetAdvDataCnf_t *) pParams;
+          if (apPipeConfirm(SNP_SET_ADV_DATA_REQ, advDataRsp->status,
+                            "SNP_SET_ADV_DATA_CNF"))
+          {
+            break;
+          }
           if (advDataRsp->status == SNP_SUCCESS)
           {
             Event_post(apEvent, AP_EVT_ADV_DATA_RSP);
@@ -246,6 +362,11 @@ void AP_asyncCB(uint8_t cmd1, void *pParams)
           logAsync("SNP_UPDATE_CONN_PARAM_CNF", cmd1);
           snpUpdateConnParamCnf_t *connRsp =
             (snpUpdateConnParamCnf_t *) pParams;
+          if (apPipeConfirm(SNP_UPDATE_CONN_PARAM_REQ, connRsp->status,
+                            "SNP_UPDATE_CONN_PARAM_CNF"))
+          {
+            break;
+          }
           if (connRsp->status == SNP_SUCCESS)
           {
             Event_post(apEvent, AP_EVT_CONN_PARAMS_CNF);
@@ -369,6 +490,14 @@ void processSNPEventCB(uint16_t cmd1, snpEventParam_t *param)
       if (evt->status == SNP_SUCCESS)
       {
         advertising = true;
+      }
+      if (apPipeConfirm(SNP_START_ADV_REQ, evt->status,
+                        "SNP_ADV_STARTED_EVT"))
+      {
+        break;
+      }
+      if (evt->status == SNP_SUCCESS)
+      {
         Event_post(apEvent, AP_EVT_ADV_ENB);
       }
       else
@@ -437,11 +566,6 @@ bool apEventPend(uint32_t event)
   ble.error = BLE_SUCCESS;
   uint32_t postedEvent = Event_pend(apEvent, AP_NONE, event | AP_ERROR,
                                     AP_EVENT_PEND_TIMEOUT);
-  /* Bug in NPI causes this specific event to get posted twice */
-  if (event == AP_EVT_ADV_DATA_RSP)
-  {
-    Event_pend(apEvent, AP_NONE, event | AP_ERROR, AP_EVENT_PEND_TIMEOUT);
-  }
   bool status = false;
   if (postedEvent & event)
   {
@@ -468,6 +592,102 @@ static void apPostError(uint8_t status, const char errMsg[])
   Event_post(apEvent, AP_ERROR);
 }
 
+/*
+ * Called before sending a command the NP confirms asynchronously. Returns
+ * true if the command joined the open pipeline, in which case the caller
+ * must not wait for its confirmation. A full or closed pipeline leaves the
+ * caller to wait as usual. The NP confirms commands with the same opcode
+ * in the order they were sent, so the oldest pipelined one is always the
+ * one a confirmation belongs to.
+ */
+bool apPipeIssue(uint8_t opcode)
+{
+  if (!pipeOpen || pipeCount == BLE_PIPELINE_DEPTH)
+  {
+    return false;
+  }
+  pipeCmds[pipeCount].opcode = opcode;
+  pipeCmds[pipeCount].status = BLE_PENDING;
+  pipeCount++;
+  return true;
+}
+
+/* Records why the command apPipeIssue() just added could not be sent. */
+void apPipeCancel(uint8_t status)
+{
+  pipeCmds[pipeCount - 1].status =
+    (status == BLE_CHECK_ERROR) ? ble.error : status;
+}
+
+/*
+ * Runs in the NPI task. Failures are logged here and reported by
+ * endPipeline(), so they don't post AP_ERROR to whatever the AP task is
+ * waiting for meanwhile.
+ */
+static bool apPipeConfirm(uint8_t opcode, uint8_t status, const char errMsg[])
+{
+  bool confirmed = false;
+  bool pending = false;
+  /*
+   * An expired command was sent before any command still waiting with the
+   * same opcode, so its confirmation comes first.
+   */
+  for (uint8_t idx = 0; idx < pipeExpiredCount; idx++)
+  {
+    if (pipeExpired[idx] == opcode)
+    {
+      memmove((void *) &pipeExpired[idx], (void *) &pipeExpired[idx + 1],
+              pipeExpiredCount - idx - 1);
+      pipeExpiredCount--;
+      logError("Late confirmation", status);
+      logRelease();
+      return true;
+    }
+  }
+  for (uint8_t idx = 0; idx < pipeCount; idx++)
+  {
+    if (pipeCmds[idx].status != BLE_PENDING)
+    {
+      continue;
+    }
+    if (!confirmed && pipeCmds[idx].opcode == opcode)
+    {
+      pipeCmds[idx].status = status;
+      confirmed = true;
+    }
+    else
+    {
+      pending = true;
+    }
+  }
+  if (!confirmed)
+  {
+    return false;
+  }
+  if (status != SNP_SUCCESS)
+  {
+    logError(errMsg, status);
+    logRelease();
+  }
+  if (!pending)
+  {
+    Event_post(apEvent, AP_EVT_PIPELINE_DONE);
+  }
+  return true;
+}
+
+static bool apPipePending(void)
+{
+  for (uint8_t idx = 0; idx < pipeCount; idx++)
+  {
+    if (pipeCmds[idx].status == BLE_PENDING)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 /*
  * Handles propogating errors through stack to Energia sketch. Use when
  * failure of the checked call requires immediate return (e.g. if the
@@ -32,6 +32,7 @@
 #define AP_EVT_SECURITY_PARAM_RSP  Event_Id_14   // Set Security Param Response
 #define AP_EVT_WHITE_LIST_RSP      Event_Id_15   // Set White List Policy Response
 #define AP_EVT_NUM_CMP_BTN         Event_Id_16   // Numeric Comparison Button Press
+#define AP_EVT_PIPELINE_DONE       Event_Id_17   // Pipelined Commands Confirmed
 #define AP_EVT_COPIED_ASYNC_DATA   Event_Id_30   // Copied Data From asyncRspData
 #define AP_ERROR                   Event_Id_31   // Error
 
@@ -45,6 +46,8 @@ extern snpEventParam_t eventHandlerData;
 void AP_asyncCB(uint8_t cmd1, void *pParams);
 void processSNPEventCB(uint16_t event, snpEventParam_t *param);
 bool apEventPend(uint32_t event);
+bool apPipeIssue(uint8_t opcode);
+void apPipeCancel(uint8_t status);
 bool isError(uint8_t status);
 
 #endif
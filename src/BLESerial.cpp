@@ -1,6 +1,7 @@
 
 #include <BLE.h>
 #include "BLESerial.h"
+#include "ti/sap/snp_rpc.h"
 
 uint8_t rxBuffer[BLE_SERIAL_BUFFER_SIZE] = {0};
 volatile uint16_t rxWriteIndex = 0;
@@ -12,7 +13,7 @@ BLE_Char rxChar =
 {
   {0x9E, 0xCA, 0xDC, 0x24, 0x0E, 0xE5, 0xA9, 0xE0,
    0x93, 0xF3, 0xA3, 0xB5, 0x02, 0x00, 0x40, 0x6E},
-  BLE_WRITABLE,
+  BLE_WRITABLE | BLE_WRITABLE_NORSP,
   "Client TX"
 };
 
@@ -94,11 +95,32 @@ size_t BLE::write(uint8_t c)
 
 size_t BLE::write(const uint8_t buffer[], size_t size)
 {
+  _writeSent = 0;
   if (writeValue(&txChar, buffer, size) == BLE_SUCCESS)
   {
     return size;
   }
-  return 0;
+  /* Timed out part way through, report the notifications that were queued. */
+  return _writeSent;
+}
+
+/*
+ * How many bytes write() can queue without waiting. Notifications are
+ * queued for the NP until NPI has sent them, and that queue is capped.
+ */
+int BLE::availableForWrite(void)
+{
+  return SNP_RPC_notifIndCredit(mtu);
+}
+
+/*
+ * How long write() and writeValue() wait for room to queue notifications,
+ * in ms. BLE_WRITE_BLOCKING, the default, waits as long as it takes, and
+ * BLE_WRITE_NONBLOCKING sends only what fits right away.
+ */
+void BLE::setWriteTimeout(unsigned long timeout)
+{
+  _writeTimeout = timeout;
 }
 
 /* Called in the NPI task when the BLE client writes data. */
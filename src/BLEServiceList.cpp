@@ -16,12 +16,69 @@ typedef struct BLE_Service_Node
 BLE_Service_Node *bleServiceListHead = NULL;
 BLE_Service_Node *bleServiceListTail = NULL;
 
+typedef struct
+{
+  BLE_Char *bleChar;
+  charWriteFxn_t writeFxn;
+} BLE_Write_Callback;
+
+/* Characteristics whose client writes are handled on the fast path. */
+static BLE_Write_Callback writeCallbacks[BLE_MAX_WRITE_CALLBACKS];
+
+/* Which attribute of a characteristic a handle refers to. */
+enum
+{
+  BLE_ATTR_NONE = 0,
+  BLE_ATTR_VALUE,
+  BLE_ATTR_CCCD,
+  BLE_ATTR_USER_DESC
+};
+
+typedef struct
+{
+  BLE_Char *bleChar;
+  uint8_t attr;
+} BLE_Handle_Entry;
+
+/*
+ * Every handle from handleTableBase up to the last one registered, so the
+ * NPI task finds the characteristic of a read, write or CCCD write by
+ * indexing instead of searching. Handles the BLE layer does not own, e.g.
+ * service and declaration attributes, are BLE_ATTR_NONE. The NPI task reads
+ * it without a lock, so it is only changed with task switching disabled.
+ */
+static BLE_Handle_Entry *handleTable = NULL;
+static uint16_t handleTableBase = 0;
+static uint16_t handleTableLen = 0;
+/* Entries up to the last handle registered, the rest is room to grow. */
+static uint16_t handleTableUsed = 0;
+static bool handleTableFull = false;
+
+/*
+ * Descriptors of the characteristic SAP is declaring. SAP packs each
+ * declaration into its request before asking for the next one, so a single
+ * set serves every characteristic and registering allocates none.
+ */
+static SAP_UserDescAttr_t declUserDesc;
+static SAP_UserCCCDAttr_t declCCCD;
+static SAP_FormatAttr_t declFormat;
+
 static void addServiceNode(BLE_Service *service);
+static void charStoreValue(BLE_Char *bleChar, void *pData, size_t size,
+                           bool isBigEnd);
+static bool fastWriteCB(snpCharWriteInd_t *pInd, uint16_t len);
+static bool resizeHandleTable(uint16_t len);
+static void setHandleEntry(uint16_t handle, BLE_Char *bleChar, uint8_t attr);
+static void dropHandleEntries(uint16_t used);
+static uint8_t charAttrCount(BLE_Char *bleChar);
+static BLE_Char* getHandleEntry(uint16_t handle, uint8_t attr);
 static BLE_Char* getChar(uint16_t handle);
 static BLE_Char* getCCCD(uint16_t handle);
-static BLE_Service* getServiceWithChar(uint16_t handle);
 static void constructService(SAP_Service_t *service, BLE_Service *bleService);
 static void constructChar(SAP_Char_t *sapChar, BLE_Char *bleChar);
+static void charDeclCB(void *context, uint8_t index, SAP_Char_t *pChar);
+static void charHandlesCB(void *context, uint8_t index,
+                          SAP_CharHandle_t *pHandles);
 static uint8_t setPermissions(uint8_t props);
 static uint8_t getUUIDLen(const uint8_t UUID[]);
 static uint8_t serviceReadAttrCB(void *context,
@@ -40,41 +97,57 @@ static uint8_t serviceCCCDIndCB(void *context,
 
 int BLE_registerService(BLE_Service *bleService)
 {
-  SAP_Service_t *service = (SAP_Service_t *) malloc(sizeof(*service));
-  constructService(service, bleService);
+  SAP_Service_t service;
+  constructService(&service, bleService);
   logAcquire();
   logRPC("Register service");
   logUUID(bleService->UUID, bleService->_UUIDlen);
-  int status = SAP_registerService(service);
-  if (status != SNP_FAILURE) {
-    bleService->_handle = service->serviceHandle;
+
+  /* Size the table for all of the service's handles before the NP has it,
+     the only resize of the registration unless the NP skips handles. */
+  uint16_t attrs = 1;
+  for (uint8_t i = 0; i < bleService->numChars; i++)
+  {
+    attrs += charAttrCount(bleService->chars[i]);
+  }
+  if (!resizeHandleTable(MAX(handleTableLen, handleTableUsed + attrs)))
+  {
+    logError("No memory for handles", SNP_FAILURE);
+    logRelease();
+    return SNP_FAILURE;
+  }
+  uint16_t usedBefore = handleTableUsed;
+  handleTableFull = false;
+
+  int status = SAP_registerService(&service);
+  if (status == SNP_SUCCESS && handleTableFull)
+  {
+    logError("No memory for handles", SNP_FAILURE);
+    status = SNP_FAILURE;
+  }
+  if (status == SNP_SUCCESS) {
+    bleService->_handle = service.serviceHandle;
     logParam("Handle", bleService->_handle);
     for (uint8_t i = 0; i < bleService->numChars; i++)
     {
-      bleService->chars[i]->_handle = service->charAttrHandles[i].valueHandle;
       logParam("With characteristic");
       logUUID(bleService->chars[i]->UUID, bleService->chars[i]->_UUIDlen);
       logParam("Handle", bleService->chars[i]->_handle);
-      bleService->chars[i]->_CCCDHandle = service->charAttrHandles[i].cccdHandle;
-      if (service->charTable[i].pUserDesc)
-      {
-        free(service->charTable[i].pUserDesc);
-      }
-      if (service->charTable[i].pCccd)
-      {
-        free(service->charTable[i].pCccd);
-      }
-      if (service->charTable[i].pFormat)
-      {
-        free(service->charTable[i].pFormat);
-      }
     }
     addServiceNode(bleService);
   }
+  else
+  {
+    /* The NP cannot take a service back. Forget it here so none of its
+       handles lead to characteristics the sketch was told are not there. */
+    dropHandleEntries(usedBefore);
+    for (uint8_t i = 0; i < bleService->numChars; i++)
+    {
+      bleService->chars[i]->_handle = 0;
+      bleService->chars[i]->_CCCDHandle = 0;
+    }
+  }
   logRelease();
-  free(service->charTable);
-  free(service->charAttrHandles);
-  free(service);
   return status;
 }
 
@@ -95,6 +168,61 @@ void BLE_charWriteValue(BLE_Char *bleChar, void *pData, size_t size, bool isBigE
 {
   logParam("Handle", bleChar->_handle);
   logParam("Size in bytes", bleChar->_valueLen);
+  if (bleChar->_valueLen != size || bleChar->_value == NULL)
+  {
+    logParam("New size in bytes", size);
+  }
+  charStoreValue(bleChar, pData, size, isBigEnd);
+  logParam("Value", (const uint8_t *) bleChar->_value, bleChar->_valueLen,
+           isBigEnd);
+}
+
+/*
+ * Call writeFxn from the NPI task each time a client writes bleChar, with
+ * the new value already stored. Pass NULL to stop. The callback must be
+ * short and must not send synchronous commands to the NP: the NPI task is
+ * the one that would deliver the response, so the call stalls until the
+ * RPC timeout. writeValue on a characteristic stored on the NP (see
+ * useNPValue) is one, it goes through SAP_setAttrValue. Notifying from the
+ * callback while the NPI transmit queue is full likewise waits out the
+ * write timeout, as only the NPI task makes room.
+ */
+int BLE_setWriteCallback(BLE_Char *bleChar, charWriteFxn_t writeFxn)
+{
+  BLE_Write_Callback *freeSlot = NULL;
+  for (uint8_t i = 0; i < BLE_MAX_WRITE_CALLBACKS; i++)
+  {
+    if (writeCallbacks[i].bleChar == bleChar)
+    {
+      freeSlot = &writeCallbacks[i];
+      break;
+    }
+    if (freeSlot == NULL && writeCallbacks[i].bleChar == NULL)
+    {
+      freeSlot = &writeCallbacks[i];
+    }
+  }
+  if (freeSlot == NULL)
+  {
+    return BLE_FAILURE;
+  }
+  if (writeFxn == NULL)
+  {
+    freeSlot->bleChar = NULL;
+  }
+  else
+  {
+    /* Callback first, the NPI task matches on the characteristic. */
+    freeSlot->writeFxn = writeFxn;
+    freeSlot->bleChar = bleChar;
+  }
+  SNP_RPC_registerFastWriteCB(fastWriteCB);
+  return BLE_SUCCESS;
+}
+
+static void charStoreValue(BLE_Char *bleChar, void *pData, size_t size,
+                           bool isBigEnd)
+{
   if (bleChar->_valueLen != size && bleChar->_value)
   {
     free(bleChar->_value);
@@ -102,13 +230,49 @@ void BLE_charWriteValue(BLE_Char *bleChar, void *pData, size_t size, bool isBigE
   }
   if (bleChar->_value == NULL)
   {
-    logParam("New size in bytes", size);
     bleChar->_value = (void *) malloc(size);
     bleChar->_isBigEnd = isBigEnd;
-    bleChar->_valueLen = size;
+    bleChar->_valueLen = bleChar->_value ? size : 0;
+  }
+  if (bleChar->_value)
+  {
+    memcpy((uint8_t *) bleChar->_value, pData, bleChar->_valueLen);
   }
-  memcpy((uint8_t *) bleChar->_value, pData, size);
-  logParam("Value", (const uint8_t *) bleChar->_value, size, isBigEnd);
+}
+
+/*
+ * Called in the NPI task for every client write, before the SAP service
+ * table is searched. Writes to characteristics with a write callback are
+ * stored and confirmed right here, without logging so the NPI task never
+ * waits for the sketch to release the log, and then handed to the callback.
+ * Write commands (BLE_WRITABLE_NORSP) get no confirmation, the NP does not
+ * expect one.
+ */
+static bool fastWriteCB(snpCharWriteInd_t *pInd, uint16_t len)
+{
+  for (uint8_t i = 0; i < BLE_MAX_WRITE_CALLBACKS; i++)
+  {
+    BLE_Char *bleChar = writeCallbacks[i].bleChar;
+    if (bleChar && bleChar->_handle == pInd->attrHandle)
+    {
+      snpCharWriteCnf_t cnf;
+      charStoreValue(bleChar, pInd->pData, len, bleChar->_isBigEnd);
+      if (bleChar == &rxChar)
+      {
+        BLESerial_clientWrite(len, pInd->pData);
+      }
+      /* Answer the client before running the callback. */
+      if (pInd->rspNeeded)
+      {
+        cnf.status = SNP_SUCCESS;
+        cnf.connHandle = pInd->connHandle;
+        SNP_RPC_writeCharCnf(&cnf);
+      }
+      writeCallbacks[i].writeFxn(bleChar);
+      return true;
+    }
+  }
+  return false;
 }
 
 static void addServiceNode(BLE_Service *service)
@@ -128,40 +292,108 @@ static void addServiceNode(BLE_Service *service)
   }
 }
 
-static BLE_Char* getChar(uint16_t handle)
+/*
+ * Entries past the current length start out as BLE_ATTR_NONE. The new table
+ * is filled in on the side and swapped in with task switching disabled, so
+ * the NPI task sees either table whole. It never keeps hold of one across a
+ * task switch, so the old one can go right after.
+ */
+static bool resizeHandleTable(uint16_t len)
 {
-  BLE_Service *service = getServiceWithChar(handle);
-  for (uint8_t i = 0; i < service->numChars; i++)
+  BLE_Handle_Entry *table = NULL;
+  if (len == handleTableLen)
   {
-    if (service->chars[i]->_handle == handle)
+    return true;
+  }
+  if (len)
+  {
+    table = (BLE_Handle_Entry *) malloc(len * sizeof(*handleTable));
+    if (table == NULL)
+    {
+      return false;
+    }
+    uint16_t keep = MIN(len, handleTableLen);
+    if (keep)
     {
-      return service->chars[i];
+      memcpy(table, handleTable, keep * sizeof(*handleTable));
     }
+    memset(&table[keep], 0, (len - keep) * sizeof(*handleTable));
   }
-  return NULL;
+  BLE_Handle_Entry *old = handleTable;
+  UInt key = Task_disable();
+  handleTable = table;
+  handleTableLen = len;
+  Task_restore(key);
+  free(old);
+  return true;
 }
 
-static BLE_Char* getCCCD(uint16_t handle)
+/*
+ * The NP hands out handles in increasing order, so the table only ever
+ * grows at the end, and the first value handle registered is its base.
+ */
+static void setHandleEntry(uint16_t handle, BLE_Char *bleChar, uint8_t attr)
 {
-  BLE_Service *service = getServiceWithChar(handle);
-  for (uint8_t i = 0; i < service->numChars; i++)
+  if (handle == SNP_INVALID_HANDLE)
   {
-    if (service->chars[i]->_CCCDHandle == handle)
-    {
-      return service->chars[i];
-    }
+    return;
   }
-  return NULL;
+  if (handleTableUsed == 0)
+  {
+    handleTableBase = handle;
+  }
+  uint16_t i = handle - handleTableBase;
+  if (handle < handleTableBase ||
+      (i >= handleTableLen && !resizeHandleTable(i + 1)))
+  {
+    handleTableFull = true;
+    return;
+  }
+  UInt key = Task_disable();
+  handleTable[i].bleChar = bleChar;
+  handleTable[i].attr = attr;
+  Task_restore(key);
+  handleTableUsed = MAX(handleTableUsed, i + 1);
 }
 
-static BLE_Service* getServiceWithChar(uint16_t handle)
+/* Declaration, value and CCCD, plus the descriptors constructChar adds. */
+static uint8_t charAttrCount(BLE_Char *bleChar)
 {
-  BLE_Service_Node *curr = bleServiceListHead;
-  while (curr->next && curr->next->service->_handle <= handle)
+  return 3 + (bleChar->charDesc ? 1 : 0) + (bleChar->_valueFormat ? 1 : 0);
+}
+
+/* Clear the entries from used on, recorded by a registration that failed. */
+static void dropHandleEntries(uint16_t used)
+{
+  if (used < handleTableUsed)
   {
-    curr = curr->next;
-  } // At end of loop, curr->service->_handle <= handle < curr-next->service->_handle
-  return curr->service;
+    UInt key = Task_disable();
+    memset(&handleTable[used], 0,
+           (handleTableUsed - used) * sizeof(*handleTable));
+    Task_restore(key);
+    handleTableUsed = used;
+  }
+}
+
+static BLE_Char* getHandleEntry(uint16_t handle, uint8_t attr)
+{
+  uint16_t i = handle - handleTableBase;
+  if (handle >= handleTableBase && i < handleTableLen &&
+      handleTable[i].attr == attr)
+  {
+    return handleTable[i].bleChar;
+  }
+  return NULL;
+}
+
+static BLE_Char* getChar(uint16_t handle)
+{
+  return getHandleEntry(handle, BLE_ATTR_VALUE);
+}
+
+static BLE_Char* getCCCD(uint16_t handle)
+{
+  return getHandleEntry(handle, BLE_ATTR_CCCD);
 }
 
 static void constructService(SAP_Service_t *service, BLE_Service *bleService)
@@ -171,19 +403,32 @@ static void constructService(SAP_Service_t *service, BLE_Service *bleService)
   service->serviceUUID.len    = bleService->_UUIDlen;
   service->serviceUUID.pUUID  = bleService->UUID;
   service->serviceType        = SNP_PRIMARY_SERVICE;
-  service->charTableLen       = bleService->numChars; // sizeof with static array?
-  service->charTable          = (SAP_Char_t *) malloc(service->charTableLen *
-                                                    sizeof(*service->charTable));
-  service->context            = NULL;
+  service->charTableLen       = bleService->numChars;
+  /* No tables, SAP asks for each characteristic as it sends it. */
+  service->charTable          = NULL;
+  service->context            = bleService;
   service->charReadCallback   = serviceReadAttrCB;
   service->charWriteCallback  = serviceWriteAttrCB;
   service->cccdIndCallback    = serviceCCCDIndCB;
-  service->charAttrHandles    = (SAP_CharHandle_t *) malloc(service->charTableLen *
-                                                            sizeof(*service->charAttrHandles));
-  for (uint8_t i = 0; i < bleService->numChars; i++)
-  {
-    constructChar(&service->charTable[i], bleService->chars[i]);
-  }
+  service->charAttrHandles    = NULL;
+  service->charDeclCallback   = charDeclCB;
+  service->charHandlesCallback = charHandlesCB;
+}
+
+static void charDeclCB(void *context, uint8_t index, SAP_Char_t *pChar)
+{
+  constructChar(pChar, ((BLE_Service *) context)->chars[index]);
+}
+
+static void charHandlesCB(void *context, uint8_t index,
+                          SAP_CharHandle_t *pHandles)
+{
+  BLE_Char *bleChar = ((BLE_Service *) context)->chars[index];
+  bleChar->_handle = pHandles->valueHandle;
+  bleChar->_CCCDHandle = pHandles->cccdHandle;
+  setHandleEntry(pHandles->valueHandle, bleChar, BLE_ATTR_VALUE);
+  setHandleEntry(pHandles->cccdHandle, bleChar, BLE_ATTR_CCCD);
+  setHandleEntry(pHandles->userDescHandle, bleChar, BLE_ATTR_USER_DESC);
 }
 
 static uint8_t setPermissions(uint8_t props)
@@ -239,7 +484,7 @@ static void constructChar(SAP_Char_t *sapChar, BLE_Char *bleChar)
 
   if (bleChar->charDesc)
   {
-    sapChar->pUserDesc = (SAP_UserDescAttr_t *) malloc(sizeof(*sapChar->pUserDesc));
+    sapChar->pUserDesc = &declUserDesc;
     sapChar->pUserDesc->perms    = SNP_GATT_PERMIT_READ;
     uint16_t charStrLen = strlen(bleChar->charDesc) + 1; // +1 for null term
     sapChar->pUserDesc->maxLen   = charStrLen;
@@ -250,11 +495,11 @@ static void constructChar(SAP_Char_t *sapChar, BLE_Char *bleChar)
   {
     sapChar->pUserDesc = NULL;
   }
-  sapChar->pCccd = (SAP_UserCCCDAttr_t *) malloc(sizeof(*sapChar->pCccd));
+  sapChar->pCccd = &declCCCD;
   sapChar->pCccd->perms          = SNP_GATT_PERMIT_READ | SNP_GATT_PERMIT_WRITE;
   if (bleChar->_valueFormat)
   {
-    sapChar->pFormat = (SAP_FormatAttr_t *) malloc(sizeof(*sapChar->pFormat));
+    sapChar->pFormat = &declFormat;
     sapChar->pFormat->format     = bleChar->_valueFormat;
     sapChar->pFormat->exponent   = bleChar->_valueExponent;
     sapChar->pFormat->unit       = 0;
@@ -267,6 +512,9 @@ static void constructChar(SAP_Char_t *sapChar, BLE_Char *bleChar)
   }
   sapChar->pShortUUID  = NULL;
   sapChar->pLongUUID   = NULL;
+  sapChar->mgmtOption  = bleChar->_npMaxLen ? SNP_CHAR_MANAGED_BY_NP
+                                            : SNP_CHAR_MANAGED_BY_AP;
+  sapChar->maxLen      = bleChar->_npMaxLen;
 }
 
 /* Array guaranteed to have 16 bytes. */
@@ -334,7 +582,7 @@ static uint8_t serviceWriteAttrCB(void *context,
   uint8_t status = SNP_SUCCESS;
   if (bleChar == NULL)
   {
-    status = SNP_UNKNOWN_ATTRIBUTE;
+    return SNP_UNKNOWN_ATTRIBUTE;
   }
   logAcquire();
   logChar("Client writing");
@@ -412,4 +660,7 @@ void BLE_clearServices(void)
   }
   bleServiceListHead = NULL;
   bleServiceListTail = NULL;
+  resizeHandleTable(0);
+  handleTableBase = 0;
+  handleTableUsed = 0;
 }
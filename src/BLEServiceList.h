@@ -7,6 +7,7 @@
 int BLE_registerService(BLE_Service *bleService);
 void BLE_resetCCCD(void);
 void BLE_charWriteValue(BLE_Char *bleChar, void *pData, size_t size, bool isBigEnd);
+int BLE_setWriteCallback(BLE_Char *bleChar, charWriteFxn_t writeFxn);
 void BLE_clearServices(void);
 
 #endif
@@ -6,6 +6,7 @@
 
 #include "ti/sap/sap.h"
 #include "ti/npi/hal_defs.h"
+#include "ti/npi/npi_task.h"
 
 /* Energia BLE status codes */
 #define BLE_SUCCESS                    SNP_SUCCESS // 0x00
@@ -19,6 +20,7 @@
 #define BLE_NOT_IMPLEMENTED            0x52
 #define BLE_TIMEOUT                    0x53
 #define BLE_CHECK_ERROR                0x54
+#define BLE_PENDING                    0x55 // Pipelined, not confirmed yet
 
 /* Log Levels */
 #define BLE_LOG_NONE                   0x00
@@ -33,7 +35,18 @@
    processor and the bluetooth chip */
 #define BLE_PORT_LOCAL                 SAP_PORT_LOCAL // unsupported
 #define BLE_PORT_UART                  SAP_PORT_REMOTE_UART
-#define BLE_PORT_SPI                   SAP_PORT_REMOTE_SPI // unsupported
+#define BLE_PORT_SPI                   SAP_PORT_REMOTE_SPI
+
+/* UART bit rate the SNP boots with. ble.begin() can raise it afterwards. */
+#define BLE_DEFAULT_UART_BIT_RATE      115200
+
+/*
+ * For setWriteTimeout.
+ * How long writes wait for room in the NPI transmit queue, in ms. Without
+ * waiting, a write sends what fits and returns how much that was.
+ */
+#define BLE_WRITE_NONBLOCKING          0
+#define BLE_WRITE_BLOCKING             0xFFFFFFFF
 
 /*
  * For setAdvertData.
@@ -80,6 +93,16 @@
  */
 #define BLE_SERIAL_BUFFER_SIZE 128
 
+/* Characteristics that can have a write callback, see setWriteCallback. */
+#define BLE_MAX_WRITE_CALLBACKS        4
+
+/*
+ * For beginPipeline.
+ * Commands one pipeline tracks. Past this, commands wait for their own
+ * confirmation as they do outside a pipeline.
+ */
+#define BLE_PIPELINE_DEPTH             8
+
 /*
  * Security Parameters
  */
@@ -129,6 +152,7 @@ typedef struct
   uint8_t           _CCCD;
   uint16_t          _CCCDHandle;
   uint8_t           _UUIDlen;
+  uint16_t          _npMaxLen; // nonzero if the NP stores the value, see useNPValue
 } BLE_Char;
 
 typedef struct
@@ -156,6 +180,20 @@ typedef struct
 
 typedef void (*displayStringFxn_t)(const char string[]);
 typedef void (*displayUIntFxn_t)(uint32_t num);
+typedef void (*charWriteFxn_t)(BLE_Char *bleChar);
+
+/* A command sent while a pipeline was open, see endPipeline. */
+typedef struct
+{
+  uint8_t           opcode; // SNP request, e.g. SNP_SET_ADV_DATA_REQ
+  uint8_t           status; // How the NP confirmed it, BLE_TIMEOUT if it didn't
+} BLE_Pipeline_Cmd;
+
+typedef struct
+{
+  uint8_t           count; // Commands in cmd, in the order they were sent
+  BLE_Pipeline_Cmd  cmd[BLE_PIPELINE_DEPTH];
+} BLE_Pipeline_Result;
 
 /*******************************************************************************
  * See the SNP API guide for documentation on these typedefs.
@@ -166,4 +204,9 @@ typedef snpTestCmdRsp_t BLE_Test_Command_Rsp;
 typedef snpUpdateConnParamReq_t BLE_Conn_Params_Update_Req;
 typedef snpConnEstEvt_t BLE_Conn_Params;
 
+/*
+ * Counters of the link to the network processor, see npi_task.h.
+ */
+typedef NPI_Stats BLE_Transport_Stats;
+
 #endif
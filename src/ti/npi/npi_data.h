@@ -55,6 +55,7 @@ extern "C"
 #ifdef ENERGIA
 #   define POWER_SAVING
 #   define NPI_USE_UART
+#   define NPI_USE_SPI
 #   define NPI_MASTER
 #endif //ENERGIA
 
@@ -87,6 +88,15 @@ extern "C"
 #define NPI_MSG_LEN_LENGTH                      2
 #define NPI_MSG_HDR_LENGTH                      NPI_MSG_CMD_LENGTH + \
                                                 NPI_MSG_LEN_LENGTH
+#define NPI_MSG_SOF_LENGTH                      1
+#define NPI_MSG_FCS_LENGTH                      1
+
+//! \brief Bytes reserved in front of and behind the payload of every NPI
+//!        frame so the transport can frame it in place:
+//!        [ SOF ][ Len0 ][ Len1 ][ Cmd0 ][ Cmd1 ][ Data Payload ][ FCS ]
+#define NPI_FRAME_HEADROOM                      (NPI_MSG_SOF_LENGTH + \
+                                                 NPI_MSG_HDR_LENGTH)
+#define NPI_FRAME_TAILROOM                      NPI_MSG_FCS_LENGTH
 //! \brief NPI Subsystem IDs
 //!
 #define RPC_SYS_RES0                            0
@@ -146,7 +156,8 @@ extern "C"
 #define NPI_CMD0_SS_MASK_CLR                    0xE0
 
 #define NPI_SERIAL_TYPE_UART                    0
-#define NPI_SERIAL_TYPE_SPI                     1  // Not supported
+#define NPI_SERIAL_TYPE_SPI                     1
+#define NPI_SERIAL_TYPE_LOOPBACK                2  // In-process, no hardware
 
 //! \brief Returns the message type of an NPI message
 #define NPI_GET_MSG_TYPE(pMsg)          ((pMsg->cmd0 & NPI_CMD0_TYPE_MASK)>> 5)
@@ -162,6 +173,9 @@ extern "C"
 #define NPI_SET_SS_ID(pMsg,SSID)        pMsg->cmd0 &= NPI_CMD0_SS_MASK_CLR; \
                                         pMsg->cmd0 |= ( (SSID & 0x1F) );
 
+//! \brief Returns the start of the on-the-wire image of an NPI frame (SOF)
+#define NPI_GET_WIRE_BUF(pMsg)          ((pMsg)->pData - NPI_FRAME_HEADROOM)
+
 // ****************************************************************************
 // typedefs
 // ****************************************************************************
@@ -180,7 +194,7 @@ typedef struct _npiFrame_t
 typedef union
 {
   UART_Params uartParams;
-  SPI_Params spiParams;                 // Not supported
+  SPI_Params spiParams;
 } npiInterfaceParams;
 
 //*****************************************************************************
@@ -34,15 +34,18 @@
 // includes
 // ****************************************************************************
 #include <string.h>
+#include <stddef.h>
 #include <stdbool.h>
 #include <stdlib.h>
 
 #include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+#include <ti/sysbios/hal/Hwi.h>
 #ifdef ICALL_EVENTS
 #include <ti/sysbios/knl/Event.h>
-#else //!ICALL_EVENTS
-#include <ti/sysbios/knl/Semaphore.h>
 #endif //ICALL_EVENTS
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Clock.h>
 #include <ti/sysbios/knl/Queue.h>
 #include <ti/sysbios/knl/Task.h>
 #include <ti/sysbios/BIOS.h>
@@ -74,12 +77,16 @@
 //! \brief Remote Rdy received Event
 #define NPITASK_REM_RDY_EVENT               Event_Id_04
 
+//! \brief Outstanding SYNC REQ given up on, see NPITask_cancelSyncReq
+#define NPITASK_SYNC_CANCEL_EVENT           Event_Id_05
+
 #define NPITASK_ALL_EVENTS                  (NPITASK_ICALL_EVENT | \
                                              NPITASK_FRAME_RX_EVENT | \
                                              NPITASK_TX_READY_EVENT | \
                                              NPITASK_SYNC_FRAME_RX_EVENT | \
                                              NPITASK_TX_DONE_EVENT | \
-                                             NPITASK_REM_RDY_EVENT)
+                                             NPITASK_REM_RDY_EVENT | \
+                                             NPITASK_SYNC_CANCEL_EVENT)
 #else //!ICALL_EVENTS
 //! \brief ASYNC Message Received Event (no framing bytes)
 #define NPITASK_FRAME_RX_EVENT              0x0008
@@ -95,6 +102,9 @@
 
 //! \brief Remote Rdy received Event
 #define NPITASK_REM_RDY_EVENT               0x0080
+
+//! \brief Outstanding SYNC REQ given up on, see NPITask_cancelSyncReq
+#define NPITASK_SYNC_CANCEL_EVENT           0x0100
 #endif //ICALL_EVENTS
 
 //! \brief Task priority for NPI RTOS task
@@ -109,6 +119,18 @@
 #define REM_RDY_ASSERTED                    0x00
 #define REM_RDY_DEASSERTED                  0x01
 
+//! \brief Lane of frames that are not latency tracked, ie. SYNC frames
+#define NPITASK_LANE_NONE                   NPITASK_LANES
+
+//! \brief Lane latencies are binned by the bit length of their timestamp
+//!        ticks, one bin per power of 2
+#define NPITASK_LAT_BINS                    33
+
+//! \brief Returns the block an NPI frame was allocated in
+#define NPITASK_FRAME_BLOCK(pMsg)           ((_npiFrameBlock_t *) \
+                                             ((uint8_t *)(pMsg) - \
+                                              offsetof(_npiFrameBlock_t, frame)))
+
 // ****************************************************************************
 // typedefs
 // ****************************************************************************
@@ -130,6 +152,31 @@ typedef struct _npiFromICallTableEntry_t
     npiFromICallCBack_t ssCB;
 } _npiFromICallTableEntry_t;
 
+//! \brief Every NPI frame carries the link that puts it on the free list of
+//!        the frame pool, so the pool needs no node of its own. Headroom,
+//!        payload and tailroom follow the frame.
+typedef struct _npiFrameBlock_t
+{
+    Queue_Elem          elem;
+    uint32_t            stamp;          //!< When an ASYNC TX frame was queued
+                                        //!< or an RX frame was received
+    uint8_t             lane;           //!< Lane of an ASYNC TX frame
+    _npiFrame_t         frame;
+} _npiFrameBlock_t;
+
+//! \brief ASYNC TX lane. Filled by any task through NPITask_sendToHostLane,
+//!        serialized with Task_disable, and drained by the NPI Task
+typedef struct _npiTxLane_t
+{
+    _npiRing_t          queue;
+    void                *slots[NPITASK_QUEUE_SIZE];
+    uint16_t            queueMax;
+    uint32_t            frames;
+    uint32_t            maxTicks;
+    uint64_t            totalTicks;
+    uint32_t            bins[NPITASK_LAT_BINS];
+} _npiTxLane_t;
+
 //*****************************************************************************
 // globals
 //*****************************************************************************
@@ -137,27 +184,108 @@ typedef struct _npiFromICallTableEntry_t
 Task_Handle npiTaskHandle;
 uint8_t *npiTaskStack;
 
-//! \brief Handle for the ASYNC TX Queue
-static Queue_Handle npiTxQueue;
+//! \brief ASYNC TX lanes, drained in npiTxLaneOrder
+static _npiTxLane_t npiTxLanes[NPITASK_LANES];
+static const uint8_t npiTxLaneOrder[NPITASK_LANES] = NPITASK_LANE_ORDER;
 
-//! \brief Handle for the ASYNC RX Queue
-static Queue_Handle npiRxQueue;
+//! \brief ASYNC RX Queue. Filled from the Transport Layer callback and
+//!        drained by the NPI Task
+static _npiRing_t npiRxQueue;
+static void *npiRxSlots[NPITASK_QUEUE_SIZE];
 
-//! \brief Handle for the SYNC TX Queue
-static Queue_Handle npiSyncTxQueue;
+//! \brief SYNC TX Queue, see _npiTxLane_t
+static _npiRing_t npiSyncTxQueue;
+static void *npiSyncTxSlots[NPITASK_QUEUE_SIZE];
 
-//! \brief Handle for the SYNC RX Queue
-static Queue_Handle npiSyncRxQueue;
+//! \brief SYNC RX Queue, see npiRxQueue
+static _npiRing_t npiSyncRxQueue;
+static void *npiSyncRxSlots[NPITASK_QUEUE_SIZE];
 
 //! \brief Flag/Counter indicating a Synchronous REQ/RSP is currently being
 //!        processed.
 static int8_t syncTransactionInProgress = 0;
 
-//! \brief Pointer to last tx message.  This is freed once confirmation is
-//!        is received that the buffer has been transmitted
+//! \brief ASYNC frames sent since the last SYNC REQ went out, counted up to
+//!        NPITASK_SYNC_INTERLEAVE while its response is outstanding
+static uint8_t syncInterleaveCount;
+static uint32_t syncInterleaved;
+
+//! \brief Frames handed to the Transport Layer, oldest first. The transport
+//!        sends straight out of these frames' buffers, so each is freed only
+//!        once confirmation is received that it has been transmitted
 //!        (ie. NPITASK_TRANSPORT_TX_DONE_EVENT)
 //!
-static uint8_t *lastQueuedTxMsg;
+static _npiFrame_t *txInFlight[NPITL_TX_RING_SIZE];
+static uint8_t txInFlightHead;
+static uint8_t txInFlightCount;
+
+//! \brief Number of frames the Transport Layer has reported transmitted that
+//!        have not been freed yet
+static volatile uint32_t txDoneCount;
+
+//! \brief Fixed size frame blocks, allocated in one piece at NPITask_open
+//!        and handed out from framePoolFree. Each holds a frame of up to
+//!        bufSize bytes on the wire. Frames that do not fit, or that are
+//!        asked for when all blocks are in use, come from the heap.
+static uint8_t *framePool;
+static uint16_t framePoolBlockSize;
+static uint8_t framePoolSize;
+static Queue_Struct framePoolFree;
+static uint8_t framePoolInUse;
+static uint8_t framePoolInUseMax;
+static uint32_t framePoolMisses;
+
+//! \brief Most frames waiting in each queue since the statistics were last
+//!        reset, and frames dropped because a queue was full
+static uint16_t syncTxQueueMax;
+static uint16_t rxQueueMax;
+static uint16_t syncRxQueueMax;
+static uint32_t queueDrops;
+
+//! \brief Sync RPC timing, see NPITask_getStats. Only one Sync REQ is
+//!        outstanding at a time, syncReqPending says syncReqStamp is its
+//!        start
+static bool syncReqPending;
+static uint32_t syncReqStamp;
+static uint32_t syncRpcCount;
+static uint32_t syncRpcMinTicks;
+static uint32_t syncRpcMaxTicks;
+static uint64_t syncRpcTotalTicks;
+
+//! \brief SYNC REQs cancelled by their sender, and SYNC RSPs dropped because
+//!        no SYNC REQ was waiting for them
+static uint32_t syncRpcTimeouts;
+static uint32_t syncStaleRsps;
+
+//! \brief SYNC REQs cancelled after they were sent and not answered yet. The
+//!        remote answers in order, so this many SYNC RSPs are dropped before
+//!        one is taken for the answer to a later SYNC REQ
+static uint8_t syncRspsOwed;
+
+//! \brief Set by NPITask_rejectSyncRsp while a SYNC RSP is routed
+static bool syncRspRejected;
+
+#if (NPI_FLOW_CTRL == 1)
+//! \brief Rem RDY was asserted while an RX queue was full. Loc RDY is held
+//!        off, so the remote keeps its frame, until NPITask_rxRoom says the
+//!        frame can be queued
+static bool remRdyHeld;
+#endif // NPI_FLOW_CTRL = 1
+
+//! \brief ASYNC RX routing time, see NPITask_getStats
+static uint32_t rxRouteCount;
+static uint32_t rxRouteMaxTicks;
+static uint64_t rxRouteTotalTicks;
+
+//! \brief Bulk lane credit, see NPITask_getTxCredit. Frames and payload bytes
+//!        are taken under Task_disable as a frame is queued and given back
+//!        with NPIUtil_atomicAdd by the NPI Task once it is sent.
+//!        txCreditSem wakes tasks waiting in NPITask_waitTxCredit
+static uint16_t txBulkMaxFrames;
+static uint16_t txBulkMaxBytes;
+static volatile uint32_t txBulkFrames;
+static volatile uint32_t txBulkBytes;
+static Semaphore_Handle txCreditSem;
 
 #ifdef ICALL_EVENTS
 static ICall_SyncHandle syncEvent;
@@ -169,12 +297,12 @@ static ICall_Semaphore npiSem = NULL;
 static Semaphore_Handle npiSem;
 #endif //USE_ICALL
 
-//! \brief Task pending events
+//! \brief Task pending events, only touched by the NPI Task
 static uint16_t NPITask_events = 0;
 
-//! \brief Event flags for capturing Task-related events from ISR context
-static uint16_t tlDoneISRFlag = 0;
-static uint16_t remRdyISRFlag = 0;
+//! \brief Events posted to the NPI Task from other tasks and ISR context.
+//!        Set with NPIUtil_atomicOr and collected with NPIUtil_atomicSwap
+static volatile uint32_t npiPostedEvents = 0;
 #endif //ICALL_EVENTS
 
 #ifdef USE_ICALL
@@ -199,11 +327,16 @@ static uint8_t taskOpen = 0;
 const NPI_Params NPI_defaultParams = {
     .stackSize          = 1024,
     .bufSize            = 530,
+    .framePoolSize      = 8,
+    .txBulkFrames       = 8,
+    .txBulkBytes        = 1024,
     .mrdyPinID          = (uint32_t)~0,
     .srdyPinID          = (uint32_t)~0,
 #if defined(NPI_USE_UART)
+    .portType           = NPI_SERIAL_TYPE_UART,
     .portBoardID        = (uint8_t)~0,                     /* CC2650_UART0 */
 #elif defined(NPI_USE_SPI)
+    .portType           = NPI_SERIAL_TYPE_SPI,
     .portBoardID        = (uint8_t)~0,
 #endif
 };
@@ -221,17 +354,22 @@ static void NPITask_RemRdyEventCB(uint8_t state);
 const npiTLCallBacks transportCBs = {
   &NPITask_RemRdyEventCB,
   &NPITask_transportDoneCallBack,
+  &NPITask_mallocFrame,
+  &NPITask_freeFrame,
 };
 
 //! \brief ASYNC TX Q Processing function.
-static void NPITask_ProcessTXQ(Queue_Handle txQ);
+static void NPITask_ProcessTXQ(_npiRing_t *txQ);
 
 //! \brief ASYNC RX Q Processing function.
-static void NPITask_processRXQ(void);
+static bool NPITask_processRXQ(void);
 
 //! \brief SYNC RX Q Processing function.
 static void NPITask_processSyncRXQ(void);
 
+//! \brief Stops waiting for the response to a cancelled SYNC REQ
+static void NPITask_processSyncCancel(void);
+
 //! \brief Function to route NPI Message to the appropriate subsystem
 static uint8_t NPITask_routeHostToSS(_npiFrame_t *pNPIMsg);
 
@@ -240,13 +378,36 @@ static uint8_t NPITask_routeHostToSS(_npiFrame_t *pNPIMsg);
 static uint8_t NPITask_routeICallToSS(ICall_ServiceEnum src, uint8_t *pGenMsg);
 #endif //USE_ICALL
 
-//! \brief Function that transforms NPI Frame struct into a byte array. This is
-//         necessary to send data over NPI Transport Layer
+//! \brief Function that fills in the header bytes reserved in front of the
+//         payload of an NPI Frame so it can be sent over NPI Transport Layer
 static uint8_t * NPITask_SerializeFrame(_npiFrame_t *pNPIMsg);
 
-//! \brief Function that transforms byte contents of NPI RxBuf into an NPI Frame
-//!        struct that can be routed.
-static _npiFrame_t * NPITask_DeserializeFrame();
+//! \brief Puts an NPI frame in an NPI Task queue and wakes the task
+static bool NPITask_enqueueFrame(_npiRing_t *msgQueue, uint16_t *pQueueMax,
+                                 uint32_t event, _npiFrame_t *pMsg);
+
+//! \brief Wakes the NPI Task for an event
+static void NPITask_postEvent(uint32_t event);
+
+//! \brief Picks the ASYNC TX lane to send from next
+static _npiRing_t * NPITask_nextTxLane(uint32_t events);
+
+//! \brief Checks for frames waiting in any TX queue
+static bool NPITask_txPending(void);
+
+#if (NPI_FLOW_CTRL == 1)
+//! \brief Checks the RX queues can take the next frame from the remote
+static bool NPITask_rxRoom(void);
+#endif // NPI_FLOW_CTRL = 1
+
+//! \brief Records the latency of a transmitted frame against its lane
+static void NPITask_recordTxDone(_npiFrame_t *pMsg);
+
+//! \brief Gives back the bulk lane credit a frame holds
+static void NPITask_releaseTxCredit(_npiFrame_t *pMsg);
+
+//! \brief Checks the bulk lane takes a frame of len payload bytes
+static bool NPITask_hasTxCredit(uint16_t len);
 
 // -----------------------------------------------------------------------------
 //! \brief      NPI main event processing loop.
@@ -255,7 +416,6 @@ static _npiFrame_t * NPITask_DeserializeFrame();
 // -----------------------------------------------------------------------------
 void NPITask_Fxn(UArg a0, UArg a1)
 {
-    _npiCSKey_t key;
 #ifdef USE_ICALL
     uint8_t *pMsg;
     ICall_ServiceEnum stackid;
@@ -284,21 +444,13 @@ void NPITask_Fxn(UArg a0, UArg a1)
         if (Semaphore_pend(npiSem,BIOS_WAIT_FOREVER))
 #endif //ICALL_EVENTS
         {
-            // Capture the ISR events flags now within a critical section.
-            // We do this to avoid possible race conditions where the ISR is
-            // modifying the event mask while the task is read/writing it.
-            key = NPIUtil_EnterCS();
-
 #ifndef ICALL_EVENTS
-            NPITask_events = NPITask_events | tlDoneISRFlag |
-                             remRdyISRFlag;
-
-            tlDoneISRFlag = 0;
-            remRdyISRFlag = 0;
+            // Collect the events posted from other tasks and ISR context.
+            // Taking them in one atomic swap leaves no window where a post
+            // is lost, and interrupts stay enabled
+            NPITask_events |= NPIUtil_atomicSwap(&npiPostedEvents, 0);
 #endif //ICALL_EVENTS
 
-            NPIUtil_ExitCS(key);
-
             // Remote RDY event
             if (NPITask_events & NPITASK_REM_RDY_EVENT)
             {
@@ -306,15 +458,42 @@ void NPITask_Fxn(UArg a0, UArg a1)
                 NPITask_events &= ~NPITASK_REM_RDY_EVENT;
 #endif //ICALL_EVENTS
 #if (NPI_FLOW_CTRL == 1)
-                NPITL_handleRemRdyEvent();
+                // With nowhere to queue the frame, leave it with the remote
+                // instead of reading it only to drop it
+                if (NPITask_rxRoom())
+                {
+                    NPITL_handleRemRdyEvent();
+                }
+                else
+                {
+                    remRdyHeld = true;
+                }
 #endif // NPI_FLOW_CTRL = 1
             }
+            // SYNC REQ cancelled, handled ahead of TX so the next one is
+            // sent with the transaction state reset
+            if (NPITask_events & NPITASK_SYNC_CANCEL_EVENT)
+            {
+#ifndef ICALL_EVENTS
+                NPITask_events &= ~NPITASK_SYNC_CANCEL_EVENT;
+#endif //ICALL_EVENTS
+                NPITask_processSyncCancel();
+            }
             // TX Frame has been successfully sent
             if (NPITask_events & NPITASK_TX_DONE_EVENT)
             {
-                //Deallocate most recent message being transmitted.
-                NPIUTIL_FREE(lastQueuedTxMsg);
-                lastQueuedTxMsg = NULL;
+                uint32_t txDone = NPIUtil_atomicSwap(&txDoneCount, 0);
+
+                //Deallocate messages that have been transmitted, in the order
+                //they were handed to the Transport Layer.
+                while (txDone-- && txInFlightCount)
+                {
+                    NPITask_recordTxDone(txInFlight[txInFlightHead]);
+                    NPITask_releaseTxCredit(txInFlight[txInFlightHead]);
+                    NPITask_freeFrame(txInFlight[txInFlightHead]);
+                    txInFlightHead = (txInFlightHead + 1) % NPITL_TX_RING_SIZE;
+                    txInFlightCount--;
+                }
 #ifndef ICALL_EVENTS
                 NPITask_events &= ~NPITASK_TX_DONE_EVENT;
 #endif //ICALL_EVENTS
@@ -322,25 +501,31 @@ void NPITask_Fxn(UArg a0, UArg a1)
             // Frame is ready to send to the Host
             if (NPITask_events & NPITASK_TX_READY_EVENT)
             {
-                // Cannot send if NPI Tl is already busy.
-                if (!NPITL_checkNpiBusy())
+                // Restart frames already handed to the TL if the link has
+                // become idle since.
+                NPITL_resumeTL();
+
+                // Keep the TL Tx ring filled so the next frame is ready as
+                // soon as the current one is on the wire. Cannot hand over
+                // more if the ring is full.
+                while (NPITL_getTxSlotsFree())
                 {
-                    // Check for outstanding SYNC REQ/RSP transactions.  If so,
-                    // this ASYNC message must remain Q'd while we wait for the
-                    // SYNC RSP.
-                    if (!Queue_empty(npiSyncTxQueue) &&
+                    _npiRing_t *txQ;
+
+                    if (NPIUtil_ringCount(&npiSyncTxQueue) &&
                             syncTransactionInProgress >= 0)
                     {
                         // Prioritize Synchronous traffic
-                        NPITask_ProcessTXQ(npiSyncTxQueue);
+                        NPITask_ProcessTXQ(&npiSyncTxQueue);
+                    }
+                    else if ((txQ = NPITask_nextTxLane(NPITask_events)) != NULL)
+                    {
+                        // Process ASYNC messages, highest priority lane first
+                        NPITask_ProcessTXQ(txQ);
                     }
-                    else if (!(NPITask_events & NPITASK_SYNC_FRAME_RX_EVENT) &&
-                                 syncTransactionInProgress == 0 &&
-                                   !Queue_empty(npiTxQueue))
+                    else
                     {
-                        // No outstanding SYNC REQ/RSP transactions, process
-                        // ASYNC messages.
-                        NPITask_ProcessTXQ(npiTxQueue);
+                        break;
                     }
                 }
 
@@ -383,7 +568,13 @@ void NPITask_Fxn(UArg a0, UArg a1)
                 NPITask_events &= ~NPITASK_SYNC_FRAME_RX_EVENT;
 #endif //ICALL_EVENTS
 
-                if (!Queue_empty(npiSyncRxQueue))
+                // ASYNC frames held back for the SYNC frame can go now
+                if (NPITask_txPending())
+                {
+                    NPITask_postEvent(NPITASK_TX_READY_EVENT);
+                }
+
+                if (NPIUtil_ringCount(&npiSyncRxQueue))
                 {
                     // Queue is not empty so reset flag to process remaining
                     // frame(s)
@@ -409,15 +600,24 @@ void NPITask_Fxn(UArg a0, UArg a1)
             if (NPITask_events & NPITASK_FRAME_RX_EVENT &&
                   syncTransactionInProgress == 0)
             {
-                // Process the ASYNC message and clear event flag
-                NPITask_processRXQ();
+                uint8_t budget = NPITASK_RX_BUDGET;
+
+                // Route every ASYNC message waiting, up to the budget so a
+                // long burst does not hold back frames waiting to be sent,
+                // and clear event flag
+                while (budget && syncTransactionInProgress == 0 &&
+                       NPITask_processRXQ())
+                {
+                    budget--;
+                }
 #ifndef ICALL_EVENTS
                 NPITask_events &= ~NPITASK_FRAME_RX_EVENT;
 #endif //ICALL_EVENTS
 
-                if (!Queue_empty(npiRxQueue))
+                if (NPIUtil_ringCount(&npiRxQueue))
                 {
-                    // Q is not empty reset flag and process next message
+                    // Budget used up, reset flag and come back for the rest
+                    // after TX has had its turn
 #ifdef ICALL_EVENTS
                     Event_post(syncEvent, NPITASK_FRAME_RX_EVENT);
 #else //!ICALL_EVENTS
@@ -426,6 +626,16 @@ void NPITask_Fxn(UArg a0, UArg a1)
 #endif //ICALL_EVENTS
                 }
             }
+#if (NPI_FLOW_CTRL == 1)
+
+            // Frames have been taken off the RX queues, let in the one the
+            // remote has been holding
+            if (remRdyHeld && NPITask_rxRoom())
+            {
+                remRdyHeld = false;
+                NPITL_handleRemRdyEvent();
+            }
+#endif // NPI_FLOW_CTRL = 1
         }
     }
 }
@@ -443,24 +653,62 @@ uint8_t NPITask_Params_init(NPI_Params *params)
   {
     *params = NPI_defaultParams;
 
+    return NPITask_Params_initPortType(params, NPI_defaultParams.portType);
+  }
+
+  return NPI_TASK_INVALID_PARAMS;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Set the port type of a NPI_Params struct and initialize its
+//!             port params with the default values for that port
+//!
+//! \param[in]  params    Pointer to NPI params to be updated
+//! \param[in]  portType  NPI_SERIAL_TYPE_[UART,SPI,LOOPBACK]
+//!
+//! \return     uint8_t   Status NPI_SUCCESS, or NPI_TASK_INVALID_PARAMS
+// -----------------------------------------------------------------------------
+uint8_t NPITask_Params_initPortType(NPI_Params *params, uint8_t portType)
+{
+  if (params == NULL)
+  {
+    return NPI_TASK_INVALID_PARAMS;
+  }
+
+  params->portType = portType;
+
+  switch (portType)
+  {
 #if defined(NPI_USE_UART)
-    UART_Params_init(&params->portParams.uartParams);
-    params->portParams.uartParams.readDataMode = UART_DATA_BINARY;
-    params->portParams.uartParams.writeDataMode = UART_DATA_BINARY;
-    params->portParams.uartParams.readMode = UART_MODE_CALLBACK;
-    params->portParams.uartParams.writeMode = UART_MODE_CALLBACK;
-    params->portParams.uartParams.readEcho = UART_ECHO_OFF;
-#elif defined(NPI_USE_SPI)
-    SPI_Params_init(&params->portParams.spiParams);
-    params->portParams.spiParams.mode = SPI_SLAVE;
-    params->portParams.spiParams.bitRate = 8000000;
-    params->portParams.spiParams.frameFormat = SPI_POL1_PHA1;
+    case NPI_SERIAL_TYPE_UART:
+      UART_Params_init(&params->portParams.uartParams);
+      params->portParams.uartParams.readDataMode = UART_DATA_BINARY;
+      params->portParams.uartParams.writeDataMode = UART_DATA_BINARY;
+      params->portParams.uartParams.readMode = UART_MODE_CALLBACK;
+      params->portParams.uartParams.writeMode = UART_MODE_CALLBACK;
+      params->portParams.uartParams.readEcho = UART_ECHO_OFF;
+      break;
 #endif //NPI_USE_UART
-
-    return NPI_SUCCESS;
+#if defined(NPI_USE_SPI)
+    case NPI_SERIAL_TYPE_SPI:
+      SPI_Params_init(&params->portParams.spiParams);
+#ifdef NPI_MASTER
+      params->portParams.spiParams.mode = SPI_MASTER;
+#else
+      params->portParams.spiParams.mode = SPI_SLAVE;
+#endif //NPI_MASTER
+      params->portParams.spiParams.bitRate = 8000000;
+      params->portParams.spiParams.frameFormat = SPI_POL1_PHA1;
+      params->portParams.spiParams.transferMode = SPI_MODE_CALLBACK;
+      break;
+#endif //NPI_USE_SPI
+    case NPI_SERIAL_TYPE_LOOPBACK:
+      break;
+    default:
+      return NPI_TASK_INVALID_PARAMS;
   }
 
-  return NPI_TASK_INVALID_PARAMS;
+  return NPI_SUCCESS;
 }
 
 // -----------------------------------------------------------------------------
@@ -475,6 +723,7 @@ uint8_t NPITask_open(NPI_Params *params)
 {
     NPITL_Params transportParams;
     Task_Params npiTaskParams;
+    uint8_t i;
 
     // Check to see if NPI has already been opened
     if (taskOpen)
@@ -493,7 +742,36 @@ uint8_t NPITask_open(NPI_Params *params)
 #ifndef ICALL_EVENTS
     NPITask_events = 0;
 #endif //ICALL_EVENTS
-    lastQueuedTxMsg = NULL;
+    txInFlightHead = 0;
+    txInFlightCount = 0;
+    txDoneCount = 0;
+#ifndef ICALL_EVENTS
+    npiPostedEvents = 0;
+#endif //ICALL_EVENTS
+    syncTxQueueMax = rxQueueMax = syncRxQueueMax = 0;
+    queueDrops = 0;
+    syncTransactionInProgress = 0;
+    syncInterleaveCount = 0;
+    syncInterleaved = 0;
+    txBulkMaxFrames = params->txBulkFrames < NPITASK_QUEUE_SIZE ?
+                      params->txBulkFrames : NPITASK_QUEUE_SIZE;
+    txBulkMaxBytes = params->txBulkBytes;
+    txBulkFrames = 0;
+    txBulkBytes = 0;
+    syncReqPending = false;
+    syncRpcCount = 0;
+    syncRpcMinTicks = 0;
+    syncRpcMaxTicks = 0;
+    syncRpcTotalTicks = 0;
+    syncRpcTimeouts = 0;
+    syncStaleRsps = 0;
+    syncRspsOwed = 0;
+#if (NPI_FLOW_CTRL == 1)
+    remRdyHeld = false;
+#endif // NPI_FLOW_CTRL = 1
+    rxRouteCount = 0;
+    rxRouteMaxTicks = 0;
+    rxRouteTotalTicks = 0;
 
 #ifndef ICALL_EVENTS
 #ifndef USE_ICALL
@@ -501,22 +779,59 @@ uint8_t NPITask_open(NPI_Params *params)
     npiSem = Semaphore_create(0, NULL, NULL);
 #endif //USE_ICALL
 #endif //ICALL_EVENTS
+    {
+        Semaphore_Params semParams;
+
+        Semaphore_Params_init(&semParams);
+        semParams.mode = Semaphore_Mode_BINARY;
+        txCreditSem = Semaphore_create(0, &semParams, NULL);
+    }
 
-    // create Queue instances
-    npiTxQueue = Queue_create(NULL, NULL);
-    npiRxQueue = Queue_create(NULL, NULL);
-    npiSyncRxQueue = Queue_create(NULL, NULL);
-    npiSyncTxQueue = Queue_create(NULL, NULL);
+    // Initialize Queue instances
+    memset(npiTxLanes, 0, sizeof(npiTxLanes));
+    for (i = 0; i < NPITASK_LANES; i++)
+    {
+        NPIUtil_ringInit(&npiTxLanes[i].queue, npiTxLanes[i].slots,
+                         NPITASK_QUEUE_SIZE);
+    }
+    NPIUtil_ringInit(&npiRxQueue, npiRxSlots, NPITASK_QUEUE_SIZE);
+    NPIUtil_ringInit(&npiSyncRxQueue, npiSyncRxSlots, NPITASK_QUEUE_SIZE);
+    NPIUtil_ringInit(&npiSyncTxQueue, npiSyncTxSlots, NPITASK_QUEUE_SIZE);
+
+    // Carve the frame pool into blocks that hold a frame of bufSize bytes on
+    // the wire, word aligned
+    framePoolBlockSize = (sizeof(_npiFrameBlock_t) + params->bufSize +
+                          sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+    framePoolSize = 0;
+    framePoolInUse = 0;
+    framePoolInUseMax = 0;
+    framePoolMisses = 0;
+    Queue_construct(&framePoolFree, NULL);
+    framePool = NPIUTIL_MALLOC((uint32_t)params->framePoolSize *
+                               framePoolBlockSize);
+    if (framePool != NULL)
+    {
+        for (framePoolSize = 0; framePoolSize < params->framePoolSize;
+             framePoolSize++)
+        {
+            Queue_put(Queue_handle(&framePoolFree), (Queue_Elem *)
+                      &framePool[framePoolSize * framePoolBlockSize]);
+        }
+    }
 
     // Initialize Transport Layer
     transportParams.npiTLBufSize = params->bufSize;
     transportParams.mrdyPinID = params->mrdyPinID;
     transportParams.srdyPinID = params->srdyPinID;
+    transportParams.portType = params->portType;
     transportParams.portBoardID = params->portBoardID;
     transportParams.portParams = params->portParams;
     transportParams.npiCallBacks = transportCBs;
 
-    NPITL_openTL(&transportParams);
+    if (NPITL_openTL(&transportParams) != NPI_SUCCESS)
+    {
+        return NPI_TASK_FAILURE;
+    }
 
    // Clear Routing Tables
     memset(HostToSSTable, 0, sizeof(_npiFromHostTableEntry_t)*NPI_MAX_SS_ENTRY);
@@ -557,6 +872,9 @@ uint8_t NPITask_close(void)
 #ifdef USE_ICALL
     return NPI_TASK_FAILURE;
 #else
+    _npiFrame_t *pMsg;
+    uint8_t i;
+
     if (!taskOpen)
     {
       return NPI_TASK_FAILURE;
@@ -569,17 +887,35 @@ uint8_t NPITask_close(void)
 #ifndef ICALL_EVENTS
     Semaphore_delete(&npiSem);
 #endif //ICALL_EVENTS
-    Queue_delete(&npiTxQueue);
-    Queue_delete(&npiRxQueue);
-    Queue_delete(&npiSyncRxQueue);
-    Queue_delete(&npiSyncTxQueue);
+    Semaphore_delete(&txCreditSem);
+    for (i = 0; i < NPITASK_LANES; i++)
+    {
+      while ((pMsg = NPIUtil_ringGet(&npiTxLanes[i].queue)) != NULL)
+      {
+        NPITask_freeFrame(pMsg);
+      }
+    }
+    while ((pMsg = NPIUtil_ringGet(&npiRxQueue)) != NULL ||
+           (pMsg = NPIUtil_ringGet(&npiSyncRxQueue)) != NULL ||
+           (pMsg = NPIUtil_ringGet(&npiSyncTxQueue)) != NULL)
+    {
+      NPITask_freeFrame(pMsg);
+    }
 
     // Free any message buffers for in-flight messages
-    if (lastQueuedTxMsg != NULL)
+    while (txInFlightCount)
     {
-      NPIUTIL_FREE(lastQueuedTxMsg);
+      NPITask_freeFrame(txInFlight[txInFlightHead]);
+      txInFlightHead = (txInFlightHead + 1) % NPITL_TX_RING_SIZE;
+      txInFlightCount--;
     }
 
+    // Every frame is back in the pool, release it in one piece
+    Queue_destruct(&framePoolFree);
+    NPIUTIL_FREE(framePool);
+    framePool = NULL;
+    framePoolSize = 0;
+
     // Delete NPI task
     NPIUTIL_FREE(npiTaskStack);
     Task_delete(&npiTaskHandle);
@@ -594,18 +930,89 @@ uint8_t NPITask_close(void)
 //!             NOTE: It's assumed all message traffic to the stack will use
 //!             other (ICALL) APIs/Interfaces.
 //!
+//!             The TX queues are filled from task context only, so sending
+//!             tasks are serialized with Task_disable and interrupts stay
+//!             enabled. A frame that does not fit in its queue is freed.
+//!
 //! \param[in]  pMsg    Pointer to "unframed" message buffer.
 //!
-//! \return     uint8_t Status NPI_SUCCESS, or NPI_SS_NOT_FOUND
+//! \return     uint8_t Status NPI_SUCCESS, NPI_BUSY or NPI_INVALID_PKT
 // -----------------------------------------------------------------------------
 uint8_t NPITask_sendToHost(_npiFrame_t *pMsg)
 {
+    return NPITask_sendToHostLane(pMsg, NPITASK_LANE_CONTROL);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      API for the sender of a SYNC REQ to stop waiting for its
+//!             response, e.g. after a timeout. The NPI Task no longer holds
+//!             ASYNC traffic back for it and drops the response if it still
+//!             arrives, also while a later SYNC REQ waits for its own.
+//!             SYNC REQs the sender queued behind it, e.g. the rest of a
+//!             batch, are freed unsent. The NPI Task runs at a higher
+//!             priority, so this is done by the time the call returns, as
+//!             long as the caller has not disabled task switching. Call it
+//!             before letting another task send SYNC REQs.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITask_cancelSyncReq(void)
+{
+    NPITask_postEvent(NPITASK_SYNC_CANCEL_EVENT);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      API for a subsystem, from its RX callback, to turn down the
+//!             SYNC RSP it is handed because it does not answer the SYNC REQ
+//!             waiting. The NPI Task keeps waiting for the answer instead of
+//!             closing the transaction. The subsystem still frees the frame.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITask_rejectSyncRsp(void)
+{
+    syncRspRejected = true;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      API for a subsystem, from its RX callback, to report that the
+//!             remote has restarted. SYNC REQs it had not answered when they
+//!             were cancelled are never answered now.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITask_remoteReset(void)
+{
+    syncRspsOwed = 0;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      API for application task to send an ASYNC message to the Host
+//!             on a given lane. SYNC messages ignore the lane.
+//!
+//!             See NPITask_sendToHost.
+//!
+//! \param[in]  pMsg    Pointer to "unframed" message buffer.
+//! \param[in]  lane    NPITASK_LANE_[CONTROL,CNF,BULK]
+//!
+//! \return     uint8_t Status NPI_SUCCESS, NPI_BUSY or NPI_INVALID_PKT
+// -----------------------------------------------------------------------------
+uint8_t NPITask_sendToHostLane(_npiFrame_t *pMsg, uint8_t lane)
+{
+    _npiFrameBlock_t *pBlock = NPITASK_FRAME_BLOCK(pMsg);
     uint8_t status = NPI_SUCCESS;
-    _npiCSKey_t key;
+    UInt key;
 
-    // Must block task pre-emption so that the higher priority NPI task
-    // does not clear the NPITask_events flag before pMsg is properly enqueued.
-    key = NPIUtil_EnterCS();
+    if (lane >= NPITASK_LANES)
+    {
+        lane = NPITASK_LANE_CONTROL;
+    }
+
+    // One producer at a time for each TX queue
+    key = Task_disable();
+
+    pBlock->stamp = Timestamp_get32();
+    pBlock->lane = NPITASK_LANE_NONE;
 
     switch (NPI_GET_MSG_TYPE(pMsg))
     {
@@ -613,24 +1020,35 @@ uint8_t NPITask_sendToHost(_npiFrame_t *pMsg)
         case NPI_MSG_TYPE_SYNCRSP:
         case NPI_MSG_TYPE_SYNCREQ:
         {
-#ifdef ICALL_EVENTS
-            NPIUtil_enqueueMsg(npiSyncTxQueue, syncEvent,
-                               NPITASK_TX_READY_EVENT,(unsigned char *) pMsg);
-#else //!ICALL_EVENTS
-            NPITask_events |= NPITASK_TX_READY_EVENT;
-            NPIUtil_enqueueMsg(npiSyncTxQueue, npiSem,(unsigned char *) pMsg);
-#endif //ICALL_EVENTS
+            if (!NPITask_enqueueFrame(&npiSyncTxQueue, &syncTxQueueMax,
+                                      NPITASK_TX_READY_EVENT, pMsg))
+            {
+                status = NPI_BUSY;
+            }
         }
         break;
         case NPI_MSG_TYPE_ASYNC:
         {
-#ifdef ICALL_EVENTS
-            NPIUtil_enqueueMsg(npiTxQueue, syncEvent, NPITASK_TX_READY_EVENT,
-                               (unsigned char *) pMsg);
-#else //!ICALL_EVENTS
-            NPITask_events |= NPITASK_TX_READY_EVENT;
-            NPIUtil_enqueueMsg(npiTxQueue, npiSem,(unsigned char *) pMsg);
-#endif //ICALL_EVENTS
+            pBlock->lane = lane;
+            if (lane == NPITASK_LANE_BULK && !NPITask_hasTxCredit(pMsg->dataLen))
+            {
+                // Over the bulk lane cap, the sender should have waited
+                NPIUtil_atomicAdd(&queueDrops, 1);
+                NPITask_freeFrame(pMsg);
+                status = NPI_BUSY;
+            }
+            else if (!NPITask_enqueueFrame(&npiTxLanes[lane].queue,
+                                           &npiTxLanes[lane].queueMax,
+                                           NPITASK_TX_READY_EVENT, pMsg))
+            {
+                status = NPI_BUSY;
+            }
+            else if (lane == NPITASK_LANE_BULK)
+            {
+                // The NPI Task cannot send the frame before Task_restore
+                NPIUtil_atomicAdd(&txBulkFrames, 1);
+                NPIUtil_atomicAdd(&txBulkBytes, pMsg->dataLen);
+            }
         }
         break;
         default:
@@ -638,7 +1056,7 @@ uint8_t NPITask_sendToHost(_npiFrame_t *pMsg)
         break;
     }
 
-    NPIUtil_ExitCS(key);
+    Task_restore(key);
 
     return status;
 }
@@ -758,26 +1176,61 @@ static uint8_t NPITask_routeICallToSS(ICall_ServiceEnum src, uint8_t *pGenMsg)
 // -----------------------------------------------------------------------------
 //! \brief      API to allocate an NPI frame of a given data length
 //!
+//!             Room for the SOF and header is reserved in front of the payload
+//!             and room for the FCS behind it, so the frame can be handed to
+//!             the Transport Layer as is (see NPI_GET_WIRE_BUF).
+//!
+//!             Frames come from the frame pool while it has blocks left and
+//!             from the heap otherwise. Either way free with NPITask_freeFrame.
+//!
 //! \param[in]  len             Length of data field of frame
 //!
 //! \return     _npiFrame_t *   Pointer to newly allocated frame
 // -----------------------------------------------------------------------------
 _npiFrame_t * NPITask_mallocFrame(uint16_t len)
 {
-    _npiFrame_t *pMsg;
+    _npiFrameBlock_t *pBlock = NULL;
+    _npiFrame_t *pMsg = NULL;
+    UInt key;
+
+    // Take a block from the pool if the frame fits in one. The TL callbacks
+    // allocate too, but only interrupts need masking for the unlink
+    key = Hwi_disable();
+    if (sizeof(_npiFrameBlock_t) + NPI_FRAME_HEADROOM + len +
+        NPI_FRAME_TAILROOM <= framePoolBlockSize &&
+        !Queue_empty(Queue_handle(&framePoolFree)))
+    {
+        pBlock = Queue_dequeue(Queue_handle(&framePoolFree));
+        if (++framePoolInUse > framePoolInUseMax)
+        {
+            framePoolInUseMax = framePoolInUse;
+        }
+    }
+    else
+    {
+        framePoolMisses++;
+    }
+    Hwi_restore(key);
 
-    // Allocate memory for NPI Frame
-    pMsg = (_npiFrame_t *)NPIUTIL_MALLOC(sizeof(_npiFrame_t) + len);
+    if (pBlock == NULL)
+    {
+        // Allocate memory for NPI Frame
+        pBlock = (_npiFrameBlock_t *)NPIUTIL_MALLOC(sizeof(_npiFrameBlock_t) +
+                                                    NPI_FRAME_HEADROOM + len +
+                                                    NPI_FRAME_TAILROOM);
+    }
 
-    if (pMsg != NULL)
+    if (pBlock != NULL)
     {
+        pMsg = &pBlock->frame;
+
         // Assign Data Length of Frame
         pMsg->dataLen = len;
 
         // Assign pData to first byte of payload
-        // Pointer arithmetic of + 1 is equal to sizeof(_npiFrame_t) bytes
-        // then cast to unsigned char * for pData
-        pMsg->pData = (unsigned char *)(pMsg + 1);
+        // Pointer arithmetic of + 1 is equal to sizeof(_npiFrameBlock_t)
+        // bytes then cast to unsigned char * for pData
+        pMsg->pData = (unsigned char *)(pBlock + 1) + NPI_FRAME_HEADROOM;
     }
     return pMsg;
 }
@@ -791,82 +1244,483 @@ _npiFrame_t * NPITask_mallocFrame(uint16_t len)
 // -----------------------------------------------------------------------------
 void NPITask_freeFrame(_npiFrame_t *frame)
 {
-    NPIUTIL_FREE(frame);
+    uint8_t *pBlock = (uint8_t *)NPITASK_FRAME_BLOCK(frame);
+    UInt key;
+
+    if (framePool != NULL && pBlock >= framePool &&
+        pBlock < &framePool[framePoolSize * framePoolBlockSize])
+    {
+        key = Hwi_disable();
+        framePoolInUse--;
+        Queue_enqueue(Queue_handle(&framePoolFree), (Queue_Elem *)pBlock);
+        Hwi_restore(key);
+    }
+    else
+    {
+        NPIUTIL_FREE(pBlock);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Puts an NPI frame in an NPI Task queue and wakes the NPI Task.
+//!             Only one context may fill a given queue at a time. A frame
+//!             that does not fit is freed and counted in queueDrops. With
+//!             flow control the remote is held off while a queue is full,
+//!             see NPITask_rxRoom, so this is left to ASYNC frames received
+//!             while a SYNC RSP is awaited and to frames beyond the first
+//!             in one handshake.
+//!
+//! \param[in]  msgQueue    queue to put the frame in
+//! \param[in]  pQueueMax   high-water mark of msgQueue
+//! \param[in]  event       event to post to the NPI Task
+//! \param[in]  pMsg        frame to be queued
+//!
+//! \return     bool        true if the frame was queued
+// -----------------------------------------------------------------------------
+static bool NPITask_enqueueFrame(_npiRing_t *msgQueue, uint16_t *pQueueMax,
+                                 uint32_t event, _npiFrame_t *pMsg)
+{
+    uint16_t count = NPIUtil_ringPut(msgQueue, pMsg);
+
+    if (count == 0)
+    {
+        NPIUtil_atomicAdd(&queueDrops, 1);
+        NPITask_freeFrame(pMsg);
+        return false;
+    }
+
+    if (count > *pQueueMax)
+    {
+        *pQueueMax = count;
+    }
+
+    NPITask_postEvent(event);
+
+    return true;
 }
 
 // -----------------------------------------------------------------------------
-// Serialize and Deserialize functions
+//! \brief      Wakes the NPI Task for an event. Safe from any task or ISR.
+//!
+//! \param[in]  event   event to post
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITask_postEvent(uint32_t event)
+{
+#ifdef ICALL_EVENTS
+    Event_post(syncEvent, event);
+#else //!ICALL_EVENTS
+    NPIUtil_atomicOr(&npiPostedEvents, event);
+    Semaphore_post(npiSem);
+#endif //ICALL_EVENTS
+}
 
 // -----------------------------------------------------------------------------
-//! \brief      Function creates a byte array from an NPI Frame struct
+//! \brief      Picks the ASYNC TX lane to send from next, the first lane in
+//!             npiTxLaneOrder with a frame waiting.
 //!
-//!             *** Whoever calls this function is responsible for freeing the
-//!             the created byte array
+//!             While the remote is owed a SYNC RSP, or one of its SYNC frames
+//!             waits to be processed, ASYNC frames stay queued. While a SYNC
+//!             REQ of ours waits for its response, the remote holds on to
+//!             ASYNC frames until it has answered, so only
+//!             NPITASK_SYNC_INTERLEAVE of them are sent meanwhile.
 //!
-//! \param[in]  pNPIMsg     Pointer to message that will be serialized
+//! \param[in]  events      NPI Task pending events
 //!
-//! \return     uint8_t*    Equivalent byte array of the NPI Frame
+//! \return     _npiRing_t* lane queue to send from, NULL if none
 // -----------------------------------------------------------------------------
-static uint8_t * NPITask_SerializeFrame(_npiFrame_t *pNPIMsg)
+static _npiRing_t * NPITask_nextTxLane(uint32_t events)
 {
-    uint8_t *pSerMsg;
+    uint8_t i;
 
-    // Allocate byte array for the entire message
-    pSerMsg = (uint8_t *)NPIUTIL_MALLOC(pNPIMsg->dataLen + NPI_MSG_HDR_LENGTH);
+    if ((events & NPITASK_SYNC_FRAME_RX_EVENT) ||
+        syncTransactionInProgress > 0 ||
+        (syncTransactionInProgress < 0 &&
+         syncInterleaveCount >= NPITASK_SYNC_INTERLEAVE))
+    {
+        return NULL;
+    }
 
-    if (pSerMsg != NULL)
+    for (i = 0; i < NPITASK_LANES; i++)
     {
-        // Packet Format [ Len1 ][ Len0 ][ Cmd0 ][ Cmd 1 ][ Data Payload ]
-        // Fill in Header
-        pSerMsg[0] = (uint8)(pNPIMsg->dataLen & 0xFF);
-        pSerMsg[1] = (uint8)(pNPIMsg->dataLen >> 8);
-        pSerMsg[2] = pNPIMsg->cmd0;
-        pSerMsg[3] = pNPIMsg->cmd1;
-
-        // Copy Data Payload
-        memcpy(&pSerMsg[4],pNPIMsg->pData,pNPIMsg->dataLen);
+        _npiRing_t *txQ = &npiTxLanes[npiTxLaneOrder[i]].queue;
+
+        if (NPIUtil_ringCount(txQ))
+        {
+            if (syncTransactionInProgress < 0)
+            {
+                syncInterleaveCount++;
+                syncInterleaved++;
+            }
+            return txQ;
+        }
     }
 
-    return pSerMsg;
+    return NULL;
 }
 
+// -----------------------------------------------------------------------------
+//! \brief      Checks for frames waiting in the SYNC TX queue or any ASYNC TX
+//!             lane. Safe from any task or ISR.
+//!
+//! \return     bool    true if a frame is waiting to be sent
+// -----------------------------------------------------------------------------
+static bool NPITask_txPending(void)
+{
+    uint8_t i;
+
+    if (NPIUtil_ringCount(&npiSyncTxQueue))
+    {
+        return true;
+    }
+
+    for (i = 0; i < NPITASK_LANES; i++)
+    {
+        if (NPIUtil_ringCount(&npiTxLanes[i].queue))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#if (NPI_FLOW_CTRL == 1)
+// -----------------------------------------------------------------------------
+//! \brief      Checks the RX queues can take the next frame from the remote,
+//!             whichever type it turns out to be. While a SYNC RSP is awaited
+//!             the ASYNC RX queue is not drained, so it is not waited on
+//!             either: holding off the remote then would hold off the SYNC
+//!             RSP too. An ASYNC frame that finds it full is dropped.
+//!
+//! \return     bool    true if the remote may send
+// -----------------------------------------------------------------------------
+static bool NPITask_rxRoom(void)
+{
+    if (NPIUtil_ringCount(&npiSyncRxQueue) == NPITASK_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    return (syncTransactionInProgress < 0 ||
+            NPIUtil_ringCount(&npiRxQueue) < NPITASK_QUEUE_SIZE);
+}
+#endif // NPI_FLOW_CTRL = 1
 
 // -----------------------------------------------------------------------------
-//! \brief      Function creates an NPI Frame struct from RxBuf contents
+//! \brief      Records how long a transmitted ASYNC frame took from
+//!             NPITask_sendToHostLane against its lane. Called by the NPI
+//!             Task only, as the frame is freed.
 //!
-//!             *** Whoever calls this function is responsible for freeing the
-//!             the created NPI Frame struct
+//! \param[in]  pMsg    frame the Transport Layer reported transmitted
 //!
-//! \return     _npiFrame_t*  Equivalent NPI Frame of RxBuf
+//! \return     void
 // -----------------------------------------------------------------------------
-static _npiFrame_t * NPITask_DeserializeFrame(void)
+static void NPITask_recordTxDone(_npiFrame_t *pMsg)
 {
-    _npiFrame_t *pMsg;
-    uint16_t datalen;
-    uint8_t ch;
+    _npiFrameBlock_t *pBlock = NPITASK_FRAME_BLOCK(pMsg);
+    _npiTxLane_t *pLane;
+    uint32_t ticks;
+    uint8_t bin = 0;
+    _npiCSKey_t key;
 
-    // Function assumes the following packet structure is in RxBuf:
-    // [ Len1 ][ Len0 ][ Cmd0 ][ Cmd 1 ][ Data Payload ]
-    // It also assumes that npiRxBufHead points to the Len1 byte
-    NPITL_readTL(&ch, 1);
-    datalen = ch;
-    NPITL_readTL(&ch, 1);
-    datalen += (ch << 8);
+    if (pBlock->lane >= NPITASK_LANES)
+    {
+        return;
+    }
 
-    // Allocate memory for NPI Frame
-    pMsg = NPITask_mallocFrame(datalen);
+    pLane = &npiTxLanes[pBlock->lane];
+    ticks = Timestamp_get32() - pBlock->stamp;
+    while (bin < NPITASK_LAT_BINS - 1 && (ticks >> bin))
+    {
+        bin++;
+    }
 
-    if (pMsg != NULL)
+    // NPITask_getStats may read the lane from another task
+    key = NPIUtil_EnterCS();
+    if (ticks > pLane->maxTicks)
     {
-        // Assign CMD0 and CMD1 bytes
-        NPITL_readTL(&(pMsg->cmd0), 1);
-        NPITL_readTL(&(pMsg->cmd1), 1);
+        pLane->maxTicks = ticks;
+    }
+    pLane->totalTicks += ticks;
+    pLane->frames++;
+    pLane->bins[bin]++;
+    NPIUtil_ExitCS(key);
+}
 
-        // Copy Data payload
-        NPITL_readTL(pMsg->pData, pMsg->dataLen);
+// -----------------------------------------------------------------------------
+//! \brief      Gives back the bulk lane credit a frame holds and wakes a task
+//!             waiting for credit. Called by the NPI Task only, as the frame
+//!             is freed.
+//!
+//! \param[in]  pMsg    frame leaving the TX path
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITask_releaseTxCredit(_npiFrame_t *pMsg)
+{
+    if (NPITASK_FRAME_BLOCK(pMsg)->lane == NPITASK_LANE_BULK)
+    {
+        NPIUtil_atomicAdd(&txBulkFrames, (uint32_t) -1);
+        NPIUtil_atomicAdd(&txBulkBytes, (uint32_t) -pMsg->dataLen);
+        Semaphore_post(txCreditSem);
     }
+}
 
-    return pMsg;
+// -----------------------------------------------------------------------------
+//! \brief      Checks the bulk lane takes a frame of len payload bytes. A
+//!             frame larger than the byte cap fits an empty lane, so it is
+//!             not refused forever.
+//!
+//! \param[in]  len     Payload bytes of the frame
+//!
+//! \return     bool    true if the frame fits
+// -----------------------------------------------------------------------------
+static bool NPITask_hasTxCredit(uint16_t len)
+{
+    uint32_t frames = txBulkFrames;
+    uint32_t bytes = txBulkBytes;
+
+    return frames < txBulkMaxFrames &&
+           (frames == 0 || bytes + len <= txBulkMaxBytes);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      API to read how much more the bulk lane takes before
+//!             NPITask_sendToHostLane refuses frames with NPI_BUSY. Frames
+//!             hold their credit until the Transport Layer has sent them.
+//!
+//! \param[out] pFrames Frames the bulk lane takes, may be NULL
+//! \param[out] pBytes  Payload bytes the bulk lane takes, may be NULL
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITask_getTxCredit(uint16_t *pFrames, uint16_t *pBytes)
+{
+    uint32_t frames = txBulkFrames;
+    uint32_t bytes = txBulkBytes;
+
+    if (pFrames)
+    {
+        *pFrames = frames < txBulkMaxFrames ? txBulkMaxFrames - frames : 0;
+    }
+    if (pBytes)
+    {
+        *pBytes = bytes < txBulkMaxBytes ? txBulkMaxBytes - bytes : 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      API to wait until the bulk lane takes a frame of len payload
+//!             bytes. Another task may use the credit up before this task
+//!             sends, so NPITask_sendToHostLane can still refuse the frame.
+//!             Never waits when called from the NPI Task.
+//!
+//! \param[in]  len     Payload bytes of the frame to be sent
+//! \param[in]  timeout Clock ticks to wait, BIOS_NO_WAIT or BIOS_WAIT_FOREVER
+//!
+//! \return     bool    true if the frame fits, false on timeout
+// -----------------------------------------------------------------------------
+bool NPITask_waitTxCredit(uint16_t len, uint32_t timeout)
+{
+    uint32_t start = Clock_getTicks();
+    bool waited = false;
+
+    // Only the NPI Task gives credit back, so it must never wait for it, eg.
+    // from a write callback that sends a notification
+    if (Task_self() == npiTaskHandle)
+    {
+        timeout = BIOS_NO_WAIT;
+    }
+
+    while (!NPITask_hasTxCredit(len))
+    {
+        uint32_t remaining = BIOS_WAIT_FOREVER;
+
+        if (timeout != BIOS_WAIT_FOREVER)
+        {
+            uint32_t elapsed = Clock_getTicks() - start;
+
+            if (elapsed >= timeout)
+            {
+                return false;
+            }
+            remaining = timeout - elapsed;
+        }
+
+        // Woken each time a bulk frame is sent, check again
+        Semaphore_pend(txCreditSem, remaining);
+        waited = true;
+    }
+
+    if (waited)
+    {
+        // One post wakes one waiter, pass it on in case credit is left over
+        Semaphore_post(txCreditSem);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      API to read the transport and RPC statistics. All counters are
+//!             read, and restarted if requested, in one critical section so
+//!             none are lost or counted twice between reads.
+//!
+//! \param[out] stats   Pointer to struct the statistics are copied to
+//! \param[in]  reset   Restart the statistics after reading them
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITask_getStats(NPI_Stats *stats, bool reset)
+{
+    _npiCSKey_t key;
+    uint32_t count, minTicks, maxTicks, routeCount, routeMaxTicks;
+    uint64_t totalTicks, routeTotalTicks;
+    uint32_t laneMaxTicks[NPITASK_LANES];
+    uint64_t laneTotalTicks[NPITASK_LANES];
+    uint8_t laneP99Bin[NPITASK_LANES];
+    uint8_t i, bin;
+
+    key = NPIUtil_EnterCS();
+
+    NPITL_getTxStats(&stats->tx, reset);
+    NPITL_getRxStats(&stats->rx, reset);
+    for (i = 0; i < NPITASK_LANES; i++)
+    {
+        _npiTxLane_t *pLane = &npiTxLanes[i];
+        uint32_t tail = pLane->frames / 100;
+
+        // Walk down from the slowest bin until more than 1% of the frames
+        // have been passed
+        for (bin = NPITASK_LAT_BINS - 1; bin > 0; bin--)
+        {
+            if (pLane->bins[bin] > tail)
+            {
+                break;
+            }
+            tail -= pLane->bins[bin];
+        }
+        laneP99Bin[i] = bin;
+        laneMaxTicks[i] = pLane->maxTicks;
+        laneTotalTicks[i] = pLane->totalTicks;
+        stats->lane[i].queueMax = pLane->queueMax;
+        stats->lane[i].frames = pLane->frames;
+
+        if (reset)
+        {
+            pLane->queueMax = NPIUtil_ringCount(&pLane->queue);
+            pLane->frames = 0;
+            pLane->maxTicks = 0;
+            pLane->totalTicks = 0;
+            memset(pLane->bins, 0, sizeof(pLane->bins));
+        }
+    }
+    stats->syncInterleaved = syncInterleaved;
+    stats->syncTxQueueMax = syncTxQueueMax;
+    stats->rxQueueMax = rxQueueMax;
+    stats->syncRxQueueMax = syncRxQueueMax;
+    stats->queueDrops = queueDrops;
+    stats->syncRpcTimeouts = syncRpcTimeouts;
+    stats->syncStaleRsps = syncStaleRsps;
+    count = syncRpcCount;
+    minTicks = syncRpcMinTicks;
+    maxTicks = syncRpcMaxTicks;
+    totalTicks = syncRpcTotalTicks;
+    routeCount = rxRouteCount;
+    routeMaxTicks = rxRouteMaxTicks;
+    routeTotalTicks = rxRouteTotalTicks;
+    stats->poolSize = framePoolSize;
+    stats->poolInUseMax = framePoolInUseMax;
+    stats->poolMisses = framePoolMisses;
+
+    if (reset)
+    {
+        // Frames still queued count towards the next high-water marks
+        syncInterleaved = 0;
+        syncTxQueueMax = NPIUtil_ringCount(&npiSyncTxQueue);
+        rxQueueMax = NPIUtil_ringCount(&npiRxQueue);
+        syncRxQueueMax = NPIUtil_ringCount(&npiSyncRxQueue);
+        queueDrops = 0;
+        syncRpcCount = 0;
+        syncRpcMinTicks = 0;
+        syncRpcMaxTicks = 0;
+        syncRpcTotalTicks = 0;
+        syncRpcTimeouts = 0;
+        syncStaleRsps = 0;
+        rxRouteCount = 0;
+        rxRouteMaxTicks = 0;
+        rxRouteTotalTicks = 0;
+        framePoolInUseMax = framePoolInUse;
+        framePoolMisses = 0;
+    }
+
+    NPIUtil_ExitCS(key);
+
+    // Convert to microseconds outside the critical section
+    stats->syncRpcCount = count;
+    stats->syncRpcMinUs = (uint64_t) minTicks * 1000000 / stats->tx.tickFreq;
+    stats->syncRpcMaxUs = (uint64_t) maxTicks * 1000000 / stats->tx.tickFreq;
+    stats->syncRpcAvgUs = count ?
+        totalTicks * 1000000 / stats->tx.tickFreq / count : 0;
+    stats->rxRouteCount = routeCount;
+    stats->rxRouteMaxUs = (uint64_t) routeMaxTicks * 1000000 /
+                          stats->tx.tickFreq;
+    stats->rxRouteAvgUs = routeCount ?
+        routeTotalTicks * 1000000 / stats->tx.tickFreq / routeCount : 0;
+    for (i = 0; i < NPITASK_LANES; i++)
+    {
+        // Bin b holds latencies below 2^b ticks
+        uint64_t p99Ticks = ((uint64_t) 1 << laneP99Bin[i]) - 1;
+
+        if (p99Ticks > laneMaxTicks[i])
+        {
+            p99Ticks = laneMaxTicks[i];
+        }
+        stats->lane[i].maxUs = (uint64_t) laneMaxTicks[i] * 1000000 /
+                               stats->tx.tickFreq;
+        stats->lane[i].p99Us = p99Ticks * 1000000 / stats->tx.tickFreq;
+        stats->lane[i].avgUs = stats->lane[i].frames ?
+            laneTotalTicks[i] * 1000000 / stats->tx.tickFreq /
+            stats->lane[i].frames : 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Serialize functions
+
+// -----------------------------------------------------------------------------
+//! \brief      Function frames an NPI Frame in place: SOF and header go in
+//!             the headroom reserved by NPITask_mallocFrame, the FCS in its
+//!             tailroom. The payload is not copied.
+//!
+//!             The FCS is folded in here, in task context, so the Transport
+//!             Layer hands the frame to the driver as is.
+//!
+//! \param[in]  pNPIMsg     Pointer to message that will be serialized
+//!
+//! \return     uint8_t*    Pointer to the SOF slot of the frame's buffer
+// -----------------------------------------------------------------------------
+static uint8_t * NPITask_SerializeFrame(_npiFrame_t *pNPIMsg)
+{
+    uint8_t *pSerMsg = NPI_GET_WIRE_BUF(pNPIMsg);
+
+    // Packet Format
+    // [ SOF ][ Len0 ][ Len1 ][ Cmd0 ][ Cmd 1 ][ Data Payload ][ FCS ]
+    // Fill in Header
+    pSerMsg[0] = NPI_MSG_SOF_VAL;
+    pSerMsg[1] = (uint8)(pNPIMsg->dataLen & 0xFF);
+    pSerMsg[2] = (uint8)(pNPIMsg->dataLen >> 8);
+    pSerMsg[3] = pNPIMsg->cmd0;
+    pSerMsg[4] = pNPIMsg->cmd1;
+
+    // FCS of the header as it is written, then of the payload
+    pNPIMsg->pData[pNPIMsg->dataLen] =
+        NPIUtil_calcFCS(pSerMsg[1] ^ pSerMsg[2] ^ pSerMsg[3] ^ pSerMsg[4],
+                        pNPIMsg->pData, pNPIMsg->dataLen);
+
+    return pSerMsg;
 }
 
 // -----------------------------------------------------------------------------
@@ -880,67 +1734,96 @@ static _npiFrame_t * NPITask_DeserializeFrame(void)
 //!
 //! \return     void
 // -----------------------------------------------------------------------------
-static void NPITask_ProcessTXQ(Queue_Handle txQ)
+static void NPITask_ProcessTXQ(_npiRing_t *txQ)
 {
-    _npiFrame_t *pMsg = NULL;
-    _npiCSKey_t key;
+    _npiFrame_t *pMsg;
 
-    // Must block task pre-emption so that the higher priority tasks
-    // are not also manipulated txQ at the same time
-    key = NPIUtil_EnterCS();
-    pMsg = (_npiFrame_t *) NPIUtil_dequeueMsg(txQ);
-    NPIUtil_ExitCS(key);
+    // The NPI Task is the only consumer, no critical section needed
+    pMsg = NPIUtil_ringGet(txQ);
 
     if (pMsg != NULL)
     {
-        // Serialize NPI Frame to be sent over Transport Layer
-        lastQueuedTxMsg = NPITask_SerializeFrame(pMsg);
+        uint8_t sent;
+
+        // Write frame over Transport Layer straight from its own buffer.
+        // We have already checked the TL has room so we assume write succeeds
+        sent = (NPITL_writeTL(NPITask_SerializeFrame(pMsg),
+                              pMsg->dataLen + NPI_MSG_HDR_LENGTH) ==
+                NPI_SUCCESS);
+
+        if (sent)
+        {
+            // Frame is freed once the TL reports it has been transmitted
+            txInFlight[(txInFlightHead + txInFlightCount) %
+                       NPITL_TX_RING_SIZE] = pMsg;
+            txInFlightCount++;
+        }
 
-        if (lastQueuedTxMsg != NULL)
+        // If the message is a synchronous response or request
+        if (NPI_GET_MSG_TYPE(pMsg) == NPI_MSG_TYPE_SYNCREQ ||
+            NPI_GET_MSG_TYPE(pMsg) == NPI_MSG_TYPE_SYNCRSP)
         {
-            // Write byte array over Transport Layer
-            // We have already checked if TL is busy so we assume write succeeds
-            NPITL_writeTL(lastQueuedTxMsg, pMsg->dataLen + NPI_MSG_HDR_LENGTH);
+            // Decrement the outstanding Sync REQ/RSP flag.
+            syncTransactionInProgress--;
+            syncInterleaveCount = 0;
 
-            // If the message is a synchronous response or request
-            if (NPI_GET_MSG_TYPE(pMsg) == NPI_MSG_TYPE_SYNCREQ ||
-                NPI_GET_MSG_TYPE(pMsg) == NPI_MSG_TYPE_SYNCRSP)
+            // Time the answer from when the request goes out, a batch of
+            // them is queued at once
+            if (NPI_GET_MSG_TYPE(pMsg) == NPI_MSG_TYPE_SYNCREQ)
             {
-                // Decrement the outstanding Sync REQ/RSP flag.
-                syncTransactionInProgress--;
+                syncReqPending = true;
+                syncReqStamp = Timestamp_get32();
             }
         }
 
-        //Free NPI frame
-        NPITask_freeFrame(pMsg);
+        if (!sent)
+        {
+            //Free NPI frame, it was not accepted by the Transport Layer
+            NPITask_releaseTxCredit(pMsg);
+            NPITask_freeFrame(pMsg);
+        }
     }
 }
 
 // -----------------------------------------------------------------------------
 //! \brief      Dequeue next message in the RX Queue and process it.
 //!
-//! \return     void
+//! \return     bool    true if a message was dequeued
 // -----------------------------------------------------------------------------
-static void NPITask_processRXQ(void)
+static bool NPITask_processRXQ(void)
 {
-    _npiCSKey_t key;
-    _npiFrame_t *pMsg = NULL;
+    _npiFrame_t *pMsg;
 
-    // Must lock interrupts because RX Queues are accessed from
-    // both NPI Task context and ISR
-    key = NPIUtil_EnterCS();
-    pMsg = (_npiFrame_t *) NPIUtil_dequeueMsg(npiRxQueue);
-    NPIUtil_ExitCS(key);
+    // The Transport Layer callback only fills the RX Queues and the NPI Task
+    // only drains them, so interrupts need not be locked
+    pMsg = NPIUtil_ringGet(&npiRxQueue);
 
     if (pMsg != NULL)
     {
+        // The subsystem frees the frame, take its stamp first
+        uint32_t stamp = NPITASK_FRAME_BLOCK(pMsg)->stamp;
+        uint32_t ticks;
+        _npiCSKey_t key;
+
         // Route to SS based on ID in message
         if (NPITask_routeHostToSS(pMsg) != NPI_SUCCESS)
         {
             // No subsystem registered to handle message. Free NPI Frame
             NPITask_freeFrame(pMsg);
         }
+
+        ticks = Timestamp_get32() - stamp;
+        key = NPIUtil_EnterCS();
+        if (ticks > rxRouteMaxTicks)
+        {
+            rxRouteMaxTicks = ticks;
+        }
+        rxRouteTotalTicks += ticks;
+        rxRouteCount++;
+        NPIUtil_ExitCS(key);
     }
+
+    return (pMsg != NULL);
 }
 
 // -----------------------------------------------------------------------------
@@ -950,7 +1833,6 @@ static void NPITask_processRXQ(void)
 // -----------------------------------------------------------------------------
 static void NPITask_processSyncRXQ(void)
 {
-    _npiCSKey_t key;
     _npiFrame_t *pMsg = NULL;
 
     // Sync transaction of 0 means no synchronous transaction is in progress
@@ -958,16 +1840,28 @@ static void NPITask_processSyncRXQ(void)
     // are waiting on the reply
     if (syncTransactionInProgress <= 0)
     {
-        // Must lock interrupts because RX Queues are accessed from
-        // both NPI Task context and ISR
-        key = NPIUtil_EnterCS();
-        pMsg = (_npiFrame_t *) NPIUtil_dequeueMsg(npiSyncRxQueue);
-        NPIUtil_ExitCS(key);
+        // See NPITask_processRXQ
+        pMsg = NPIUtil_ringGet(&npiSyncRxQueue);
 
-        if (pMsg != NULL)
+        if (pMsg != NULL && NPI_GET_MSG_TYPE(pMsg) == NPI_MSG_TYPE_SYNCRSP &&
+            (syncRspsOwed || syncTransactionInProgress == 0))
         {
+            // Answers a SYNC REQ that was cancelled, not the one waiting
+            if (syncRspsOwed)
+            {
+                syncRspsOwed--;
+            }
+            syncStaleRsps++;
+            NPITask_freeFrame(pMsg);
+        }
+        else if (pMsg != NULL)
+        {
+            bool isRsp = (NPI_GET_MSG_TYPE(pMsg) == NPI_MSG_TYPE_SYNCRSP);
+            uint32_t ticks = Timestamp_get32() - syncReqStamp;
+
             // Increment the outstanding Sync REQ/RSP flag.
             syncTransactionInProgress++;
+            syncRspRejected = false;
 
             // Route to SS based on ID in message
             if (NPITask_routeHostToSS(pMsg) != NPI_SUCCESS)
@@ -975,10 +1869,89 @@ static void NPITask_processSyncRXQ(void)
                 // No subsystem registered to handle message. Free NPI Frame
                 NPITask_freeFrame(pMsg);
             }
+
+            if (syncRspRejected)
+            {
+                // Not the answer, keep waiting for it
+                syncTransactionInProgress--;
+                syncStaleRsps++;
+            }
+            else if (isRsp && syncReqPending)
+            {
+                if (syncRpcCount == 0 || ticks < syncRpcMinTicks)
+                {
+                    syncRpcMinTicks = ticks;
+                }
+                if (ticks > syncRpcMaxTicks)
+                {
+                    syncRpcMaxTicks = ticks;
+                }
+                syncRpcTotalTicks += ticks;
+                syncRpcCount++;
+                syncReqPending = false;
+            }
         }
     }
 }
 
+
+// -----------------------------------------------------------------------------
+//! \brief      Stops waiting for the response to a cancelled SYNC REQ. The
+//!             ASYNC frames held back for it are released, and its response,
+//!             should it still arrive, is dropped by NPITask_processSyncRXQ.
+//!             SYNC REQs queued behind it are freed unsent, SYNC RSPs owed to
+//!             the remote stay queued.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITask_processSyncCancel(void)
+{
+    _npiFrame_t *pMsg;
+    uint16_t count;
+    UInt key;
+
+    // SYNC REQs still queued are the rest of the sender's batch, sending
+    // them would only bring answers nobody waits for. Each frame taken out
+    // is put back unless freed, with producers held off so the SYNC RSPs
+    // keep their order
+    key = Task_disable();
+    for (count = NPIUtil_ringCount(&npiSyncTxQueue); count; count--)
+    {
+        pMsg = NPIUtil_ringGet(&npiSyncTxQueue);
+        if (NPI_GET_MSG_TYPE(pMsg) == NPI_MSG_TYPE_SYNCREQ)
+        {
+            NPITask_freeFrame(pMsg);
+        }
+        else
+        {
+            NPIUtil_ringPut(&npiSyncTxQueue, pMsg);
+        }
+    }
+    Task_restore(key);
+
+    if (syncTransactionInProgress < 0)
+    {
+        // The SYNC REQ went out, its response may still come
+        syncTransactionInProgress = 0;
+        syncInterleaveCount = 0;
+        syncRspsOwed++;
+    }
+    syncReqPending = false;
+    syncRpcTimeouts++;
+
+    if (NPITask_txPending())
+    {
+        NPITask_postEvent(NPITASK_TX_READY_EVENT);
+    }
+    if (NPIUtil_ringCount(&npiRxQueue))
+    {
+        NPITask_postEvent(NPITASK_FRAME_RX_EVENT);
+    }
+    if (NPIUtil_ringCount(&npiSyncRxQueue))
+    {
+        NPITask_postEvent(NPITASK_SYNC_FRAME_RX_EVENT);
+    }
+}
 // -----------------------------------------------------------------------------
 // Call Back Functions
 
@@ -990,46 +1963,34 @@ static void NPITask_processSyncRXQ(void)
 //!
 //! \return     void
 // -----------------------------------------------------------------------------
-volatile uint8_t txcomplete = 0;
-volatile uint8_t rxcomplete = 0;
 static void NPITask_transportDoneCallBack(uint16_t sizeRx, uint16_t sizeTx)
 {
     _npiFrame_t *pMsg = NULL;
 
     if (sizeRx != 0)
     {
-        rxcomplete++;
-        // De-serialize byte array into NPI frame struct
-        pMsg = NPITask_DeserializeFrame();
+        // Transport Layer has already read the packet into an NPI frame
+        pMsg = NPITL_getRxFrame();
 
         if (pMsg)
         {
+            NPITASK_FRAME_BLOCK(pMsg)->stamp = Timestamp_get32();
+            NPITASK_FRAME_BLOCK(pMsg)->lane = NPITASK_LANE_NONE;
+
             switch (NPI_GET_MSG_TYPE(pMsg))
             {
                 // Enqueue to appropriate NPI Task Q and post corresponding event.
                 case NPI_MSG_TYPE_SYNCREQ:
                 case NPI_MSG_TYPE_SYNCRSP:
                 {
-#ifdef ICALL_EVENTS
-                    NPIUtil_enqueueMsg(npiSyncRxQueue, syncEvent,
-                                       NPITASK_SYNC_FRAME_RX_EVENT,
-                                       (unsigned char *) pMsg);
-#else //!ICALL_EVENTS
-                    tlDoneISRFlag |= NPITASK_SYNC_FRAME_RX_EVENT;
-                    NPIUtil_enqueueMsg(npiSyncRxQueue, npiSem, (unsigned char *) pMsg);
-#endif //ICALL_EVENTS
+                    NPITask_enqueueFrame(&npiSyncRxQueue, &syncRxQueueMax,
+                                         NPITASK_SYNC_FRAME_RX_EVENT, pMsg);
                     break;
                 }
                 case NPI_MSG_TYPE_ASYNC:
                 {
-#ifdef ICALL_EVENTS
-                    NPIUtil_enqueueMsg(npiRxQueue, syncEvent,
-                                       NPITASK_FRAME_RX_EVENT,
-                                       (unsigned char *) pMsg);
-#else //!ICALL_EVENTS
-                    tlDoneISRFlag |= NPITASK_FRAME_RX_EVENT;
-                    NPIUtil_enqueueMsg(npiRxQueue, npiSem, (unsigned char *) pMsg);
-#endif //ICALL_EVENTS
+                    NPITask_enqueueFrame(&npiRxQueue, &rxQueueMax,
+                                         NPITASK_FRAME_RX_EVENT, pMsg);
                     break;
                 }
                 default:
@@ -1042,30 +2003,21 @@ static void NPITask_transportDoneCallBack(uint16_t sizeRx, uint16_t sizeTx)
         }
     }
 
-    if (sizeTx && lastQueuedTxMsg)
+    // The TL only reports sizeTx for a frame handed over by NPITask_ProcessTXQ
+    if (sizeTx)
     {
-      txcomplete++;
-#ifdef ICALL_EVENTS
-      Event_post(syncEvent, NPITASK_TX_DONE_EVENT);
-#else //!ICALL_EVENTS
-      tlDoneISRFlag |= NPITASK_TX_DONE_EVENT;
-      Semaphore_post(npiSem);
-#endif //ICALL_EVENTS
+      NPIUtil_atomicAdd(&txDoneCount, 1);
+      NPITask_postEvent(NPITASK_TX_DONE_EVENT);
     }
 
     // Check to see if there pending messages waiting to be sent
     // If there are then notify NPI Task by setting TX READY event flag
-    if (!Queue_empty(npiSyncTxQueue) || !Queue_empty(npiTxQueue))
+    if (NPITask_txPending())
     {
         // There are pending SYNC RSP or ASYNC messages waiting to
         // be sent to the host. Set the appropriate flag and post to
         // the semaphore.
-#ifdef ICALL_EVENTS
-        Event_post(syncEvent, NPITASK_TX_READY_EVENT);
-#else //!ICALL_EVENTS
-        tlDoneISRFlag |= NPITASK_TX_READY_EVENT;
-        Semaphore_post(npiSem);
-#endif //ICALL_EVENTS
+        NPITask_postEvent(NPITASK_TX_READY_EVENT);
     }
 }
 
@@ -1083,12 +2035,7 @@ static void NPITask_RemRdyEventCB(uint8_t state)
       && npiSem != NULL)
 #endif //ICALL_EVENTS
   {
-#ifdef ICALL_EVENTS
-    Event_post(syncEvent, NPITASK_REM_RDY_EVENT);
-#else //!ICALL_EVENTS
-    remRdyISRFlag = NPITASK_REM_RDY_EVENT;
-    Semaphore_post(npiSem);
-#endif //ICALL_EVENTS
+    NPITask_postEvent(NPITASK_REM_RDY_EVENT);
   }
 #ifdef NPI_MASTER
   else if (state == REM_RDY_DEASSERTED
@@ -1098,16 +2045,13 @@ static void NPITask_RemRdyEventCB(uint8_t state)
       && npiSem != NULL)
 #endif //ICALL_EVENTS
   {
-    // There could be pending TX messages that are waiting for Remote Ready
-    // signal to be deasserted so that NPI is no longer busy
-    if (!Queue_empty(npiSyncTxQueue) || !Queue_empty(npiTxQueue))
+    // There could be pending TX messages, queued or already in the TL Tx
+    // ring, that are waiting for Remote Ready signal to be deasserted so that
+    // NPI is no longer busy
+    if (NPITask_txPending() ||
+        NPITL_getTxSlotsFree() < NPITL_TX_RING_SIZE)
     {
-#ifdef ICALL_EVENTS
-        Event_post(syncEvent, NPITASK_TX_READY_EVENT);
-#else //!ICALL_EVENTS
-        remRdyISRFlag |= NPITASK_TX_READY_EVENT;
-        Semaphore_post(npiSem);
-#endif //ICALL_EVENTS
+        NPITask_postEvent(NPITASK_TX_READY_EVENT);
     }
   }
 #endif //NPI_MASTER
@@ -42,11 +42,45 @@ extern "C"
 // includes
 // ****************************************************************************
 #include "npi_data.h"
+#include "npi_tl.h"
 
 // ****************************************************************************
 // defines
 // ****************************************************************************
 
+//! \brief Frames each NPI Task queue holds. Must be a power of 2. Async frames
+//!        sent while the TX queue is full are dropped with NPI_BUSY.
+#ifndef NPITASK_QUEUE_SIZE
+#define NPITASK_QUEUE_SIZE 16
+#endif
+
+//! \brief Most received async frames the NPI Task routes per wake-up before it
+//!        gives queued TX frames a turn.
+#ifndef NPITASK_RX_BUDGET
+#define NPITASK_RX_BUDGET 8
+#endif
+
+//! \brief ASYNC TX lanes, see NPITask_sendToHostLane. Each lane is a queue of
+//!        its own, so frames keep their order within a lane only.
+#define NPITASK_LANE_CONTROL  0     //!< Commands, the default lane
+#define NPITASK_LANE_CNF      1     //!< Confirmations the remote is waiting on
+#define NPITASK_LANE_BULK     2     //!< Notifications and other streamed data
+#define NPITASK_LANES         3
+
+//! \brief Order the NPI Task drains the ASYNC TX lanes in, highest priority
+//!        first. A lane is only served once the lanes before it are empty.
+#ifndef NPITASK_LANE_ORDER
+#define NPITASK_LANE_ORDER    { NPITASK_LANE_CONTROL, NPITASK_LANE_CNF, \
+                                NPITASK_LANE_BULK }
+#endif
+
+//! \brief Most ASYNC frames sent while a SYNC REQ waits for its response. The
+//!        remote only routes them once it has answered, so this bounds what it
+//!        must hold meanwhile. 0 holds all ASYNC frames back until the answer.
+#ifndef NPITASK_SYNC_INTERLEAVE
+#define NPITASK_SYNC_INTERLEAVE 4
+#endif
+
 // ****************************************************************************
 // typedefs
 // ****************************************************************************
@@ -63,12 +97,63 @@ typedef struct
 {
   uint16_t              stackSize;      //!< Configurable size of stack for NPI Task
   uint16_t              bufSize;        //!< Buffer size of Tx/Rx Transport layer buffers
+  uint8_t               framePoolSize;  //!< Frames of bufSize kept preallocated
+  uint8_t               txBulkFrames;   //!< Most frames queued on the bulk lane
+  uint16_t              txBulkBytes;    //!< Most payload bytes queued on the
+                                        //!< bulk lane
   uint32_t              mrdyPinID;      //!< Pin ID Mrdy (only with Power Saving enabled)
   uint32_t              srdyPinID;      //!< Pin ID Srdy (only with Power Saving enabled)
+  uint8_t               portType;       //!< NPI_SERIAL_TYPE_[UART,SPI,LOOPBACK]
   uint8_t               portBoardID;    //!< Board ID for HW, i.e. CC2650_UART0
   npiInterfaceParams    portParams;     //!< Params to initialize NPI port
 } NPI_Params;
 
+//! \brief Per lane statistics, see NPI_Stats. Latency runs from
+//!        NPITask_sendToHostLane to the Transport Layer reporting the frame
+//!        transmitted.
+typedef struct
+{
+  uint16_t              queueMax;       //!< High-water mark of the lane
+  uint32_t              frames;         //!< Frames transmitted
+  uint32_t              avgUs;          //!< Mean latency, in microseconds
+  uint32_t              p99Us;          //!< 99% of frames were transmitted
+                                        //!< within this, rounded up to a
+                                        //!< power of 2 timestamp ticks
+  uint32_t              maxUs;          //!< Worst latency, in microseconds
+} NPI_LaneStats;
+
+//! \brief Transport and RPC statistics, see NPITask_getStats. Queue maxima
+//!        are the most frames waiting in each queue at once, sync RPC times
+//!        run from NPITask_sendToHost of a request to routing its response.
+typedef struct
+{
+  NPITL_TxStats         tx;             //!< Transport Layer Tx counters
+  NPITL_RxStats         rx;             //!< Transport Layer Rx counters
+  NPI_LaneStats         lane[NPITASK_LANES]; //!< ASYNC TX lanes
+  uint32_t              syncInterleaved;//!< ASYNC frames sent while a SYNC REQ
+                                        //!< waited for its response
+  uint16_t              syncTxQueueMax; //!< High-water mark of SYNC TX Queue
+  uint16_t              rxQueueMax;     //!< High-water mark of ASYNC RX Queue
+  uint16_t              syncRxQueueMax; //!< High-water mark of SYNC RX Queue
+  uint32_t              queueDrops;     //!< Frames dropped on a full queue
+  uint32_t              syncRpcCount;   //!< Sync requests answered
+  uint32_t              syncRpcMinUs;   //!< Fastest answer, in microseconds
+  uint32_t              syncRpcAvgUs;   //!< Mean answer time, in microseconds
+  uint32_t              syncRpcMaxUs;   //!< Slowest answer, in microseconds
+  uint32_t              syncRpcTimeouts;//!< Sync requests given up on
+  uint32_t              syncStaleRsps;  //!< Sync responses dropped because
+                                        //!< their request was given up on
+  uint32_t              rxRouteCount;   //!< ASYNC frames routed
+  uint32_t              rxRouteAvgUs;   //!< Mean time from the Transport Layer
+                                        //!< receiving an ASYNC frame to its
+                                        //!< subsystem callback returning
+  uint32_t              rxRouteMaxUs;   //!< Slowest of those, in microseconds
+  uint8_t               poolSize;       //!< Frames in the frame pool
+  uint8_t               poolInUseMax;   //!< Most pool frames in use at once
+  uint32_t              poolMisses;     //!< Frames taken from the heap because
+                                        //!< the pool was empty
+} NPI_Stats;
+
 //*****************************************************************************
 // globals
 //*****************************************************************************
@@ -86,6 +171,18 @@ typedef struct
 // -----------------------------------------------------------------------------
 extern uint8_t NPITask_Params_init(NPI_Params *params);
 
+// -----------------------------------------------------------------------------
+//! \brief      Set the port type of a NPI_Params struct and initialize its
+//!             port params with the default values for that port
+//!
+//! \param[in]  params    Pointer to NPI params to be updated
+//! \param[in]  portType  NPI_SERIAL_TYPE_[UART,SPI,LOOPBACK]
+//!
+//! \return     uint8_t   Status NPI_SUCCESS, NPI_TASK_INVALID_PARAMS
+// -----------------------------------------------------------------------------
+extern uint8_t NPITask_Params_initPortType(NPI_Params *params,
+                                           uint8_t portType);
+
 // -----------------------------------------------------------------------------
 //! \brief      Task creation function for NPI
 //!
@@ -115,6 +212,72 @@ extern uint8_t NPITask_close(void);
 // -----------------------------------------------------------------------------
 extern uint8_t NPITask_sendToHost(_npiFrame_t *pMsg);
 
+// -----------------------------------------------------------------------------
+//! \brief      API for application task to send an ASYNC message to the Host
+//!             on a given lane. SYNC messages ignore the lane.
+//!
+//! \param[in]  pMsg    Pointer to "unframed" message buffer.
+//! \param[in]  lane    NPITASK_LANE_[CONTROL,CNF,BULK]
+//!
+//! \return     uint8_t Status NPI_SUCCESS, NPI_BUSY or NPI_INVALID_PKT
+// -----------------------------------------------------------------------------
+extern uint8_t NPITask_sendToHostLane(_npiFrame_t *pMsg, uint8_t lane);
+
+// -----------------------------------------------------------------------------
+//! \brief      API for the sender of a SYNC REQ to stop waiting for its
+//!             response, e.g. after a timeout. ASYNC traffic held back for
+//!             the response flows again, and a response arriving late is
+//!             dropped, also while a later SYNC REQ waits for its own.
+//!             SYNC REQs queued behind it are freed unsent, so call it
+//!             before letting another task send any.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITask_cancelSyncReq(void);
+
+// -----------------------------------------------------------------------------
+//! \brief      API for a subsystem, from its RX callback, to turn down the
+//!             SYNC RSP it is handed because it does not answer the SYNC REQ
+//!             waiting. The NPI Task keeps waiting for the answer.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITask_rejectSyncRsp(void);
+
+// -----------------------------------------------------------------------------
+//! \brief      API for a subsystem, from its RX callback, to report that the
+//!             remote has restarted and will not answer SYNC REQs cancelled
+//!             before.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITask_remoteReset(void);
+
+// -----------------------------------------------------------------------------
+//! \brief      API to read how much more the bulk lane takes before
+//!             NPITask_sendToHostLane refuses frames with NPI_BUSY. Frames
+//!             hold their credit until the Transport Layer has sent them.
+//!
+//! \param[out] pFrames Frames the bulk lane takes, may be NULL
+//! \param[out] pBytes  Payload bytes the bulk lane takes, may be NULL
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITask_getTxCredit(uint16_t *pFrames, uint16_t *pBytes);
+
+// -----------------------------------------------------------------------------
+//! \brief      API to wait until the bulk lane takes a frame of len payload
+//!             bytes. Another task may use the credit up before this task
+//!             sends, so NPITask_sendToHostLane can still refuse the frame.
+//!             Never waits when called from the NPI Task.
+//!
+//! \param[in]  len     Payload bytes of the frame to be sent
+//! \param[in]  timeout Clock ticks to wait, BIOS_NO_WAIT or BIOS_WAIT_FOREVER
+//!
+//! \return     bool    true if the frame fits, false on timeout
+// -----------------------------------------------------------------------------
+extern bool NPITask_waitTxCredit(uint16_t len, uint32_t timeout);
+
 // -----------------------------------------------------------------------------
 //! \brief      API for subsystems to register for NPI messages received with
 //!             the specific ssID. All NPI messages will be passed to callback
@@ -143,6 +306,8 @@ extern uint8_t NPITask_regSSFromICallCB(uint8_t icallID, npiFromICallCBack_t pCB
 // -----------------------------------------------------------------------------
 //! \brief      API to allocate an NPI frame of a given data length
 //!
+//!             The frame must be freed with NPITask_freeFrame.
+//!
 //! \param[in]  len             Length of data field of frame
 //!
 //! \return     _npiFrame_t *   Pointer to newly allocated frame
@@ -158,6 +323,18 @@ extern _npiFrame_t * NPITask_mallocFrame(uint16_t len);
 // -----------------------------------------------------------------------------
 extern void NPITask_freeFrame(_npiFrame_t *frame);
 
+// -----------------------------------------------------------------------------
+//! \brief      API to read the transport and RPC statistics. All counters are
+//!             read, and restarted if requested, in one critical section so
+//!             none are lost or counted twice between reads.
+//!
+//! \param[out] stats   Pointer to struct the statistics are copied to
+//! \param[in]  reset   Restart the statistics after reading them
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITask_getStats(NPI_Stats *stats, bool reset);
+
 #ifdef __cplusplus
 }
 #endif // extern "C"
@@ -49,26 +49,43 @@ extern "C"
 // defines
 // ****************************************************************************
 
-#if defined(NPI_USE_UART)
-#define transportOpen NPITLUART_openTransport
-#define transportClose NPITLUART_closeTransport
-#define transportRead NPITLUART_readTransport
-#define transportWrite NPITLUART_writeTransport
-#define transportStopTransfer NPITLUART_stopTransfer
-#define transportRemRdyEvent NPITLUART_handleRemRdyEvent
-#elif defined(NPI_USE_SPI)
-#define transportOpen NPITLSPI_openTransport
-#define transportClose NPITLSPI_closeTransport
-#define transportRead NPITLSPI_readTransport
-#define transportWrite NPITLSPI_writeTransport
-#define transportStopTransfer NPITLSPI_stopTransfer
-#define transportRemRdyEvent NPITLSPI_handleRemRdyEvent
-#endif //NPI_USE_UART
+//! \brief Number of frames NPITL_writeTL accepts before returning NPI_BUSY.
+//!        With more than one, the next frame is ready to go on the wire as
+//!        soon as the current transaction completes, and with flow control
+//!        queued async frames can share one Rem RDY handshake.
+#ifndef NPITL_TX_RING_SIZE
+#define NPITL_TX_RING_SIZE 4
+#endif
 
 // ****************************************************************************
 // typedefs
 // ****************************************************************************
 
+// -----------------------------------------------------------------------------
+//! \brief      Typedef for call back function mechanism to notify NPI TL that
+//!             an NPI transaction has occurred
+//! \param[in]  rxLen     number of bytes received
+//! \param[in]  txLen     number of bytes transmitted
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+typedef void (*npiCB_t)(uint16_t rxLen, uint16_t txLen);
+
+//! \brief      Serial port specific TL. The NPI TL calls through the one
+//!             selected by NPITL_Params.portType. A transport that does not
+//!             use the Rem RDY/Loc RDY handshake leaves stopTransfer and
+//!             remRdyEvent NULL.
+typedef struct
+{
+  void     (*open)(uint8_t portID, npiInterfaceParams *portParams,
+                   npiCB_t npiCBack);          //!< Open port, set TL call back
+  void     (*close)(void);                     //!< Close port
+  void     (*read)(void);                      //!< Start reading a frame
+  uint16_t (*write)(uint16_t len);             //!< Start writing npiTxBuf
+  void     (*stopTransfer)(void);              //!< Rem RDY de-asserted
+  void     (*remRdyEvent)(void);               //!< Rem RDY asserted, task ctx
+} npiTLTransport_t;
+
 //! \brief      Typedef for call back function mechanism to notify NPI Task that
 //!             an NPI transaction has occurred
 typedef void (*npiRtosCB_t)(uint16_t sizeRx, uint16_t sizeTx);
@@ -77,11 +94,21 @@ typedef void (*npiRtosCB_t)(uint16_t sizeRx, uint16_t sizeTx);
 //!             an Remote Ready edge has occurred
 typedef void (*npiMrdyRtosCB_t)(uint8_t state);
 
+//! \brief      Typedef for call back function mechanism to allocate the NPI
+//!             frame a received payload is read into
+typedef _npiFrame_t * (*npiFrameAllocCB_t)(uint16_t len);
+
+//! \brief      Typedef for call back function mechanism to release an NPI
+//!             frame that was allocated but not handed to the NPI Task
+typedef void (*npiFrameFreeCB_t)(_npiFrame_t *frame);
+
 //! \brief      Struct for transport layer call backs
 typedef struct
 {
-  npiMrdyRtosCB_t remRdyCB;
-  npiRtosCB_t     transCompleteCB;
+  npiMrdyRtosCB_t   remRdyCB;
+  npiRtosCB_t       transCompleteCB;
+  npiFrameAllocCB_t frameAllocCB;
+  npiFrameFreeCB_t  frameFreeCB;
 } npiTLCallBacks;
 
 typedef struct
@@ -89,12 +116,39 @@ typedef struct
   uint16_t              npiTLBufSize;   //!< Buffer size of Tx/Rx Transport layer buffers
   uint32_t              mrdyPinID;      //!< Pin ID Mrdy (only with Power Saving enabled)
   uint32_t              srdyPinID;      //!< Pin ID Srdy (only with Power Saving enabled)
-  uint8_t               portType;       //!< NPI_SERIAL_TYPE_[UART,SPI]
+  uint8_t               portType;       //!< NPI_SERIAL_TYPE_[UART,SPI,LOOPBACK]
   uint8_t               portBoardID;    //!< Board ID for HW, i.e. CC2650_UART0
   npiInterfaceParams    portParams;     //!< Params to initialize NPI port
   npiTLCallBacks        npiCallBacks;   //!< Call backs to NPI Task
 } NPITL_Params;
 
+//! \brief      Link utilisation counters. txBusyTicks / elapsedTicks is the
+//!             fraction of time the link spent on Tx transactions.
+typedef struct
+{
+  uint32_t              txFrames;       //!< Frames transmitted
+  uint32_t              txBytes;        //!< Bytes transmitted, with framing
+  uint32_t              txBusyTicks;    //!< Ticks from frame start to TX done
+  uint32_t              txCoalesced;    //!< Frames sent in an earlier frame's
+                                        //!< Rem RDY handshake
+  uint32_t              elapsedTicks;   //!< Ticks since the counters started
+  uint32_t              tickFreq;       //!< Ticks per second
+} NPITL_TxStats;
+
+//! \brief      Receive counters. Bytes skipped while hunting for a SOF and
+//!             packets dropped for a bad FCS or lack of a frame to hold them
+//!             are counted as dropped, since the counters were last reset.
+typedef struct
+{
+  uint32_t              rxFrames;       //!< Frames delivered to the NPI Task
+  uint32_t              rxBytes;        //!< Bytes delivered, with framing
+  uint32_t              rxDropBytes;    //!< Bytes received but not delivered
+  uint32_t              rxDropFrames;   //!< Packets received but not delivered
+  uint32_t              rxFcsErrors;    //!< Packets dropped for a bad FCS
+  uint32_t              rxOversized;    //!< Headers with a length no buffer
+                                        //!< can hold, skipped as noise
+} NPITL_RxStats;
+
 //*****************************************************************************
 // globals
 //*****************************************************************************
@@ -105,14 +159,16 @@ typedef struct
 
 // -----------------------------------------------------------------------------
 //! \brief      This routine initializes the transport layer and opens the port
-//!             of the device. Note that based on project defines, either the
-//!             UART, or SPI driver can be used.
+//!             of the device. The serial port specific TL is selected by
+//!             params->portType among those built in: UART and/or SPI based
+//!             on project defines, and the in-process loopback.
 //!
 //! \param[in]  params - Transport Layer parameters
 //!
-//! \return     void
+//! \return     uint8_t - NPI_SUCCESS, or NPI_TASK_INVALID_PARAMS if portType
+//!                       is not supported by this build
 // -----------------------------------------------------------------------------
-void NPITL_openTL(NPITL_Params *params);
+uint8_t NPITL_openTL(NPITL_Params *params);
 
 // -----------------------------------------------------------------------------
 //! \brief      This routine closes the transport layer
@@ -132,16 +188,95 @@ void NPITL_closeTL(void);
 // -----------------------------------------------------------------------------
 uint16_t NPITL_readTL(uint8_t *buf, uint16_t len);
 
+// -----------------------------------------------------------------------------
+//! \brief      This routine returns the NPI frame received in the last
+//!             transaction. The payload has been read straight into the frame
+//!             and its FCS checked. Ownership passes to the caller.
+//!
+//! \return     _npiFrame_t* - received frame, NULL if there is none
+// -----------------------------------------------------------------------------
+_npiFrame_t * NPITL_getRxFrame(void);
+
 // -----------------------------------------------------------------------------
 //! \brief      This routine writes data from the buffer to the transport layer.
+//!             The buffer is transmitted in place and must already hold the
+//!             SOF in buf[0] and the FCS in buf[len + 1]. Up to NPITL_TX_RING_SIZE
+//!             buffers are accepted and sent back to back in order; each must
+//!             stay valid until the transaction complete call back reports
+//!             sizeTx for it.
 //!
 //! \param[in]  buf - Pointer to buffer to write data from.
-//! \param[in]  len - Number of bytes to write.
+//! \param[in]  len - Number of bytes to write, excluding SOF and FCS.
 //!
 //! \return     uint16_t - NPI Error Code value
 // -----------------------------------------------------------------------------
 uint8_t NPITL_writeTL(uint8_t *buf, uint16_t len);
 
+// -----------------------------------------------------------------------------
+//! \brief      This routine starts the next frame buffered by NPITL_writeTL if
+//!             the link has become idle, e.g. after Rem RDY was de-asserted.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITL_resumeTL(void);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine returns the number of frames NPITL_writeTL can
+//!             still accept without returning NPI_BUSY.
+//!
+//! \return     uint8_t - number of free Tx ring slots
+// -----------------------------------------------------------------------------
+uint8_t NPITL_getTxSlotsFree(void);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine reads the link utilisation counters.
+//!
+//! \param[out] stats - Pointer to struct the counters are copied to.
+//! \param[in]  reset - Restart the counters after reading them.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITL_getTxStats(NPITL_TxStats *stats, bool reset);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine reads the receive counters.
+//!
+//! \param[out] stats - Pointer to struct the counters are copied to.
+//! \param[in]  reset - Restart the counters after reading them.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITL_getRxStats(NPITL_RxStats *stats, bool reset);
+
+#if (NPI_FLOW_CTRL == 1)
+// -----------------------------------------------------------------------------
+//! \brief      This routine is called by the Serial Port Specific TL when a
+//!             frame has been written while the handshake is still held. It
+//!             returns the next buffered frame if that can be written in the
+//!             same handshake. Nothing changes until NPITL_coalesceTx.
+//!
+//! \param[out] pBuf - Set to the next frame, SOF to FCS
+//!
+//! \return     uint16_t - length of the next frame excluding SOF and FCS, 0 if
+//!                        the transaction should end
+// -----------------------------------------------------------------------------
+uint16_t NPITL_peekCoalesceTx(uint8_t **pBuf);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine is called by the Serial Port Specific TL once the
+//!             driver has accepted the frame NPITL_peekCoalesceTx returned.
+//!             It retires the completed frame and makes the next one the
+//!             current npiTxBuf. A frame received in the same transaction is
+//!             delivered along with it.
+//!
+//! \param[in]  Rxlen - Number of bytes received, 0 if none
+//! \param[in]  Txlen - Number of bytes written for the completed frame
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITL_coalesceTx(uint16_t Rxlen, uint16_t Txlen);
+#endif // NPI_FLOW_CTRL = 1
+
 // -----------------------------------------------------------------------------
 //! \brief      This routine is used to handle an Rem RDY edge from the app
 //!             context. Certain operations such as UART_read() cannot be
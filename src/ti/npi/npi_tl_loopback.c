@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2015-2016, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// ****************************************************************************
+// includes
+// ****************************************************************************
+#include <string.h>
+#include <stdbool.h>
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+#include "npi_util.h"
+#include "npi_data.h"
+#include "npi_tl.h"
+#include "npi_tl_loopback.h"
+
+// ****************************************************************************
+// defines
+// ****************************************************************************
+
+// ****************************************************************************
+// typedefs
+// ****************************************************************************
+
+//*****************************************************************************
+// globals
+//*****************************************************************************
+
+//! \brief NPI TL call back function for the end of a transaction
+static npiCB_t npiTransmitCB = NULL;
+
+//! \brief Simulated network processor
+static npiLoopbackPeerCB_t npiPeerCB = NULL;
+
+//! \brief Length of the frame in npiTxBuf not yet handed to the peer
+static uint16_t pendingTxLen = 0;
+
+//! \brief Frames injected by the peer, oldest at rxHead
+static _npiFrame_t *rxFrames[NPITLLOOP_RX_DEPTH];
+static uint8_t rxHead = 0;
+static uint8_t rxCount = 0;
+
+//! \brief NPI Transport Layer Buffer variables defined in npi_tl.c
+extern uint8_t *npiTxBuf;
+extern uint16_t npiBufSize;
+
+//! \brief Frame delivered to the NPI TL, defined in npi_tl.c
+extern _npiFrame_t *npiRxFrame;
+
+//! \brief NPI Task call backs used to allocate frames, defined in npi_tl.c
+extern npiTLCallBacks taskCBs;
+
+//*****************************************************************************
+// function prototypes
+//*****************************************************************************
+
+//! \brief Open the loopback
+static void NPITLLOOP_openTransport(uint8_t portID,
+                                    npiInterfaceParams *portParams,
+                                    npiCB_t npiCBack);
+
+//! \brief Close the loopback
+static void NPITLLOOP_closeTransport(void);
+
+//! \brief Start reading. Frames are delivered by NPITLLOOP_poll
+static void NPITLLOOP_readTransport(void);
+
+//! \brief Start writing npiTxBuf
+static uint16_t NPITLLOOP_writeTransport(uint16_t len);
+
+
+//! \brief In-process loopback transport, selected with NPI_SERIAL_TYPE_LOOPBACK.
+//!        There is no Rem RDY/Loc RDY handshake.
+const npiTLTransport_t NPITLLOOP_transport =
+{
+  NPITLLOOP_openTransport,
+  NPITLLOOP_closeTransport,
+  NPITLLOOP_readTransport,
+  NPITLLOOP_writeTransport,
+  NULL,
+  NULL
+};
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine initializes the loopback. portID and portParams
+//!             are not used.
+//!
+//! \param[in]  portID      Not used
+//! \param[in]  portParams  Not used
+//! \param[in]  npiCBack    Transport Layer call back function
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLLOOP_openTransport(uint8_t portID,
+                                    npiInterfaceParams *portParams,
+                                    npiCB_t npiCBack)
+{
+  npiTransmitCB = npiCBack;
+  pendingTxLen = 0;
+  rxHead = 0;
+  rxCount = 0;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine closes the loopback and releases frames that were
+//!             injected but not delivered
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLLOOP_closeTransport(void)
+{
+  _npiCSKey_t key;
+  key = NPIUtil_EnterCS();
+
+  while (rxCount)
+  {
+    if (taskCBs.frameFreeCB)
+    {
+      taskCBs.frameFreeCB(rxFrames[rxHead]);
+    }
+    rxHead = (rxHead + 1) % NPITLLOOP_RX_DEPTH;
+    rxCount--;
+  }
+
+  npiTransmitCB = NULL;
+  pendingTxLen = 0;
+
+  NPIUtil_ExitCS(key);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine is a no-op. Injected frames are delivered by
+//!             NPITLLOOP_poll
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLLOOP_readTransport(void)
+{
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine frames npiTxBuf for the peer. The write completes
+//!             when NPITLLOOP_poll hands it over.
+//!
+//! \param[in]  len - Number of bytes to write.
+//!
+//! \return     uint16_t - number of bytes written to transport
+// -----------------------------------------------------------------------------
+static uint16_t NPITLLOOP_writeTransport(uint16_t len)
+{
+  _npiCSKey_t key;
+  key = NPIUtil_EnterCS();
+
+  pendingTxLen = len + NPI_MSG_SOF_LENGTH + NPI_MSG_FCS_LENGTH;
+
+  NPIUtil_ExitCS(key);
+
+  return len;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine registers the simulated network processor that
+//!             receives the frames written by the host.
+//!
+//! \param[in]  peerCB - Call back invoked for each written frame, or NULL
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITLLOOP_setPeer(npiLoopbackPeerCB_t peerCB)
+{
+  npiPeerCB = peerCB;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine queues a frame from the simulated network processor
+//!             to the host. It is delivered by a later NPITLLOOP_poll.
+//!
+//! \param[in]  cmd0  - Cmd0 of the frame
+//! \param[in]  cmd1  - Cmd1 of the frame
+//! \param[in]  pData - Payload of the frame
+//! \param[in]  len   - Number of payload bytes
+//!
+//! \return     uint8_t - NPI_SUCCESS, NPI_TX_MSG_OVERSIZE or NPI_BUSY if the
+//!                       frame could not be queued
+// -----------------------------------------------------------------------------
+uint8_t NPITLLOOP_inject(uint8_t cmd0, uint8_t cmd1, uint8_t *pData,
+                         uint16_t len)
+{
+  _npiFrame_t *pMsg;
+  _npiCSKey_t key;
+
+  // Same limit as a frame read from a serial port
+  if (len + NPI_MSG_HDR_LENGTH + NPI_MSG_FCS_LENGTH > npiBufSize)
+  {
+    return NPI_TX_MSG_OVERSIZE;
+  }
+
+  key = NPIUtil_EnterCS();
+
+  if (rxCount == NPITLLOOP_RX_DEPTH || taskCBs.frameAllocCB == NULL ||
+      (pMsg = taskCBs.frameAllocCB(len)) == NULL)
+  {
+    NPIUtil_ExitCS(key);
+
+    return NPI_BUSY;
+  }
+
+  pMsg->cmd0 = cmd0;
+  pMsg->cmd1 = cmd1;
+  memcpy(pMsg->pData, pData, len);
+
+  rxFrames[(rxHead + rxCount) % NPITLLOOP_RX_DEPTH] = pMsg;
+  rxCount++;
+
+  NPIUtil_ExitCS(key);
+
+  return NPI_SUCCESS;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine moves frames across the loopback: the frame the
+//!             NPI TL is writing is handed to the peer and completed, then one
+//!             injected frame is delivered to the host. Must be called
+//!             repeatedly from the context simulating the network processor.
+//!
+//! \return     bool - true if a frame was moved in either direction
+// -----------------------------------------------------------------------------
+bool NPITLLOOP_poll(void)
+{
+  bool moved = false;
+  uint16_t txLen;
+  uint8_t *txBuf;
+  _npiCSKey_t key;
+
+  key = NPIUtil_EnterCS();
+  txLen = pendingTxLen;
+  txBuf = npiTxBuf;
+  pendingTxLen = 0;
+  NPIUtil_ExitCS(key);
+
+  if (txLen)
+  {
+    // Peer runs outside the critical section so it may inject its reply.
+    // npiTxBuf stays valid until the TL is told the write is done.
+    if (npiPeerCB)
+    {
+      npiPeerCB(txBuf, txLen);
+    }
+
+    key = NPIUtil_EnterCS();
+    if (npiTransmitCB)
+    {
+      npiTransmitCB(0, txLen);
+    }
+    NPIUtil_ExitCS(key);
+
+    moved = true;
+  }
+
+  key = NPIUtil_EnterCS();
+
+  // One frame at a time, as the NPI TL holds a single received frame until
+  // the NPI Task picks it up
+  if (rxCount && npiRxFrame == NULL && npiTransmitCB)
+  {
+    npiRxFrame = rxFrames[rxHead];
+    rxHead = (rxHead + 1) % NPITLLOOP_RX_DEPTH;
+    rxCount--;
+
+    npiTransmitCB(NPI_MSG_HDR_LENGTH + npiRxFrame->dataLen, 0);
+
+    moved = true;
+  }
+
+  NPIUtil_ExitCS(key);
+
+  return moved;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2015-2016, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NPI_TL_LOOPBACK_H
+#define NPI_TL_LOOPBACK_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// In-process NPI transport. Frames are exchanged with code running on the
+// application MCU, e.g. a task calling NPITLLOOP_poll, so the NPI Task can
+// be exercised with no serial link attached. It is opened through
+// NPITask_open with NPI_SERIAL_TYPE_LOOPBACK only: there is no SNP
+// responder behind it, so SAP and BLE do not offer it as a port. It runs
+// under TI-RTOS on the target; there is no host build.
+
+// ****************************************************************************
+// includes
+// ****************************************************************************
+
+#include "npi_tl.h"
+
+// ****************************************************************************
+// defines
+// ****************************************************************************
+
+//! \brief Number of frames NPITLLOOP_inject can hold before they are delivered
+#ifndef NPITLLOOP_RX_DEPTH
+#define NPITLLOOP_RX_DEPTH 8
+#endif
+
+// ****************************************************************************
+// typedefs
+// ****************************************************************************
+
+// -----------------------------------------------------------------------------
+//! \brief      Typedef for the simulated network processor. Invoked from
+//!             NPITLLOOP_poll for each frame written by the NPI TL.
+//! \param[in]  pFrame    frame as it would be on the wire, SOF to FCS
+//! \param[in]  len       number of bytes in pFrame
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+typedef void (*npiLoopbackPeerCB_t)(uint8_t *pFrame, uint16_t len);
+
+//*****************************************************************************
+// globals
+//*****************************************************************************
+
+//! \brief In-process loopback transport, selected with NPI_SERIAL_TYPE_LOOPBACK
+extern const npiTLTransport_t NPITLLOOP_transport;
+
+//*****************************************************************************
+// function prototypes
+//*****************************************************************************
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine registers the simulated network processor that
+//!             receives the frames written by the host.
+//!
+//! \param[in]  peerCB - Call back invoked for each written frame, or NULL
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITLLOOP_setPeer(npiLoopbackPeerCB_t peerCB);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine queues a frame from the simulated network processor
+//!             to the host. It is delivered by a later NPITLLOOP_poll.
+//!
+//! \param[in]  cmd0  - Cmd0 of the frame
+//! \param[in]  cmd1  - Cmd1 of the frame
+//! \param[in]  pData - Payload of the frame
+//! \param[in]  len   - Number of payload bytes
+//!
+//! \return     uint8_t - NPI_SUCCESS, NPI_TX_MSG_OVERSIZE or NPI_BUSY if the
+//!                       frame could not be queued
+// -----------------------------------------------------------------------------
+extern uint8_t NPITLLOOP_inject(uint8_t cmd0, uint8_t cmd1, uint8_t *pData,
+                                uint16_t len);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine moves frames across the loopback: the frame the
+//!             NPI TL is writing is handed to the peer and completed, then one
+//!             injected frame is delivered to the host. Must be called
+//!             repeatedly from the context simulating the network processor.
+//!
+//! \return     bool - true if a frame was moved in either direction
+// -----------------------------------------------------------------------------
+extern bool NPITLLOOP_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NPI_TL_LOOPBACK_H */
@@ -35,6 +35,7 @@
 // ****************************************************************************
 #include <string.h>
 #include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
 #include <ti/drivers/Power.h>
 //Need for device specific power domains
 #include <ti/drivers/power/PowerMSP432.h>
@@ -53,13 +54,18 @@
 // defines
 // ****************************************************************************
 
+#if !defined(NPI_USE_SPI) && !defined(NPI_USE_UART)
+#error "Must define an underlying serial bus for NPI"
+#endif
 #if defined(NPI_USE_SPI)
 #include "npi_tl_spi.h"
-#elif defined(NPI_USE_UART)
-#include "npi_tl_uart.h"
-#else
-#error "Must define an underlying serial bus for NPI"
 #endif //NPI_USE_SPI
+#if defined(NPI_USE_UART)
+#include "npi_tl_uart.h"
+#endif //NPI_USE_UART
+// Always built in. It replaces the serial port only; this file still needs
+// the TI-RTOS drivers included above.
+#include "npi_tl_loopback.h"
 
 #if (NPI_FLOW_CTRL == 1)
 // Indexes for pin configurations in PIN_Config array
@@ -67,9 +73,15 @@
 #define LOC_RDY_PIN_IDX      1
 #define NPI_UNUSED_PIN_ID    0xFFFFFFFF
 
-#define LocRDY_ENABLE()      GPIO_write(locRdyPIN, 0)
-#define LocRDY_DISABLE()     GPIO_write(locRdyPIN, 1)
+//! \brief Transports without a Rem RDY handler do not use the handshake pins
+#define NPITL_HANDSHAKE()    (npiTransport->remRdyEvent != NULL)
+
+#define LocRDY_ENABLE()      do { if (NPITL_HANDSHAKE()) \
+                                      GPIO_write(locRdyPIN, 0); } while (0)
+#define LocRDY_DISABLE()     do { if (NPITL_HANDSHAKE()) \
+                                      GPIO_write(locRdyPIN, 1); } while (0)
 #else
+#define NPITL_HANDSHAKE()    (false)
 #define LocRDY_ENABLE()
 #define LocRDY_DISABLE()
 #endif // NPI_FLOW_CTRL = 1
@@ -78,10 +90,20 @@
 // typedefs
 // ****************************************************************************
 
+//! \brief Frame handed to NPITL_writeTL that is on the wire or waiting for it
+typedef struct
+{
+    uint8_t             *buf;
+    uint16_t            len;
+} npiTLTxSlot_t;
+
 //*****************************************************************************
 // globals
 //*****************************************************************************
 
+//! \brief Serial port specific TL selected by NPITL_Params.portType
+static const npiTLTransport_t *npiTransport = NULL;
+
 //! \brief Flag for low power mode
 static volatile bool npiPMSetConstraint = false;
 
@@ -104,13 +126,49 @@ static uint16_t npiRxBufTail = 0;
 //! \brief Index to first byte to read from NPI Transport Layer receive buffer
 static uint16_t npiRxBufHead = 0;
 
-//! \brief NPI Transport Layer transmit buffer
+//! \brief NPI frame the serial port specific TL reads the payload of the
+//!        current packet into. Handed to the NPI Task by NPITL_getRxFrame
+_npiFrame_t *npiRxFrame = NULL;
+
+//! \brief NPI Transport Layer transmit buffer. Points into the buffer of the
+//!        frame being transmitted, which is owned by the NPI Task
 uint8_t *npiTxBuf;
 
 //! \brief Number of bytes in NPI Transport Layer transmit buffer
 static uint16_t npiTxBufLen = 0;
 
-//! \brief Size of allocated Tx and Rx buffers
+//! \brief Ring of frames accepted by NPITL_writeTL. The slot at
+//!        npiTxRingHead is the one on the wire while npiTxActive is set,
+//!        the others are started back to back as each transaction completes
+static npiTLTxSlot_t npiTxRing[NPITL_TX_RING_SIZE];
+static uint8_t npiTxRingHead = 0;
+static uint8_t npiTxRingCount = 0;
+
+#if (NPI_FLOW_CTRL == 1)
+//! \brief Bytes written in the current Rem RDY handshake, see NPITL_coalesceTx
+static uint16_t npiTxWindowLen = 0;
+#endif // NPI_FLOW_CTRL = 1
+
+//! \brief Link utilisation counters, see NPITL_getTxStats
+static uint32_t txStatsFrames = 0;
+static uint32_t txStatsBytes = 0;
+static uint32_t txStatsBusyTicks = 0;
+static uint32_t txStatsCoalesced = 0;
+static uint32_t txStatsStartStamp = 0;
+static uint32_t txStartStamp = 0;
+
+//! \brief Receive drop counters, updated by the serial port specific TL.
+//!        See NPITL_getRxStats
+uint32_t npiRxDropBytes = 0;
+uint32_t npiRxDropFrames = 0;
+uint32_t npiRxFcsErrors = 0;
+uint32_t npiRxOversized = 0;
+
+//! \brief Frames and bytes delivered, see NPITL_getRxStats
+static uint32_t rxStatsFrames = 0;
+static uint32_t rxStatsBytes = 0;
+
+//! \brief Size of allocated Rx buffer and max size of a Tx frame
 uint16_t npiBufSize = 0;
 
 npiTLCallBacks taskCBs;
@@ -139,6 +197,12 @@ static uint8_t remRdy_state;
 //         invoked upon the completion of a transmission
 static void NPITL_transmissionCallBack(uint16_t Rxlen, uint16_t Txlen);
 
+//! \brief Start the frame at the head of the Tx ring if the link is idle
+static void NPITL_startTx(void);
+
+//! \brief Account for and remove the frame at the head of the Tx ring
+static void NPITL_retireTx(uint16_t Txlen);
+
 #if (NPI_FLOW_CTRL == 1)
 //! \brief HWI interrupt function for remRdy
 static void NPITL_remRdyPINHwiFxn(void);
@@ -152,89 +216,127 @@ static void NPITL_relPM(void);
 
 // -----------------------------------------------------------------------------
 //! \brief      This routine initializes the transport layer and opens the port
-//!             of the device. Note that based on project defines, either the
-//!             UART, or SPI driver can be used.
+//!             of the device. The serial port specific TL is selected by
+//!             params->portType among those built in: UART and/or SPI based
+//!             on project defines, and the in-process loopback.
 //!
 //! \param[in]  params - Transport Layer parameters
 //!
-//! \return     void
+//! \return     uint8_t - NPI_SUCCESS, or NPI_TASK_INVALID_PARAMS if portType
+//!                       is not supported by this build
 // -----------------------------------------------------------------------------
-void NPITL_openTL(NPITL_Params *params)
+uint8_t NPITL_openTL(NPITL_Params *params)
 {
     _npiCSKey_t key;
+
+    switch (params->portType)
+    {
+#if defined(NPI_USE_UART)
+        case NPI_SERIAL_TYPE_UART:
+            npiTransport = &NPITLUART_transport;
+            break;
+#endif //NPI_USE_UART
+#if defined(NPI_USE_SPI)
+        case NPI_SERIAL_TYPE_SPI:
+#if (NPI_FLOW_CTRL == 1)
+            npiTransport = &NPITLSPI_transport;
+            break;
+#else
+            // As master, the slave's frames are only clocked in once it
+            // asserts Rem RDY, so SPI cannot receive without the handshake
+            return NPI_TASK_INVALID_PARAMS;
+#endif // NPI_FLOW_CTRL = 1
+#endif //NPI_USE_SPI
+        case NPI_SERIAL_TYPE_LOOPBACK:
+            npiTransport = &NPITLLOOP_transport;
+            break;
+        default:
+            return NPI_TASK_INVALID_PARAMS;
+    }
+
     key = NPIUtil_EnterCS();
 
     // Set NPI Task Call backs
     memcpy(&taskCBs, &params->npiCallBacks, sizeof(params->npiCallBacks));
 
-    // Allocate memory for Transport Layer Tx/Rx buffers
+    // Allocate memory for Transport Layer Rx buffer. Tx frames are sent from
+    // the caller's buffer (see NPITL_writeTL)
     npiBufSize = params->npiTLBufSize;
     npiRxBuf = NPIUTIL_MALLOC(params->npiTLBufSize);
     memset(npiRxBuf, 0, npiBufSize);
-    npiTxBuf = NPIUTIL_MALLOC(params->npiTLBufSize);
-    memset(npiTxBuf, 0, npiBufSize);
-
-    // This will be updated to be able to select SPI/UART TL at runtime
-    // Now only compile time with the NPI_USE_[UART,SPI] flag
-#if defined(NPI_USE_UART)
-    transportOpen(params->portBoardID,
-                  &params->portParams.uartParams,
-                  NPITL_transmissionCallBack);
-#elif defined(NPI_USE_SPI)
-    transportOpen(params->portBoardID,
-                  &params->portParams.spiParams,
-                  NPITL_transmissionCallBack);
-#endif //NPI_USE_UART
+    npiTxBuf = NULL;
+    npiTxRingHead = 0;
+    npiTxRingCount = 0;
+    txStatsFrames = 0;
+    txStatsBytes = 0;
+    txStatsBusyTicks = 0;
+    txStatsCoalesced = 0;
+    txStatsStartStamp = Timestamp_get32();
+    rxStatsFrames = 0;
+    rxStatsBytes = 0;
+    npiRxDropBytes = 0;
+    npiRxDropFrames = 0;
+    npiRxFcsErrors = 0;
+    npiRxOversized = 0;
+
+    npiTransport->open(params->portBoardID, &params->portParams,
+                       NPITL_transmissionCallBack);
 
 #if (NPI_FLOW_CTRL == 1)
-    // Assign PIN IDs to remRdy and locRrdy
+    if (NPITL_HANDSHAKE())
+    {
+        // Assign PIN IDs to remRdy and locRrdy
 #ifdef NPI_MASTER
-    remRdyPIN = params->srdyPinID;
-    locRdyPIN = params->mrdyPinID;
+        remRdyPIN = params->srdyPinID;
+        locRdyPIN = params->mrdyPinID;
 #else
-    remRdyPIN = params->mrdyPinID;
-    locRdyPIN = params->srdyPinID;
+        remRdyPIN = params->mrdyPinID;
+        locRdyPIN = params->srdyPinID;
 #endif //NPI_MASTER
 
-    // Add PIN IDs to PIN Configuration
-    npiHandshakePinsCfg[REM_RDY_PIN_IDX] |= remRdyPIN;
-    npiHandshakePinsCfg[LOC_RDY_PIN_IDX] |= locRdyPIN;
+        // Add PIN IDs to PIN Configuration
+        npiHandshakePinsCfg[REM_RDY_PIN_IDX] |= remRdyPIN;
+        npiHandshakePinsCfg[LOC_RDY_PIN_IDX] |= locRdyPIN;
 
-    // Initialize LOCRDY/REMRDY. Enable int after callback registered
-    GPIO_disableInt(remRdyPIN);
-    GPIO_clearInt(remRdyPIN);
-    GPIO_setConfig(remRdyPIN, npiHandshakePinsCfg[REM_RDY_PIN_IDX] | GPIO_CFG_IN_INT_FALLING );
-    GPIO_setConfig(locRdyPIN, npiHandshakePinsCfg[LOC_RDY_PIN_IDX]);
-    // Enable wakeup
-    GPIO_setCallback(remRdyPIN, (GPIO_CallbackFxn)NPITL_remRdyPINHwiFxn);
-
-    if(GPIO_read(remRdyPIN))
-        remRdy_state = 1;
-    else
-        remRdy_state = 0;
-
-    // If MRDY is already low then we must initiate a read because there was
-    // a prior MRDY negedge that was missed
-    if (!remRdy_state)
-    {
-        GPIO_setConfig(remRdyPIN, npiHandshakePinsCfg[REM_RDY_PIN_IDX] | GPIO_CFG_IN_INT_RISING );
-        NPITL_setPM();
-        if (taskCBs.remRdyCB)
+        // Initialize LOCRDY/REMRDY. Enable int after callback registered
+        GPIO_disableInt(remRdyPIN);
+        GPIO_clearInt(remRdyPIN);
+        GPIO_setConfig(remRdyPIN, npiHandshakePinsCfg[REM_RDY_PIN_IDX] | GPIO_CFG_IN_INT_FALLING );
+        GPIO_setConfig(locRdyPIN, npiHandshakePinsCfg[LOC_RDY_PIN_IDX]);
+        // Enable wakeup
+        GPIO_setCallback(remRdyPIN, (GPIO_CallbackFxn)NPITL_remRdyPINHwiFxn);
+
+        if(GPIO_read(remRdyPIN))
+            remRdy_state = 1;
+        else
+            remRdy_state = 0;
+
+        // If MRDY is already low then we must initiate a read because there was
+        // a prior MRDY negedge that was missed
+        if (!remRdy_state)
         {
-            transportRemRdyEvent();
-            LocRDY_ENABLE();
+            GPIO_setConfig(remRdyPIN, npiHandshakePinsCfg[REM_RDY_PIN_IDX] | GPIO_CFG_IN_INT_RISING );
+            NPITL_setPM();
+            if (taskCBs.remRdyCB)
+            {
+                npiTransport->remRdyEvent();
+                LocRDY_ENABLE();
+            }
         }
+        GPIO_clearInt(remRdyPIN);
+        GPIO_enableInt(remRdyPIN);
     }
-    GPIO_clearInt(remRdyPIN);
-    GPIO_enableInt(remRdyPIN);
 #endif // NPI_FLOW_CTRL = 1
 
-#if (NPI_FLOW_CTRL == 0)
-    // This call will start repeated Uart Reads when Power Savings is disabled
-    transportRead();
-#endif // NPI_FLOW_CTRL = 0
+    if (!NPITL_HANDSHAKE())
+    {
+        // This call will start repeated reads when there is no handshake
+        npiTransport->read();
+    }
 
     NPIUtil_ExitCS(key);
+
+    return NPI_SUCCESS;
 }
 
 // -----------------------------------------------------------------------------
@@ -247,20 +349,35 @@ void NPITL_closeTL(void)
     _npiCSKey_t key;
     key = NPIUtil_EnterCS();
 
-    // Clear NPI Task Call backs
-    memset(&taskCBs, 0, sizeof(taskCBs));
-
-    // Free Transport Layer RX/TX buffers
+    // Free Transport Layer RX buffer
     npiBufSize = 0;
     NPIUTIL_FREE(npiRxBuf);
-    NPIUTIL_FREE(npiTxBuf);
+    npiTxBuf = NULL;
+    npiTxActive = false;
+    npiTxRingCount = 0;
 
     // Close Transport Layer
-    transportClose();
+    npiTransport->close();
+
+    // Free a received frame the NPI Task never picked up
+    if (npiRxFrame != NULL)
+    {
+        if (taskCBs.frameFreeCB)
+        {
+            taskCBs.frameFreeCB(npiRxFrame);
+        }
+        npiRxFrame = NULL;
+    }
+
+    // Clear NPI Task Call backs
+    memset(&taskCBs, 0, sizeof(taskCBs));
 
 #if (NPI_FLOW_CTRL == 1)
     // Disable remote RDY pin from receiving interrupts
-    GPIO_disableInt(remRdyPIN);
+    if (NPITL_HANDSHAKE())
+    {
+        GPIO_disableInt(remRdyPIN);
+    }
 
     // Clear mrdy and srdy PIN IDs
     remRdyPIN = NPI_UNUSED_PIN_ID; // Set to 0x000000FF
@@ -284,6 +401,11 @@ void NPITL_closeTL(void)
 // -----------------------------------------------------------------------------
 bool NPITL_checkNpiBusy(void)
 {
+    if (!NPITL_HANDSHAKE())
+    {
+        return npiTxActive;
+    }
+
 #if (NPI_FLOW_CTRL == 1)
 #ifdef NPI_MASTER
     return !GPIO_read(locRdyPIN) || npiRxActive;
@@ -353,7 +475,7 @@ void NPITL_handleRemRdyEvent(void)
     if (GPIO_read(remRdyPIN) == 0 ||
         (npiTxActive && mrdyPktStamp == txPktCount))
     {
-        transportRemRdyEvent();
+        npiTransport->remRdyEvent();
         npiRxActive = true;
         LocRDY_ENABLE();
     }
@@ -389,7 +511,7 @@ static void NPITL_remRdyPINHwiFxn(void)
     else
     {
         GPIO_setConfig(remRdyPIN, npiHandshakePinsCfg[REM_RDY_PIN_IDX] | GPIO_CFG_IN_INT_FALLING );
-        transportStopTransfer();
+        npiTransport->stopTransfer();
         npiRxActive = false;
     }
 
@@ -420,7 +542,8 @@ static void NPITL_remRdyPINHwiFxn(void)
 //!             to/from the host MCU. Any bytes receives will be [0,Rxlen) in
 //!             npiRxBuf.
 //!             If bytes were receives or transmitted, this function notifies
-//!             the NPI task via registered call backs
+//!             the NPI task via registered call backs. Runs in the critical
+//!             section whether or not the serial port TL already holds it.
 //!
 //! \param[in]  Rxlen   - length of the data received
 //! \param[in]  Txlen   - length of the data transferred
@@ -429,9 +552,28 @@ static void NPITL_remRdyPINHwiFxn(void)
 // -----------------------------------------------------------------------------
 static void NPITL_transmissionCallBack(uint16_t Rxlen, uint16_t Txlen)
 {
+    _npiCSKey_t key;
+    key = NPIUtil_EnterCS();
+
     npiRxBufHead = 0;
     npiRxBufTail = Rxlen;
-    npiTxActive = false;
+
+    if (Rxlen)
+    {
+        rxStatsFrames++;
+        rxStatsBytes += Rxlen + NPI_MSG_SOF_LENGTH + NPI_MSG_FCS_LENGTH;
+    }
+
+    // Only report Txlen when it completes the frame at the head of the ring.
+    // The serial port TL may report a stale Txlen for Rx only transactions.
+    if (Txlen && npiTxActive)
+    {
+        NPITL_retireTx(Txlen);
+    }
+    else
+    {
+        Txlen = 0;
+    }
 
     // If Task is registered, invoke transaction complete callback
     if (taskCBs.transCompleteCB)
@@ -443,6 +585,249 @@ static void NPITL_transmissionCallBack(uint16_t Rxlen, uint16_t Txlen)
     NPITL_relPM();
     LocRDY_DISABLE();
 #endif // NPI_FLOW_CTRL = 1
+
+    // Start the next buffered frame right away instead of waiting for the
+    // NPI Task to wake up and hand it over
+    NPITL_startTx();
+
+    NPIUtil_ExitCS(key);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Accounts for the frame at the head of the Tx ring, which has
+//!             been written, and removes it. Must be called with interrupts
+//!             disabled.
+//!
+//! \param[in]  Txlen   - length of the data transferred
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITL_retireTx(uint16_t Txlen)
+{
+    uint32_t now = Timestamp_get32();
+
+    txStatsFrames++;
+    txStatsBytes += Txlen;
+    txStatsBusyTicks += now - txStartStamp;
+    txStartStamp = now;
+
+    npiTxRingHead = (npiTxRingHead + 1) % NPITL_TX_RING_SIZE;
+    npiTxRingCount--;
+    npiTxActive = false;
+}
+
+#if (NPI_FLOW_CTRL == 1)
+// -----------------------------------------------------------------------------
+//! \brief      This routine is called by the Serial Port Specific TL when a
+//!             frame has been written while the handshake is still held. It
+//!             returns the next buffered frame if that can be written in the
+//!             same handshake. Only async frames are coalesced, and only up
+//!             to npiBufSize bytes per handshake. Each frame keeps its own
+//!             SOF and FCS. Nothing changes until NPITL_coalesceTx, so a
+//!             driver that refuses the write leaves the ring as it was.
+//!
+//! \param[out] pBuf - Set to the next frame, SOF to FCS
+//!
+//! \return     uint16_t - length of the next frame excluding SOF and FCS, 0 if
+//!                        the transaction should end
+// -----------------------------------------------------------------------------
+uint16_t NPITL_peekCoalesceTx(uint8_t **pBuf)
+{
+    npiTLTxSlot_t *next;
+    uint8_t cmd0;
+
+    // Frame at the head must be async, a sync REQ/RSP ends the handshake as
+    // usual so its response is not held up
+    cmd0 = npiTxBuf[NPI_MSG_SOF_LENGTH + NPI_MSG_LEN_LENGTH];
+    if (!npiTxActive || npiTxRingCount < 2 ||
+        ((cmd0 & NPI_CMD0_TYPE_MASK) >> 5) != NPI_MSG_TYPE_ASYNC)
+    {
+        return 0;
+    }
+
+    next = &npiTxRing[(npiTxRingHead + 1) % NPITL_TX_RING_SIZE];
+    cmd0 = next->buf[NPI_MSG_SOF_LENGTH + NPI_MSG_LEN_LENGTH];
+    if (((cmd0 & NPI_CMD0_TYPE_MASK) >> 5) != NPI_MSG_TYPE_ASYNC ||
+        npiTxWindowLen + next->len + NPI_MSG_SOF_LENGTH + NPI_MSG_FCS_LENGTH >
+        npiBufSize)
+    {
+        return 0;
+    }
+
+    *pBuf = next->buf;
+    return next->len;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine is called by the Serial Port Specific TL once the
+//!             driver has accepted the frame NPITL_peekCoalesceTx returned.
+//!             It retires the completed frame and makes the next one the
+//!             current npiTxBuf. A frame received in the same transaction is
+//!             delivered along with it.
+//!
+//! \param[in]  Rxlen - Number of bytes received, 0 if none
+//! \param[in]  Txlen - Number of bytes written for the completed frame
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITL_coalesceTx(uint16_t Rxlen, uint16_t Txlen)
+{
+    npiTLTxSlot_t *next = &npiTxRing[(npiTxRingHead + 1) % NPITL_TX_RING_SIZE];
+
+    // Previous frame is on the wire, let the NPI Task release it and pick up
+    // the one received
+    if (Rxlen)
+    {
+        npiRxBufHead = 0;
+        npiRxBufTail = Rxlen;
+        rxStatsFrames++;
+        rxStatsBytes += Rxlen + NPI_MSG_SOF_LENGTH + NPI_MSG_FCS_LENGTH;
+    }
+    NPITL_retireTx(Txlen);
+    if (taskCBs.transCompleteCB)
+    {
+        taskCBs.transCompleteCB(Rxlen, Txlen);
+    }
+
+    // Next frame goes out under the same handshake. txPktCount is left as is
+    // since no new Loc RDY edge is generated
+    npiTxBuf = next->buf;
+    npiTxBufLen = next->len;
+    npiTxActive = true;
+    npiTxWindowLen += npiTxBufLen + NPI_MSG_SOF_LENGTH + NPI_MSG_FCS_LENGTH;
+    txStatsCoalesced++;
+}
+#endif // NPI_FLOW_CTRL = 1
+
+// -----------------------------------------------------------------------------
+//! \brief      Starts the frame at the head of the Tx ring if there is one and
+//!             the link is idle. Enters the critical section itself, so it
+//!             may be called from the serial port call backs as well as from
+//!             the NPI Task.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITL_startTx(void)
+{
+    _npiCSKey_t key;
+    key = NPIUtil_EnterCS();
+
+    if (npiTxRingCount == 0 || npiTxActive || NPITL_checkNpiBusy())
+    {
+        NPIUtil_ExitCS(key);
+        return;
+    }
+
+    // Send straight from the caller's buffer. Its first byte is left free so
+    // Serial Port Specific TL code can fill in the SOF without shifting.
+    npiTxBuf = npiTxRing[npiTxRingHead].buf;
+    npiTxBufLen = npiTxRing[npiTxRingHead].len;
+    npiTxActive = true;
+    txPktCount++;
+    txStartStamp = Timestamp_get32();
+#if (NPI_FLOW_CTRL == 1)
+    npiTxWindowLen = npiTxBufLen + NPI_MSG_SOF_LENGTH + NPI_MSG_FCS_LENGTH;
+#endif // NPI_FLOW_CTRL = 1
+
+    npiTransport->write(npiTxBufLen);
+
+    LocRDY_ENABLE();
+
+    NPIUtil_ExitCS(key);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine starts the next frame buffered by NPITL_writeTL if
+//!             the link has become idle, e.g. after Rem RDY was de-asserted.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITL_resumeTL(void)
+{
+    NPITL_startTx();
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine returns the number of frames NPITL_writeTL can
+//!             still accept without returning NPI_BUSY.
+//!
+//! \return     uint8_t - number of free Tx ring slots
+// -----------------------------------------------------------------------------
+uint8_t NPITL_getTxSlotsFree(void)
+{
+    return NPITL_TX_RING_SIZE - npiTxRingCount;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine reads the link utilisation counters.
+//!
+//! \param[out] stats - Pointer to struct the counters are copied to.
+//! \param[in]  reset - Restart the counters after reading them.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITL_getTxStats(NPITL_TxStats *stats, bool reset)
+{
+    _npiCSKey_t key;
+    Types_FreqHz freq;
+    uint32_t now;
+
+    Timestamp_getFreq(&freq);
+
+    key = NPIUtil_EnterCS();
+
+    now = Timestamp_get32();
+    stats->txFrames = txStatsFrames;
+    stats->txBytes = txStatsBytes;
+    stats->txBusyTicks = txStatsBusyTicks;
+    stats->txCoalesced = txStatsCoalesced;
+    stats->elapsedTicks = now - txStatsStartStamp;
+    stats->tickFreq = freq.lo;
+
+    if (reset)
+    {
+        txStatsFrames = 0;
+        txStatsBytes = 0;
+        txStatsBusyTicks = 0;
+        txStatsCoalesced = 0;
+        txStatsStartStamp = now;
+    }
+
+    NPIUtil_ExitCS(key);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine reads the receive error counters.
+//!
+//! \param[out] stats - Pointer to struct the counters are copied to.
+//! \param[in]  reset - Restart the counters after reading them.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITL_getRxStats(NPITL_RxStats *stats, bool reset)
+{
+    _npiCSKey_t key;
+
+    key = NPIUtil_EnterCS();
+
+    stats->rxFrames = rxStatsFrames;
+    stats->rxBytes = rxStatsBytes;
+    stats->rxDropBytes = npiRxDropBytes;
+    stats->rxDropFrames = npiRxDropFrames;
+    stats->rxFcsErrors = npiRxFcsErrors;
+    stats->rxOversized = npiRxOversized;
+
+    if (reset)
+    {
+        rxStatsFrames = 0;
+        rxStatsBytes = 0;
+        npiRxDropBytes = 0;
+        npiRxDropFrames = 0;
+        npiRxFcsErrors = 0;
+        npiRxOversized = 0;
+    }
+
+    NPIUtil_ExitCS(key);
 }
 
 // -----------------------------------------------------------------------------
@@ -465,55 +850,71 @@ uint16_t NPITL_readTL(uint8_t *buf, uint16_t len)
     return len;
 }
 
+// -----------------------------------------------------------------------------
+//! \brief      This routine returns the NPI frame received in the last
+//!             transaction. Ownership passes to the caller.
+//!
+//! \return     _npiFrame_t* - received frame, NULL if there is none
+// -----------------------------------------------------------------------------
+_npiFrame_t * NPITL_getRxFrame(void)
+{
+    _npiFrame_t *pMsg;
+    _npiCSKey_t key;
+    key = NPIUtil_EnterCS();
+
+    pMsg = npiRxFrame;
+    npiRxFrame = NULL;
+
+    NPIUtil_ExitCS(key);
+
+    return pMsg;
+}
+
 // -----------------------------------------------------------------------------
 //! \brief      This routine writes data from the buffer to the transport layer.
+//!             The buffer is transmitted in place and must already hold the
+//!             SOF in buf[0] and the FCS in buf[len + 1]. Up to NPITL_TX_RING_SIZE
+//!             buffers are accepted and sent back to back in order; each must
+//!             stay valid until the transaction complete call back reports
+//!             Txlen for it.
 //!
 //! \param[in]  buf - Pointer to buffer to write data from.
-//! \param[in]  len - Number of bytes to write.
+//! \param[in]  len - Number of bytes to write, excluding SOF and FCS.
 //!
 //! \return     uint16_t - NPI error code value
 // -----------------------------------------------------------------------------
 uint8_t NPITL_writeTL(uint8_t *buf, uint16_t len)
 {
-#if (NPI_FLOW_CTRL == 1)
     _npiCSKey_t key;
-    key = NPIUtil_EnterCS();
-#endif // NPI_FLOW_CTRL = 1
-
-    // Check to make sure NPI is not currently in a transaction
-    if (NPITL_checkNpiBusy())
-    {
-#if (NPI_FLOW_CTRL == 1)
-        NPIUtil_ExitCS(key);
-#endif // NPI_FLOW_CTRL = 1
-
-        return NPI_BUSY;
-    }
+    npiTLTxSlot_t *slot;
 
     // Check to make sure that write size is not greater than what is
     // allowed
     if (len > npiBufSize)
     {
-#if (NPI_FLOW_CTRL == 1)
+        return NPI_TX_MSG_OVERSIZE;
+    }
+
+    key = NPIUtil_EnterCS();
+
+    // Check to make sure there is room left in the Tx ring
+    if (npiTxRingCount == NPITL_TX_RING_SIZE)
+    {
         NPIUtil_ExitCS(key);
-#endif // NPI_FLOW_CTRL = 1
 
-        return NPI_TX_MSG_OVERSIZE;
+        return NPI_BUSY;
     }
 
-    // Copy into the second byte of npiTxBuf. This will save Serial Port
-    // Specific TL code from having to shift one byte later on for SOF.
-    memcpy(&npiTxBuf[1], buf, len);
-    npiTxBufLen = len;
-    npiTxActive = true;
-    txPktCount++;
+    slot = &npiTxRing[(npiTxRingHead + npiTxRingCount) % NPITL_TX_RING_SIZE];
+    slot->buf = buf;
+    slot->len = len;
+    npiTxRingCount++;
 
-    transportWrite(npiTxBufLen);
+    // Goes on the wire now if NPI is not currently in a transaction,
+    // otherwise when the transactions ahead of it complete
+    NPITL_startTx();
 
-#if (NPI_FLOW_CTRL == 1)
-    LocRDY_ENABLE();
     NPIUtil_ExitCS(key);
-#endif // NPI_FLOW_CTRL = 1
 
     return NPI_SUCCESS;
 }
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2015-2016, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NPI_TL_SPI_H
+#define NPI_TL_SPI_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ****************************************************************************
+// includes
+// ****************************************************************************
+
+#include "npi_tl.h"
+
+// ****************************************************************************
+// defines
+// ****************************************************************************
+
+// ****************************************************************************
+// typedefs
+// ****************************************************************************
+
+//*****************************************************************************
+// globals
+//*****************************************************************************
+
+//! \brief SPI master transport, selected with NPI_SERIAL_TYPE_SPI
+extern const npiTLTransport_t NPITLSPI_transport;
+
+//*****************************************************************************
+// function prototypes
+//*****************************************************************************
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine initializes the transport layer and opens the port
+//!             of the device.
+//!
+//! \param[in]  portID          ID value for board specific SPI port
+//! \param[in]  portParams      Parameters used to initialize SPI port
+//! \param[in]  npiCBack        Transport Layer call back function
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITLSPI_openTransport(uint8_t portID,
+                                   npiInterfaceParams *portParams,
+                                   npiCB_t npiCBack);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine closes Transport Layer port
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITLSPI_closeTransport(void);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine reads data from the SPI. As master, bytes from the
+//!             slave are only clocked in during a transaction, so there is
+//!             nothing to start here.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITLSPI_readTransport(void);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine initializes and begins a SPI transfer
+//!
+//! \param[in]  len - Number of bytes to write.
+//!
+//! \return     uint16_t - number of bytes written to transport
+// -----------------------------------------------------------------------------
+extern uint16_t NPITLSPI_writeTransport(uint16_t len);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine stops any pending transfer
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITLSPI_stopTransfer(void);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine is called from the application context when REM RDY
+//!             is asserted
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITLSPI_handleRemRdyEvent(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NPI_TL_SPI_H */
@@ -0,0 +1,497 @@
+/*
+ * Copyright (c) 2015-2016, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// ****************************************************************************
+// includes
+// ****************************************************************************
+#include "hal_types.h"
+#include "hal_defs.h"
+
+#include "npi_util.h"
+#include "npi_data.h"
+#include "npi_tl.h"
+#include "npi_tl_spi.h"
+#include <ti/drivers/SPI.h>
+#include <stdbool.h>
+
+
+// ****************************************************************************
+// defines
+// ****************************************************************************
+
+//! \brief NPI SPI Message Indexes and Constants
+//
+#define NPI_SPI_MSG_SOF_HDR_LEN                      0x05
+#define NPI_SPI_MSG_HDR_LEN                          0x04
+#define NPI_SPI_MSG_SOF                              0xFE
+#define NPI_SPI_MSG_SOF_IDX                          0x00
+#define NPI_SPI_MSG_LEN0_IDX                         0x01
+#define NPI_SPI_MSG_LEN1_IDX                         0x02
+#define NPI_SPI_MSG_CMD0_IDX                         0x03
+#define NPI_SPI_MSG_CMD1_IDX                         0x04
+
+//! \brief NPI SPI Transfer States
+typedef enum
+{
+  NPITLSPI_IDLE = 0x00,
+  NPITLSPI_XFER_HDR,
+  NPITLSPI_XFER_BODY
+} npiTLSpi_xferState;
+
+// ****************************************************************************
+// typedefs
+// ****************************************************************************
+
+//*****************************************************************************
+// globals
+//*****************************************************************************
+
+//! \brief SPI master transport, selected with NPI_SERIAL_TYPE_SPI
+//!        NPITL_openTL refuses it without NPI_FLOW_CTRL, as frames from the
+//!        slave are only clocked in once it asserts Rem RDY.
+const npiTLTransport_t NPITLSPI_transport =
+{
+  NPITLSPI_openTransport,
+  NPITLSPI_closeTransport,
+  NPITLSPI_readTransport,
+  NPITLSPI_writeTransport,
+#if (NPI_FLOW_CTRL == 1)
+  NPITLSPI_stopTransfer,
+  NPITLSPI_handleRemRdyEvent
+#else
+  NULL,
+  NULL
+#endif // NPI_FLOW_CTRL = 1
+};
+
+//! \brief SPI Handle for SPI Driver
+static SPI_Handle spiHandle;
+
+//! \brief SPI transaction in progress
+static SPI_Transaction spiTransaction;
+
+//! \brief NPI TL call back function for the end of a SPI transaction
+static npiCB_t npiTransmitCB = NULL;
+
+//! \brief Flag signalling a frame is waiting in npiTxBuf to be clocked out
+static bool TxActive = false;
+
+//! \brief Frame being clocked out. npiTxBuf, or the frame after it while a
+//!        coalesced transfer is being started
+static uint8_t *spiTxBuf = NULL;
+
+//! \brief Length of bytes to send from NPI TL Tx Buffer
+static uint16_t TransportTxLen = 0;
+
+//! \brief Bytes of the payload and FCS announced by the slave's header
+static uint16_t TransportRxLen = 0;
+
+//! \brief Bytes already clocked out of npiTxBuf / into the Rx frame
+static uint16_t txOffset = 0;
+static uint16_t rxOffset = 0;
+
+//! \brief npiRxFrame was allocated for the current transaction. Otherwise it
+//!        may be a frame the NPI Task has yet to pick up
+static bool rxFrameOwned = false;
+
+//! \brief State of the SPI transfer call back
+static npiTLSpi_xferState xferState = NPITLSPI_IDLE;
+
+//! \brief NPI Transport Layer Buffer variables defined in npi_tl.c
+extern uint8_t *npiRxBuf;
+extern uint8_t *npiTxBuf;
+extern uint16_t npiBufSize;
+
+//! \brief Frame the current payload is read into, defined in npi_tl.c
+extern _npiFrame_t *npiRxFrame;
+
+//! \brief NPI Task call backs used to allocate npiRxFrame, defined in npi_tl.c
+extern npiTLCallBacks taskCBs;
+
+//! \brief Receive drop counters, defined in npi_tl.c
+extern uint32_t npiRxDropBytes;
+extern uint32_t npiRxDropFrames;
+extern uint32_t npiRxFcsErrors;
+extern uint32_t npiRxOversized;
+
+//*****************************************************************************
+// function prototypes
+//*****************************************************************************
+
+//! \brief SPI Callback invoked after each SPI_transfer completion
+static void NPITLSPI_transferCallBack(SPI_Handle handle,
+                                      SPI_Transaction *transaction);
+
+//! \brief Clock the SOF and header in both directions
+static void NPITLSPI_startTransaction(void);
+
+//! \brief Clock the next part of the payloads, false when there is none left
+static bool NPITLSPI_transferNext(void);
+
+//! \brief Release npiRxFrame after an incomplete or invalid packet
+static void NPITLSPI_dropRxFrame(void);
+
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine initializes the transport layer and opens the port
+//!             of the device.
+//!
+//! \param[in]  portID      ID value for board specific SPI port
+//! \param[in]  portParams  Parameters used to initialize SPI port
+//! \param[in]  npiCBack    Trasnport Layer call back function
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITLSPI_openTransport(uint8_t portID, npiInterfaceParams *portParams,
+                            npiCB_t npiCBack)
+{
+  npiTransmitCB = npiCBack;
+  TxActive = false;
+  xferState = NPITLSPI_IDLE;
+
+  // Add call back to SPI parameters.
+  portParams->spiParams.transferMode = SPI_MODE_CALLBACK;
+  portParams->spiParams.transferCallbackFxn = NPITLSPI_transferCallBack;
+
+  // Open / power on the SPI.
+  spiHandle = SPI_open(portID, &portParams->spiParams);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine closes Transport Layer port
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITLSPI_closeTransport(void)
+{
+  npiTransmitCB = NULL;
+  SPI_transferCancel(spiHandle);
+  SPI_close(spiHandle);
+  NPITLSPI_dropRxFrame();
+  TxActive = false;
+  xferState = NPITLSPI_IDLE;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine reads data from the SPI. As master, bytes from the
+//!             slave are only clocked in during a transaction, so there is
+//!             nothing to start here.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITLSPI_readTransport(void)
+{
+}
+
+#if (NPI_FLOW_CTRL == 1)
+// -----------------------------------------------------------------------------
+//! \brief      This routine stops any pending transfer. Rem RDY de-asserted
+//!             before the transaction completed means the slave gave up on it.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITLSPI_stopTransfer(void)
+{
+  if (xferState != NPITLSPI_IDLE)
+  {
+    // Call back is invoked with SPI_TRANSFER_CANCELED
+    SPI_transferCancel(spiHandle);
+  }
+}
+#endif // NPI_FLOW_CTRL = 1
+
+#if (NPI_FLOW_CTRL == 1)
+// -----------------------------------------------------------------------------
+//! \brief      This routine is called from the application context when REM RDY
+//!             is asserted. The slave is ready, so clock the transaction now
+//!             whether or not the master has a frame to send.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITLSPI_handleRemRdyEvent(void)
+{
+  _npiCSKey_t key;
+  key = NPIUtil_EnterCS();
+
+  if (xferState == NPITLSPI_IDLE)
+  {
+    NPITLSPI_startTransaction();
+  }
+
+  NPIUtil_ExitCS(key);
+}
+#endif // NPI_FLOW_CTRL = 1
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine frames npiTxBuf and begins the transfer. With flow
+//!             control it is clocked once the slave asserts Rem RDY.
+//!
+//! \param[in]  len - Number of bytes to write.
+//!
+//! \return     uint16_t - number of bytes written to transport
+// -----------------------------------------------------------------------------
+uint16_t NPITLSPI_writeTransport(uint16_t len)
+{
+  _npiCSKey_t key;
+  key = NPIUtil_EnterCS();
+
+  spiTxBuf = npiTxBuf;
+  TransportTxLen = len + NPI_MSG_SOF_LENGTH + NPI_MSG_FCS_LENGTH;
+  TxActive = true;
+
+  NPIUtil_ExitCS(key);
+
+  return len;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Clock the SOF and header in both directions. The slave sends
+//!             zeros instead of a SOF when it has nothing to send.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLSPI_startTransaction(void)
+{
+  TransportRxLen = 0;
+  rxOffset = 0;
+  rxFrameOwned = false;
+  txOffset = TxActive ? NPI_SPI_MSG_SOF_HDR_LEN : 0;
+  xferState = NPITLSPI_XFER_HDR;
+
+  spiTransaction.txBuf = TxActive ? spiTxBuf : NULL;
+  spiTransaction.rxBuf = npiRxBuf;
+  spiTransaction.count = NPI_SPI_MSG_SOF_HDR_LEN;
+
+  if (!SPI_transfer(spiHandle, &spiTransaction))
+  {
+    xferState = NPITLSPI_IDLE;
+  }
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Clock the next part of the payloads. While both sides have
+//!             bytes left they are exchanged full duplex, then the longer side
+//!             is finished alone.
+//!
+//! \return     bool - false if both frames are complete
+// -----------------------------------------------------------------------------
+static bool NPITLSPI_transferNext(void)
+{
+  uint16_t txRem = TxActive ? TransportTxLen - txOffset : 0;
+  uint16_t rxRem = TransportRxLen - rxOffset;
+  uint16_t count;
+
+  if (txRem == 0 && rxRem == 0)
+  {
+    return false;
+  }
+
+  if (txRem && rxRem)
+  {
+    count = MIN(txRem, rxRem);
+  }
+  else
+  {
+    count = MAX(txRem, rxRem);
+  }
+
+  spiTransaction.txBuf = txRem ? &spiTxBuf[txOffset] : NULL;
+  spiTransaction.rxBuf = (rxRem && rxFrameOwned) ?
+                         &npiRxFrame->pData[rxOffset] : NULL;
+  spiTransaction.count = count;
+
+  if (txRem)
+  {
+    txOffset += count;
+  }
+  if (rxRem)
+  {
+    rxOffset += count;
+  }
+
+  return SPI_transfer(spiHandle, &spiTransaction);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This callback is invoked on completion of each SPI_transfer
+//!
+//! \param[in]  handle      - handle to the SPI port
+//! \param[in]  transaction - the completed transaction
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLSPI_transferCallBack(SPI_Handle handle,
+                                      SPI_Transaction *transaction)
+{
+  uint16_t payloadLen;
+  uint16_t rxLen = 0;
+  uint16_t txLen;
+#if (NPI_FLOW_CTRL == 1)
+  uint16_t nextLen;
+  uint8_t *nextBuf;
+#endif // NPI_FLOW_CTRL = 1
+  _npiCSKey_t key;
+  key = NPIUtil_EnterCS();
+
+  if (transaction->status == SPI_TRANSFER_COMPLETED)
+  {
+    if (xferState == NPITLSPI_XFER_HDR)
+    {
+      payloadLen = BUILD_UINT16(npiRxBuf[NPI_SPI_MSG_LEN0_IDX],
+                                npiRxBuf[NPI_SPI_MSG_LEN1_IDX]);
+
+      if (npiRxBuf[NPI_SPI_MSG_SOF_IDX] == NPI_SPI_MSG_SOF &&
+          payloadLen > npiBufSize - NPI_SPI_MSG_HDR_LEN - NPI_MSG_FCS_LENGTH)
+      {
+        // Longer than any packet can be, the header is noise. Clock no more
+        // of it, the slave starts over with the next transaction
+        npiRxOversized++;
+        npiRxDropBytes += NPI_MSG_SOF_LENGTH + NPI_SPI_MSG_HDR_LEN;
+      }
+      else if (npiRxBuf[NPI_SPI_MSG_SOF_IDX] == NPI_SPI_MSG_SOF)
+      {
+        // Slave is sending a frame. Add an extra byte for FCS
+        TransportRxLen = payloadLen + NPI_MSG_FCS_LENGTH;
+
+        // Allocate the frame it will be delivered in, the FCS lands in its
+        // tailroom. Otherwise clock the bytes out but ignore them
+        if (taskCBs.frameAllocCB != NULL && npiRxFrame == NULL &&
+            (npiRxFrame = taskCBs.frameAllocCB(payloadLen)) != NULL)
+        {
+          npiRxFrame->cmd0 = npiRxBuf[NPI_SPI_MSG_CMD0_IDX];
+          npiRxFrame->cmd1 = npiRxBuf[NPI_SPI_MSG_CMD1_IDX];
+          rxFrameOwned = true;
+        }
+      }
+      xferState = NPITLSPI_XFER_BODY;
+    }
+
+    if (NPITLSPI_transferNext())
+    {
+      // Rest of the transaction is in progress
+      NPIUtil_ExitCS(key);
+      return;
+    }
+
+    // Both frames are complete. Check the one received, if any
+    if (TransportRxLen && rxFrameOwned)
+    {
+      payloadLen = TransportRxLen - 1;
+      // Folding the FCS byte in with the rest leaves 0 for an intact frame
+      if (NPIUtil_calcFCS(NPIUtil_calcFCS(0, &npiRxBuf[NPI_SPI_MSG_LEN0_IDX],
+                                          NPI_SPI_MSG_HDR_LEN),
+                          npiRxFrame->pData, TransportRxLen) == 0)
+      {
+        rxLen = NPI_SPI_MSG_HDR_LEN + payloadLen;
+      }
+      else
+      {
+        npiRxFcsErrors++;
+        npiRxDropFrames++;
+        npiRxDropBytes += NPI_SPI_MSG_HDR_LEN + TransportRxLen +
+                          NPI_MSG_SOF_LENGTH;
+      }
+    }
+    else if (TransportRxLen)
+    {
+      // Clocked in with nowhere to put it
+      npiRxDropFrames++;
+      npiRxDropBytes += NPI_SPI_MSG_HDR_LEN + TransportRxLen +
+                        NPI_MSG_SOF_LENGTH;
+    }
+  }
+
+  if (rxLen == 0)
+  {
+    NPITLSPI_dropRxFrame();
+  }
+  // A delivered frame is the NPI Task's to pick up
+  rxFrameOwned = false;
+
+  // A frame cut short by a cancelled transfer is reported anyway and dropped
+  txLen = TxActive ? TransportTxLen : 0;
+  xferState = NPITLSPI_IDLE;
+
+#if (NPI_FLOW_CTRL == 1)
+  // Handshake is still held. Clock the next queued frame, if the TL allows,
+  // instead of paying for another Rem RDY handshake. The TL only moves on to
+  // it once the driver has taken it, and delivers the frame received
+  // alongside, if any, with the completed one
+  if (transaction->status == SPI_TRANSFER_COMPLETED &&
+      TxActive && (nextLen = NPITL_peekCoalesceTx(&nextBuf)) != 0)
+  {
+    spiTxBuf = nextBuf;
+    TransportTxLen = nextLen + NPI_MSG_SOF_LENGTH + NPI_MSG_FCS_LENGTH;
+    NPITLSPI_startTransaction();
+
+    if (xferState != NPITLSPI_IDLE)
+    {
+      NPITL_coalesceTx(rxLen, txLen);
+      NPIUtil_ExitCS(key);
+      return;
+    }
+
+    // Transfer could not be started. End the transaction for the frame that
+    // was clocked out, the next one waits for a handshake of its own
+    spiTxBuf = npiTxBuf;
+    TransportTxLen = txLen;
+  }
+#endif // NPI_FLOW_CTRL = 1
+
+  TxActive = false;
+
+  if (npiTransmitCB)
+  {
+    npiTransmitCB(rxLen, txLen);
+  }
+
+  NPIUtil_ExitCS(key);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Release the frame of a packet that was not delivered. A frame
+//!             from an earlier transaction is left to the NPI Task.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLSPI_dropRxFrame(void)
+{
+  if (rxFrameOwned && npiRxFrame != NULL)
+  {
+    if (taskCBs.frameFreeCB)
+    {
+      taskCBs.frameFreeCB(npiRxFrame);
+    }
+    npiRxFrame = NULL;
+  }
+  rxFrameOwned = false;
+}
@@ -42,6 +42,8 @@ extern "C"
 // includes
 // ****************************************************************************
 
+#include "npi_tl.h"
+
 // ****************************************************************************
 // defines
 // ****************************************************************************
@@ -52,20 +54,14 @@ extern "C"
 // ****************************************************************************
 // typedefs
 // ****************************************************************************
-// -----------------------------------------------------------------------------
-//! \brief      Typedef for call back function mechanism to notify NPI TL that
-//!             an NPI transaction has occurred
-//! \param[in]  rxLen     number of bytes received
-//! \param[in]  txLen     number of bytes transmitted
-//!
-//! \return     void
-// -----------------------------------------------------------------------------
-typedef void (*npiCB_t)(uint16_t rxLen, uint16_t txLen);
 
 //*****************************************************************************
 // globals
 //*****************************************************************************
 
+//! \brief UART transport, selected with NPI_SERIAL_TYPE_UART
+extern const npiTLTransport_t NPITLUART_transport;
+
 //*****************************************************************************
 // function prototypes
 //*****************************************************************************
@@ -80,7 +76,8 @@ typedef void (*npiCB_t)(uint16_t rxLen, uint16_t txLen);
 //!
 //! \return     void
 // -----------------------------------------------------------------------------
-extern void NPITLUART_openTransport(uint8_t portID, UART_Params *portParams,
+extern void NPITLUART_openTransport(uint8_t portID,
+                                    npiInterfaceParams *portParams,
                                     npiCB_t npiCBack);
 
 // -----------------------------------------------------------------------------
@@ -33,11 +33,14 @@
 // ****************************************************************************
 // includes
 // ****************************************************************************
+#include <string.h>
+
 #include "hal_types.h"
 #include "hal_defs.h"
 
 #include "npi_util.h"
 #include "npi_data.h"
+#include "npi_tl.h"
 #include "npi_tl_uart.h"
 #include <ti/drivers/UART.h>
 #include <stdbool.h>
@@ -61,7 +64,8 @@ typedef enum
   NPITLUART_READ_SOF = 0x00,
   NPITLUART_READ_HDR,
   NPITLUART_READ_PLD,
-  NPITLUART_IGNORE
+  NPITLUART_IGNORE,
+  NPITLUART_RESYNC
 } npiTLUart_readState;
 
 // ****************************************************************************
@@ -71,6 +75,22 @@ typedef enum
 //*****************************************************************************
 // globals
 //*****************************************************************************
+//! \brief UART transport, selected with NPI_SERIAL_TYPE_UART
+const npiTLTransport_t NPITLUART_transport =
+{
+  NPITLUART_openTransport,
+  NPITLUART_closeTransport,
+  NPITLUART_readTransport,
+  NPITLUART_writeTransport,
+#if (NPI_FLOW_CTRL == 1)
+  NPITLUART_stopTransfer,
+  NPITLUART_handleRemRdyEvent
+#else
+  NULL,
+  NULL
+#endif // NPI_FLOW_CTRL = 1
+};
+
 //! \brief UART Handle for UART Driver
 static UART_Handle uartHandle;
 
@@ -95,11 +115,38 @@ static uint16_t TransportTxLen = 0;
 //! \brief State of the UART Read Call Back
 static npiTLUart_readState readState = NPITLUART_READ_SOF;
 
+//! \brief FCS of the bytes of the current packet read so far
+static uint8_t rxFCS = 0;
+
+//! \brief Bytes of the current packet still to be read in READ_PLD/IGNORE
+static uint16_t payloadLen = 0;
+
+//! \brief Bytes of the header already in npiRxBuf in READ_HDR
+static uint16_t rxHdrLen = 0;
+
+//! \brief Bytes at the start of npiRxBuf still to be scanned once the packet
+//!        NPITLUART_resync recovered ahead of them has been handed over. No
+//!        read is started into npiRxBuf while there are any, see
+//!        NPITLUART_readNext
+static uint16_t rxPendingLen = 0;
+
 //! \brief NPI Transport Layer Buffer variables defined in npi_tl.c
 extern uint8_t *npiRxBuf;
 extern uint8_t *npiTxBuf;
 extern uint16_t npiBufSize;
 
+//! \brief Frame the current payload is read into, defined in npi_tl.c
+extern _npiFrame_t *npiRxFrame;
+
+//! \brief NPI Task call backs used to allocate npiRxFrame, defined in npi_tl.c
+extern npiTLCallBacks taskCBs;
+
+//! \brief Receive drop counters, defined in npi_tl.c
+extern uint32_t npiRxDropBytes;
+extern uint32_t npiRxDropFrames;
+extern uint32_t npiRxFcsErrors;
+extern uint32_t npiRxOversized;
+
 //*****************************************************************************
 // function prototypes
 //*****************************************************************************
@@ -113,8 +160,24 @@ static void NPITLUART_readCallBack(UART_Handle handle, void *ptr, size_t size);
 //! \brief Check for whether a complete and valid packet has been received
 static uint8_t NPITLUART_validPacketFound();
 
-//! \brief Calculate FCS over the given length of buf
-static uint8_t NPITLUART_calcFCS(uint8_t *buf, uint16_t len);
+//! \brief Release npiRxFrame after an incomplete or invalid packet
+static void NPITLUART_dropRxFrame(void);
+
+//! \brief Allocate npiRxFrame for the header in npiRxBuf and read the rest
+static void NPITLUART_readPayload(uint16_t have);
+
+//! \brief Hand a complete and valid packet to the NPI TL
+static void NPITLUART_rxComplete(void);
+
+//! \brief Scan bytes received in npiRxBuf for the next valid packet
+static void NPITLUART_resync(uint16_t len);
+
+//! \brief Read the bytes already received for NPITLUART_resync
+static void NPITLUART_readResync(void);
+
+//! \brief Scan bytes left behind by NPITLUART_resync, else read the next SOF
+static void NPITLUART_readNext(void);
+
 
 // -----------------------------------------------------------------------------
 //! \brief      This routine initializes the transport layer and opens the port
@@ -126,17 +189,18 @@ static uint8_t NPITLUART_calcFCS(uint8_t *buf, uint16_t len);
 //!
 //! \return     void
 // -----------------------------------------------------------------------------
-void NPITLUART_openTransport(uint8_t portID, UART_Params *portParams,
+void NPITLUART_openTransport(uint8_t portID, npiInterfaceParams *portParams,
                              npiCB_t npiCBack)
 {
   npiTransmitCB = npiCBack;
+  rxPendingLen = 0;
 
   // Add call backs UART parameters.
-  portParams->readCallback = NPITLUART_readCallBack;
-  portParams->writeCallback = NPITLUART_writeCallBack;
+  portParams->uartParams.readCallback = NPITLUART_readCallBack;
+  portParams->uartParams.writeCallback = NPITLUART_writeCallBack;
 
   // Open / power on the UART.
-  uartHandle = UART_open(portID, portParams);
+  uartHandle = UART_open(portID, &portParams->uartParams);
 }
 
 // -----------------------------------------------------------------------------
@@ -148,6 +212,8 @@ void NPITLUART_closeTransport(void)
 {
   UART_readCancel(uartHandle);
   UART_close(uartHandle);
+  readState = NPITLUART_READ_SOF;
+  rxPendingLen = 0;
 }
 
 #if (NPI_FLOW_CTRL == 1)
@@ -217,12 +283,33 @@ void NPITLUART_writeCallBack(UART_Handle handle, void *ptr, size_t size)
 {
 #if (NPI_FLOW_CTRL == 1)
   bool bytesAvail;
+  uint16_t nextLen;
+  uint8_t *nextBuf;
 #endif
 
   _npiCSKey_t key;
   key = NPIUtil_EnterCS();
 
 #if (NPI_FLOW_CTRL == 1)
+  // Handshake is still held. Write the next queued frame, if the TL allows,
+  // back to back instead of paying for another Rem RDY handshake. The TL
+  // only moves on to it once the driver has taken it
+  if (TxActive && (nextLen = NPITL_peekCoalesceTx(&nextBuf)) != 0)
+  {
+    nextLen += NPI_MSG_SOF_LENGTH + NPI_MSG_FCS_LENGTH;
+
+    if (UART_write(uartHandle, nextBuf, nextLen) != UART_ERROR)
+    {
+      NPITL_coalesceTx(0, TransportTxLen);
+      TransportTxLen = nextLen;
+      NPIUtil_ExitCS(key);
+      return;
+    }
+
+    // Write could not be started. End the transaction for the frame that
+    // was written, the next one waits for a handshake of its own
+  }
+
   UART_control(uartHandle, UART_CMD_GETRXCOUNT, &bytesAvail);
 
   if ((bytesAvail == false && RxActive == true && readState == NPITLUART_READ_SOF)
@@ -234,9 +321,8 @@ void NPITLUART_writeCallBack(UART_Handle handle, void *ptr, size_t size)
   /* Handling a finished Rx transaction */
   if(RxActive == false && TransportRxLen > 0)
   {
-    TransportRxLen = 0;
     readState = NPITLUART_READ_SOF;
-    UART_read(uartHandle, npiRxBuf, NPI_UART_MSG_SOF_LEN);
+    NPITLUART_readNext();
   }
 
   TxActive = false;
@@ -262,7 +348,7 @@ void NPITLUART_writeCallBack(UART_Handle handle, void *ptr, size_t size)
 // -----------------------------------------------------------------------------
 void NPITLUART_readCallBack(UART_Handle handle, void *ptr, size_t size)
 {
-  static uint16_t payloadLen = 0;
+  uint16_t len;
   _npiCSKey_t key;
   key = NPIUtil_EnterCS();
 
@@ -273,78 +359,64 @@ void NPITLUART_readCallBack(UART_Handle handle, void *ptr, size_t size)
       if (size == NPI_UART_MSG_SOF_LEN && npiRxBuf[0] == NPI_UART_MSG_SOF)
       {
         // Recevied SOF, Read HDR next. Do not save SOF byte
+        rxHdrLen = 0;
         UART_read(uartHandle, npiRxBuf, NPI_UART_MSG_HDR_LEN);
         readState = NPITLUART_READ_HDR;
       }
+      else if (size)
+      {
+        // Line noise. Look for the SOF in everything received since
+        npiRxDropBytes += size;
+        NPITLUART_readResync();
+      }
       break;
 
     case NPITLUART_READ_HDR:
-      if (size == NPI_UART_MSG_HDR_LEN)
+      rxHdrLen += size;
+      if (size == 0)
       {
-        // Header has been read. Increment RxLen
-        TransportRxLen += size;
-
-        // Determine length of remainder of packet, add an extra byte for FCS
-        payloadLen = BUILD_UINT16(npiRxBuf[0],npiRxBuf[1]) + 1;
-
-        // Check to see if payload can fit in the remainder of the RxBuf
-        if (payloadLen <= npiBufSize - TransportRxLen)
-        {
-          // Read remainder of packet
-          UART_read(uartHandle, &npiRxBuf[TransportRxLen], payloadLen);
-          readState = NPITLUART_READ_PLD;
-        }
-        else
-        {
-          // Read remainder of packet bytes but ignore them
-          UART_read(uartHandle, npiRxBuf, npiBufSize);
-          readState = NPITLUART_IGNORE;
-        }
+        // Read was cancelled
+        readState = NPITLUART_READ_SOF;
+      }
+      else if (rxHdrLen == NPI_UART_MSG_HDR_LEN)
+      {
+        // Header has been read
+        TransportRxLen = NPI_UART_MSG_HDR_LEN;
+        NPITLUART_readPayload(0);
       }
       else
       {
-        // Error has occured. Reset read state
-        readState = NPITLUART_READ_SOF;
+        // Header cut short, so the SOF was not one
+        npiRxDropBytes += NPI_UART_MSG_SOF_LEN;
+        NPITLUART_resync(rxHdrLen);
       }
     break;
 
     case NPITLUART_READ_PLD:
-      if (payloadLen == size)
-      {
-        // All bytes are read
-        TransportRxLen += size;
+      // Bytes following the SOF that were received
+      TransportRxLen += size;
+      len = TransportRxLen;
 
-        // Check if FCS is valid
-        if (NPITLUART_validPacketFound() == NPI_SUCCESS)
+      // Check if all bytes are read and FCS is valid
+      if (payloadLen == size && NPITLUART_validPacketFound() == NPI_SUCCESS)
+      {
+        NPITLUART_rxComplete();
+      }
+      else
+      {
+        // A valid packet may start inside the bytes of this one. Put them
+        // behind its header and scan them
+        if (payloadLen == size)
         {
-          // Valid Packet. Decrement RxLen to not include FCS since it is
-          // checked and valid
-          TransportRxLen--;
-
-#if (NPI_FLOW_CTRL == 1)
-          RxActive = false;
-
-          // If TX has also completed then we are safe to issue call back
-          if (!TxActive && npiTransmitCB)
-          {
-            npiTransmitCB(TransportRxLen,TransportTxLen);
-          }
-          else
-          {
-            NPIUtil_ExitCS(key);
-            return;
-          }
-#else
-          if (npiTransmitCB)
-          {
-            npiTransmitCB(TransportRxLen,0);
-          }
-#endif // NPI_FLOW_CTRL = 1
+          npiRxFcsErrors++;
         }
+        npiRxDropFrames++;
+        npiRxDropBytes += NPI_UART_MSG_SOF_LEN;
+        memcpy(&npiRxBuf[NPI_UART_MSG_HDR_LEN], npiRxFrame->pData,
+               len - NPI_UART_MSG_HDR_LEN);
+        NPITLUART_dropRxFrame();
+        NPITLUART_resync(len);
       }
-
-      // Reset State. Full packet has been read or error has occurred
-      readState = NPITLUART_READ_SOF;
       break;
 
     case NPITLUART_IGNORE:
@@ -369,6 +441,18 @@ void NPITLUART_readCallBack(UART_Handle handle, void *ptr, size_t size)
       }
       break;
 
+    case NPITLUART_RESYNC:
+      if (size)
+      {
+        NPITLUART_resync(size);
+      }
+      else
+      {
+        // Read was cancelled
+        readState = NPITLUART_READ_SOF;
+      }
+      break;
+
     default:
       // Should not get here. If so reset read state
       readState = NPITLUART_READ_SOF;
@@ -379,8 +463,7 @@ void NPITLUART_readCallBack(UART_Handle handle, void *ptr, size_t size)
   // Initiate next read of SOF byte
   if (readState == NPITLUART_READ_SOF)
   {
-    TransportRxLen = 0;
-    UART_read(uartHandle, npiRxBuf, NPI_UART_MSG_SOF_LEN);
+    NPITLUART_readNext();
   }
 #endif // NPI_FLOW_CTRL = 0
 
@@ -401,10 +484,8 @@ void NPITLUART_readTransport(void)
   RxActive = true;
 #endif // NPI_FLOW_CTRL = 1
 
-  TransportRxLen = 0;
-
   // UART driver will automatically reject this read if already in use
-  UART_read(uartHandle, npiRxBuf, NPI_UART_MSG_SOF_LEN);
+  NPITLUART_readNext();
 
   NPIUtil_ExitCS(key);
 }
@@ -422,9 +503,7 @@ uint16_t NPITLUART_writeTransport(uint16_t len)
   _npiCSKey_t key;
   key = NPIUtil_EnterCS();
 
-  npiTxBuf[NPI_UART_MSG_SOF_IDX] = NPI_UART_MSG_SOF;
-  npiTxBuf[len + 1] = NPITLUART_calcFCS((uint8_t *)&npiTxBuf[1],len);
-  TransportTxLen = len + 2;
+  TransportTxLen = len + NPI_MSG_SOF_LENGTH + NPI_MSG_FCS_LENGTH;
 
 #if (NPI_FLOW_CTRL == 1)
   TxActive = true;
@@ -459,22 +538,22 @@ uint16_t NPITLUART_writeTransport(uint16_t len)
 uint8_t NPITLUART_validPacketFound(void)
 {
   uint16_t payloadLen;
-  uint8_t fcs;
 
   // SOF has already been removed from npiRxBuf
   payloadLen = (uint16) npiRxBuf[0];
   payloadLen += ((uint16) npiRxBuf[1]) << 8;
 
   // Check to make sure we have received all bytes of this message
-  if (TransportRxLen < (payloadLen + NPI_UART_MSG_NON_PAYLOAD_LEN))
+  if (TransportRxLen < (payloadLen + NPI_UART_MSG_NON_PAYLOAD_LEN) ||
+      npiRxFrame == NULL)
   {
     return NPI_INCOMPLETE_PKT;
   }
 
-  // Calculate FCS of this message
-  fcs = NPITLUART_calcFCS((uint8_t *)npiRxBuf, payloadLen + NPI_UART_MSG_HDR_LEN);
-
-  if (fcs != npiRxBuf[payloadLen + NPI_UART_MSG_HDR_LEN])
+  // rxFCS already covers the header. Folding in the payload and the FCS
+  // byte itself leaves 0 for an intact packet
+  if (NPIUtil_calcFCS(rxFCS, npiRxFrame->pData,
+                      payloadLen + NPI_MSG_FCS_LENGTH) != 0)
   {
     // Invalid FCS, Flush RX buffer before returning error
     TransportRxLen = 0;
@@ -486,22 +565,254 @@ uint8_t NPITLUART_validPacketFound(void)
 }
 
 // -----------------------------------------------------------------------------
-//! \brief      Calculate FCS over the given length of buf
+//! \brief      Release the frame of a packet that was not delivered
 //!
-//! \param[in]  buf - Pointer to first byte to use for FCS
-//!             len - Number of bytes to calculate FCS over.
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLUART_dropRxFrame(void)
+{
+  if (npiRxFrame != NULL)
+  {
+    if (taskCBs.frameFreeCB)
+    {
+      taskCBs.frameFreeCB(npiRxFrame);
+    }
+    npiRxFrame = NULL;
+  }
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Allocate npiRxFrame for the header in npiRxBuf and read the
+//!             rest of the packet straight into it. A header longer than any
+//!             packet can be means the SOF was noise and the bytes are
+//!             rescanned. Packets there is no frame for are read and ignored.
 //!
-//! \return     uint8_t - FCS value
+//! \param[in]  have - Bytes of payload already in npiRxBuf behind the header,
+//!                    fewer than the packet has
+//!
+//! \return     void
 // -----------------------------------------------------------------------------
-uint8_t NPITLUART_calcFCS(uint8_t *buf, uint16_t len)
+static void NPITLUART_readPayload(uint16_t have)
 {
-    uint16_t i;
-    uint8_t fcs = 0;
+  // Check to see if payload fits the max packet size
+  if (BUILD_UINT16(npiRxBuf[0],npiRxBuf[1]) >
+      npiBufSize - NPI_UART_MSG_NON_PAYLOAD_LEN)
+  {
+    npiRxOversized++;
+    npiRxDropBytes += NPI_UART_MSG_SOF_LEN;
+    NPITLUART_resync(NPI_UART_MSG_HDR_LEN + have);
+    return;
+  }
+
+  // Determine length of remainder of packet, add an extra byte for FCS
+  payloadLen = BUILD_UINT16(npiRxBuf[0],npiRxBuf[1]) + NPI_MSG_FCS_LENGTH;
+  rxFCS = NPIUtil_calcFCS(0, npiRxBuf, NPI_UART_MSG_HDR_LEN);
 
-    for (i = 0; i < len; i++)
+  // Allocate the frame it will be delivered in. The FCS lands in its
+  // tailroom.
+  if (taskCBs.frameAllocCB != NULL && npiRxFrame == NULL &&
+      (npiRxFrame = taskCBs.frameAllocCB(payloadLen -
+                                         NPI_MSG_FCS_LENGTH)) != NULL)
+  {
+    npiRxFrame->cmd0 = npiRxBuf[2];
+    npiRxFrame->cmd1 = npiRxBuf[3];
+    memcpy(npiRxFrame->pData, &npiRxBuf[NPI_UART_MSG_HDR_LEN], have);
+    TransportRxLen = NPI_UART_MSG_HDR_LEN + have;
+    payloadLen -= have;
+
+    // Read remainder of packet straight into the frame
+    UART_read(uartHandle, &npiRxFrame->pData[have], payloadLen);
+    readState = NPITLUART_READ_PLD;
+  }
+  else
+  {
+    npiRxDropFrames++;
+    npiRxDropBytes += NPI_UART_MSG_NON_PAYLOAD_LEN + payloadLen;
+    payloadLen -= have;
+
+    // Read remainder of packet bytes but ignore them
+    UART_read(uartHandle, npiRxBuf,
+              (payloadLen > npiBufSize) ? npiBufSize : payloadLen);
+    readState = NPITLUART_IGNORE;
+  }
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Hand a complete packet, FCS checked, to the NPI TL
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLUART_rxComplete(void)
+{
+  // Decrement RxLen to not include FCS since it is checked and valid
+  TransportRxLen--;
+
+#if (NPI_FLOW_CTRL == 1)
+  RxActive = false;
+
+  // If TX has also completed then we are safe to issue call back. Otherwise
+  // the write call back does once it is done.
+  if (!TxActive && npiTransmitCB)
+  {
+    npiTransmitCB(TransportRxLen,TransportTxLen);
+    readState = NPITLUART_READ_SOF;
+  }
+#else
+  if (npiTransmitCB)
+  {
+    npiTransmitCB(TransportRxLen,0);
+  }
+  readState = NPITLUART_READ_SOF;
+#endif // NPI_FLOW_CTRL = 1
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Scan bytes received where a packet was expected for the next
+//!             SOF and check the packet behind it. A packet that was fully
+//!             received is checked and delivered from npiRxBuf, and the scan
+//!             goes on behind it once it has been handed over. One that is
+//!             still arriving is read on as usual. Bytes skipped because
+//!             they do not start a valid packet are counted in
+//!             npiRxDropBytes.
+//!
+//! \param[in]  len - Number of bytes at the start of npiRxBuf to scan
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLUART_resync(uint16_t len)
+{
+  uint16_t i;
+  uint16_t frameLen;
+
+  while (len)
+  {
+    // Hunt for the next SOF
+    for (i = 0; i < len && npiRxBuf[i] != NPI_UART_MSG_SOF; i++)
     {
-        fcs ^= buf[i];
+    }
+    npiRxDropBytes += i;
+    if (i == len)
+    {
+      break;
+    }
+
+    // Candidate packet, move the bytes behind its SOF to the front
+    len -= i + NPI_UART_MSG_SOF_LEN;
+    memmove(npiRxBuf, &npiRxBuf[i + NPI_UART_MSG_SOF_LEN], len);
+
+    if (len < NPI_UART_MSG_HDR_LEN)
+    {
+      // Rest of the header is still on its way
+      rxHdrLen = len;
+      UART_read(uartHandle, &npiRxBuf[len], NPI_UART_MSG_HDR_LEN - len);
+      readState = NPITLUART_READ_HDR;
+      return;
     }
 
-    return fcs;
+    if (BUILD_UINT16(npiRxBuf[0],npiRxBuf[1]) >
+        npiBufSize - NPI_UART_MSG_NON_PAYLOAD_LEN)
+    {
+      // Longer than any packet can be, the SOF was noise
+      npiRxOversized++;
+      npiRxDropBytes += NPI_UART_MSG_SOF_LEN;
+      continue;
+    }
+    frameLen = BUILD_UINT16(npiRxBuf[0],npiRxBuf[1]) +
+               NPI_UART_MSG_NON_PAYLOAD_LEN;
+
+    if (frameLen > len)
+    {
+      // Packet continues on the wire
+      NPITLUART_readPayload(len - NPI_UART_MSG_HDR_LEN);
+      return;
+    }
+
+    // Whole packet is here. Check it before taking it
+    if (NPIUtil_calcFCS(0, npiRxBuf, frameLen) != 0)
+    {
+      npiRxFcsErrors++;
+    }
+    else if (taskCBs.frameAllocCB != NULL && npiRxFrame == NULL &&
+             (npiRxFrame = taskCBs.frameAllocCB(frameLen -
+                                      NPI_UART_MSG_NON_PAYLOAD_LEN)) != NULL)
+    {
+      npiRxFrame->cmd0 = npiRxBuf[2];
+      npiRxFrame->cmd1 = npiRxBuf[3];
+      memcpy(npiRxFrame->pData, &npiRxBuf[NPI_UART_MSG_HDR_LEN],
+             frameLen - NPI_UART_MSG_HDR_LEN);
+
+      // Keep what follows, more packets may have been received behind it
+      len -= frameLen;
+      memmove(npiRxBuf, &npiRxBuf[frameLen], len);
+      TransportRxLen = frameLen;
+      NPITLUART_rxComplete();
+
+      if (npiRxFrame != NULL)
+      {
+        // Not taken yet, e.g. held until the write of this handshake is
+        // done. The rest is scanned when the next read is started
+        rxPendingLen = len;
+        return;
+      }
+      continue;
+    }
+
+    // Bad FCS or nowhere to put it. Scan on from the byte after the SOF
+    npiRxDropFrames++;
+    npiRxDropBytes += NPI_UART_MSG_SOF_LEN;
+  }
+
+  NPITLUART_readResync();
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Start reading the next packet. Bytes NPITLUART_resync left
+//!             behind a recovered packet are scanned first, as a read into
+//!             npiRxBuf would overwrite them. If that packet has still not
+//!             been taken, the packets behind it are dropped and counted.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLUART_readNext(void)
+{
+  uint16_t len = rxPendingLen;
+
+  TransportRxLen = 0;
+
+  if (len)
+  {
+    rxPendingLen = 0;
+    NPITLUART_resync(len);
+  }
+  else
+  {
+    UART_read(uartHandle, npiRxBuf, NPI_UART_MSG_SOF_LEN);
+  }
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Read everything the UART driver has buffered into npiRxBuf in
+//!             one go for NPITLUART_resync. If nothing is buffered, wait for
+//!             the next SOF.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITLUART_readResync(void)
+{
+  int avail = 0;
+
+  TransportRxLen = 0;
+  UART_control(uartHandle, UART_CMD_GETRXCOUNT, &avail);
+
+  if (avail > 0)
+  {
+    readState = NPITLUART_RESYNC;
+    UART_read(uartHandle, npiRxBuf,
+              (avail > npiBufSize) ? npiBufSize : avail);
+  }
+  else
+  {
+    readState = NPITLUART_READ_SOF;
+    UART_read(uartHandle, npiRxBuf, NPI_UART_MSG_SOF_LEN);
+  }
 }
@@ -38,6 +38,7 @@
 #include <ti/sysbios/knl/Task.h>
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Queue.h>
+#include <string.h>
 #include "npi_util.h"
 
 // -----------------------------------------------------------------------------
@@ -182,3 +183,206 @@ uint8_t *NPIUtil_dequeueMsg(Queue_Handle msgQueue)
 
   return NULL;
 }
+
+// -----------------------------------------------------------------------------
+//! \brief   Initialize an empty ring over caller provided slots.
+//!
+//! \param   ring - pointer to ring to initialize.
+//! \param   slots - array of size pointers the ring holds its entries in.
+//! \param   size - number of slots, a power of 2.
+//!
+//! \return  void
+// -----------------------------------------------------------------------------
+void NPIUtil_ringInit(_npiRing_t *ring, void **slots, uint16_t size)
+{
+  ring->slots = (void * volatile *)slots;
+  ring->size = size;
+  ring->head = 0;
+  ring->tail = 0;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief   Adds an entry at the tail of a ring. Producer side only.
+//!
+//! \param   ring - pointer to ring.
+//! \param   pData - entry to add.
+//!
+//! \return  Number of entries in the ring after adding pData, 0 if it was
+//!          full and pData was not added.
+// -----------------------------------------------------------------------------
+uint16_t NPIUtil_ringPut(_npiRing_t *ring, void *pData)
+{
+  uint16_t tail = ring->tail;
+  uint16_t count = (uint16_t)(tail - ring->head);
+
+  if (count == ring->size)
+  {
+    return 0;
+  }
+
+  // The slot is written before tail moves on, both through volatile
+  // accesses, so the consumer never sees the slot before it is filled
+  ring->slots[tail & (ring->size - 1)] = pData;
+  ring->tail = tail + 1;
+
+  return count + 1;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief   Removes the entry at the head of a ring. Consumer side only.
+//!
+//! \param   ring - pointer to ring.
+//!
+//! \return  The entry removed, NULL if the ring was empty.
+// -----------------------------------------------------------------------------
+void *NPIUtil_ringGet(_npiRing_t *ring)
+{
+  uint16_t head = ring->head;
+  void *pData;
+
+  if (head == ring->tail)
+  {
+    return NULL;
+  }
+
+  // The slot is read before head moves on and hands it back to the producer
+  pData = ring->slots[head & (ring->size - 1)];
+  ring->head = head + 1;
+
+  return pData;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief   Number of entries in a ring. May be called from either side, or
+//!          anywhere else, for a snapshot.
+//!
+//! \param   ring - pointer to ring.
+//!
+//! \return  Number of entries in the ring.
+// -----------------------------------------------------------------------------
+uint16_t NPIUtil_ringCount(_npiRing_t *ring)
+{
+  return (uint16_t)(ring->tail - ring->head);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief   Atomically ORs bits into a word shared with ISRs.
+//!
+//! \param   pWord - word to update.
+//! \param   bits - bits to set.
+//!
+//! \return  Value of the word before the update.
+// -----------------------------------------------------------------------------
+uint32_t NPIUtil_atomicOr(volatile uint32_t *pWord, uint32_t bits)
+{
+#if defined(__GNUC__)
+  // Exclusive load/store on the Cortex-M, interrupts stay enabled
+  return __atomic_fetch_or(pWord, bits, __ATOMIC_SEQ_CST);
+#else
+  UInt key = Hwi_disable();
+  uint32_t old = *pWord;
+
+  *pWord = old | bits;
+  Hwi_restore(key);
+
+  return old;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+//! \brief   Atomically adds to a word shared with ISRs.
+//!
+//! \param   pWord - word to update.
+//! \param   val - amount to add.
+//!
+//! \return  Value of the word before the update.
+// -----------------------------------------------------------------------------
+uint32_t NPIUtil_atomicAdd(volatile uint32_t *pWord, uint32_t val)
+{
+#if defined(__GNUC__)
+  return __atomic_fetch_add(pWord, val, __ATOMIC_SEQ_CST);
+#else
+  UInt key = Hwi_disable();
+  uint32_t old = *pWord;
+
+  *pWord = old + val;
+  Hwi_restore(key);
+
+  return old;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+//! \brief   Atomically replaces a word shared with ISRs.
+//!
+//! \param   pWord - word to update.
+//! \param   val - new value.
+//!
+//! \return  Value of the word before the update.
+// -----------------------------------------------------------------------------
+uint32_t NPIUtil_atomicSwap(volatile uint32_t *pWord, uint32_t val)
+{
+#if defined(__GNUC__)
+  return __atomic_exchange_n(pWord, val, __ATOMIC_SEQ_CST);
+#else
+  UInt key = Hwi_disable();
+  uint32_t old = *pWord;
+
+  *pWord = val;
+  Hwi_restore(key);
+
+  return old;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+//! \brief   Folds len bytes of buf into a running NPI frame check sequence.
+//!
+//! \param   fcs - FCS of the bytes folded so far, 0 to start a frame
+//! \param   buf - pointer to first byte to fold in
+//! \param   len - number of bytes to fold in
+//!
+//! \return  FCS including the bytes of buf
+// -----------------------------------------------------------------------------
+uint8_t NPIUtil_calcFCS(uint8_t fcs, const uint8_t *buf, uint16_t len)
+{
+  uint32_t word[4];
+  uint32_t acc = 0;
+
+  // Bytes up to the first word boundary
+  while (len && ((uintptr_t)buf & (sizeof(uint32_t) - 1)))
+  {
+    fcs ^= *buf++;
+    len--;
+  }
+
+  // XOR is bytewise, so whole words are XORed together and their four
+  // bytes folded into the FCS once at the end. Words are loaded through
+  // memcpy, which compiles to plain aligned loads without breaking strict
+  // aliasing on the frame buffers
+  while (len >= sizeof(word))
+  {
+    memcpy(word, buf, sizeof(word));
+    acc ^= word[0] ^ word[1] ^ word[2] ^ word[3];
+    buf += sizeof(word);
+    len -= sizeof(word);
+  }
+  while (len >= sizeof(uint32_t))
+  {
+    memcpy(word, buf, sizeof(uint32_t));
+    acc ^= word[0];
+    buf += sizeof(uint32_t);
+    len -= sizeof(uint32_t);
+  }
+  acc ^= acc >> 16;
+  acc ^= acc >> 8;
+  fcs ^= (uint8_t)acc;
+
+  // Trailing bytes
+  while (len--)
+  {
+    fcs ^= *buf++;
+  }
+
+  return fcs;
+}
@@ -48,6 +48,7 @@ extern "C"
 #include <stdlib.h>
 #endif //USE_ICALL
 
+#include <stdint.h>
 #include <ti/sysbios/knl/Queue.h>
 #ifdef ICALL_EVENTS
 #include <ti/sysbios/knl/Event.h>
@@ -78,6 +79,18 @@ typedef struct _npiCSKey_t
     uint_least16_t taskkey;
 } _npiCSKey_t;
 
+//! \brief Single producer, single consumer ring of pointers. Only the
+//!        producer writes tail and only the consumer writes head, so neither
+//!        side needs a critical section as long as each side has a single
+//!        context at a time. size must be a power of 2.
+typedef struct _npiRing_t
+{
+    void * volatile     *slots;
+    uint16_t            size;
+    volatile uint16_t   head;
+    volatile uint16_t   tail;
+} _npiRing_t;
+
 //*****************************************************************************
 // globals
 //*****************************************************************************
@@ -143,6 +156,91 @@ extern uint8_t NPIUtil_enqueueMsg(Queue_Handle msgQueue,
 // -----------------------------------------------------------------------------
 extern uint8_t * NPIUtil_dequeueMsg(Queue_Handle msgQueue);
 
+// -----------------------------------------------------------------------------
+//! \brief   Initialize an empty ring over caller provided slots.
+//!
+//! \param   ring - pointer to ring to initialize.
+//! \param   slots - array of size pointers the ring holds its entries in.
+//! \param   size - number of slots, a power of 2.
+//!
+//! \return  void
+// -----------------------------------------------------------------------------
+extern void NPIUtil_ringInit(_npiRing_t *ring, void **slots, uint16_t size);
+
+// -----------------------------------------------------------------------------
+//! \brief   Adds an entry at the tail of a ring. Producer side only.
+//!
+//! \param   ring - pointer to ring.
+//! \param   pData - entry to add.
+//!
+//! \return  Number of entries in the ring after adding pData, 0 if it was
+//!          full and pData was not added.
+// -----------------------------------------------------------------------------
+extern uint16_t NPIUtil_ringPut(_npiRing_t *ring, void *pData);
+
+// -----------------------------------------------------------------------------
+//! \brief   Removes the entry at the head of a ring. Consumer side only.
+//!
+//! \param   ring - pointer to ring.
+//!
+//! \return  The entry removed, NULL if the ring was empty.
+// -----------------------------------------------------------------------------
+extern void *NPIUtil_ringGet(_npiRing_t *ring);
+
+// -----------------------------------------------------------------------------
+//! \brief   Number of entries in a ring. May be called from either side, or
+//!          anywhere else, for a snapshot.
+//!
+//! \param   ring - pointer to ring.
+//!
+//! \return  Number of entries in the ring.
+// -----------------------------------------------------------------------------
+extern uint16_t NPIUtil_ringCount(_npiRing_t *ring);
+
+// -----------------------------------------------------------------------------
+//! \brief   Atomically ORs bits into a word shared with ISRs.
+//!
+//! \param   pWord - word to update.
+//! \param   bits - bits to set.
+//!
+//! \return  Value of the word before the update.
+// -----------------------------------------------------------------------------
+extern uint32_t NPIUtil_atomicOr(volatile uint32_t *pWord, uint32_t bits);
+
+// -----------------------------------------------------------------------------
+//! \brief   Atomically adds to a word shared with ISRs.
+//!
+//! \param   pWord - word to update.
+//! \param   val - amount to add.
+//!
+//! \return  Value of the word before the update.
+// -----------------------------------------------------------------------------
+extern uint32_t NPIUtil_atomicAdd(volatile uint32_t *pWord, uint32_t val);
+
+// -----------------------------------------------------------------------------
+//! \brief   Atomically replaces a word shared with ISRs.
+//!
+//! \param   pWord - word to update.
+//! \param   val - new value.
+//!
+//! \return  Value of the word before the update.
+// -----------------------------------------------------------------------------
+extern uint32_t NPIUtil_atomicSwap(volatile uint32_t *pWord, uint32_t val);
+
+// -----------------------------------------------------------------------------
+//! \brief   Folds len bytes of buf into a running NPI frame check sequence.
+//!          The FCS is the XOR of every byte after the SOF, so a frame folded
+//!          together with its FCS byte comes out as 0. Works a machine word
+//!          at a time once buf is word aligned.
+//!
+//! \param   fcs - FCS of the bytes folded so far, 0 to start a frame
+//! \param   buf - pointer to first byte to fold in
+//! \param   len - number of bytes to fold in
+//!
+//! \return  FCS including the bytes of buf
+// -----------------------------------------------------------------------------
+extern uint8_t NPIUtil_calcFCS(uint8_t fcs, const uint8_t *buf, uint16_t len);
+
 #ifdef __cplusplus
 }
 #endif
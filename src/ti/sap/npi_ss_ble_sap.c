@@ -37,6 +37,7 @@
 #include <string.h>
 
 #include "snp.h"
+#include "snp_codec.h"
 #include "snp_rpc.h"
 #include "snp_rpc_synchro.h"
 
@@ -61,6 +62,7 @@
 // Defined in snp_rpc.c
 extern SNP_RPC_eventCBRouter_t SNP_eventCB;
 extern SNP_RPC_asyncCB_t SNP_asyncCB;
+extern SNP_RPC_fastWriteCB_t SNP_fastWriteCB;
 
 extern snpSyncRspData_t npiRetMsg;
 
@@ -94,6 +96,31 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
 {
   uint16_t msgLen = pNPIMsg->dataLen;
 
+#ifndef SNP_LOCAL
+  // The NP answers a request it does not know with an error indication in
+  // place of the response, framed as one so its NPI closes the transaction.
+  if (pNPIMsg->cmd0 == SNP_NPI_SYNC_RSP_TYPE &&
+      pNPIMsg->cmd1 == SNP_SYNC_ERROR_CMD_IND && npiRetMsg.opcode)
+  {
+    npiRetMsg.status = SNP_CMD_REJECTED;
+    npiRetMsg.len = 0;
+    SNP_RPC_syncRspReceived();
+    NPITask_freeFrame(pNPIMsg);
+    return;
+  }
+
+  // Only the response the pending request waits for is copied and signalled.
+  // Any other answers a request that has timed out since, the NPI Task keeps
+  // waiting for the real one.
+  if (pNPIMsg->cmd0 == SNP_NPI_SYNC_RSP_TYPE &&
+      pNPIMsg->cmd1 != npiRetMsg.opcode)
+  {
+    NPITask_rejectSyncRsp();
+    NPITask_freeFrame(pNPIMsg);
+    return;
+  }
+#endif //SNP_LOCAL
+
   switch(SNP_GET_OPCODE_HDR_CMD1(pNPIMsg->cmd1))
   {
     /* Device group */
@@ -104,7 +131,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
 #ifndef SNP_LOCAL
           // NP is powered up indication.
           case SNP_POWER_UP_IND:
-            // Device has restarted.
+            // Device has restarted, requests cancelled before go unanswered.
+            NPITask_remoteReset();
             if (SNP_asyncCB)
             {
               SNP_asyncCB(pNPIMsg->cmd1, NULL, msgLen);
@@ -118,9 +146,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->maskEventCnf.maskedEvent =
-                BUILD_UINT16(pNPIMsg->pData[0],pNPIMsg->pData[1]);
+              SNP_unpackMaskEventRsp(pNPIMsg->pData,
+                                     &npiRetMsg.pMsg->maskEventCnf);
             }
             break;
 
@@ -129,13 +156,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->revisionRsp.status = pNPIMsg->pData[0];
-              npiRetMsg.pMsg->revisionRsp.snpVer =
-                      BUILD_UINT16(pNPIMsg->pData[1],pNPIMsg->pData[2]);
-              memcpy(npiRetMsg.pMsg->revisionRsp.stackBuildVer,
-                     &pNPIMsg->pData[3],
-                     sizeof(npiRetMsg.pMsg->revisionRsp.stackBuildVer));
+              SNP_unpackGetRevisionRsp(pNPIMsg->pData,
+                                       &npiRetMsg.pMsg->revisionRsp);
             }
             break;
 
@@ -144,12 +166,17 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->randRsp.rand = BUILD_UINT32(pNPIMsg->pData[0],
-                                                          pNPIMsg->pData[1],
-                                                          pNPIMsg->pData[2],
-                                                          pNPIMsg->pData[3]);
+              SNP_unpackGetRandRsp(pNPIMsg->pData, &npiRetMsg.pMsg->randRsp);
+            }
+            break;
 
+          case SNP_SET_PORT_BIT_RATE_RSP:
+            if ( npiRetMsg.pMsg )
+            {
+              npiRetMsg.len = msgLen;
+
+              SNP_unpackSetPortBitRateRsp(pNPIMsg->pData,
+                                          &npiRetMsg.pMsg->setPortBitRateRsp);
             }
             break;
 
@@ -158,10 +185,9 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               snpHciCmdRsp_t hciRsp;
 
-              // Initialize Response Struct
-              hciRsp.status = pNPIMsg->pData[0];
-              hciRsp.opcode = BUILD_UINT16(pNPIMsg->pData[1],pNPIMsg->pData[2]);
-              hciRsp.pData = (uint8_t *)&pNPIMsg->pData[3];
+              // Parameters follow the fixed part of the response
+              hciRsp.pData =
+                (uint8_t *)SNP_unpackHciCmdRsp(pNPIMsg->pData, &hciRsp);
 
               if (SNP_asyncCB)
               {
@@ -173,163 +199,58 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
 
           case SNP_EVENT_IND:
             {
-              snpEvt_t pEvt;
+              snpEvt_t evt;
+              snpEventParam_t param;
+              // Event parameters follow the 2 byte event code
+              const uint8_t *pParams = &pNPIMsg->pData[2];
 
-              // Copy non-Pointer members of Event Struct
-              pEvt.event = BUILD_UINT16(pNPIMsg->pData[0],pNPIMsg->pData[1]);
+              evt.event = BUILD_UINT16(pNPIMsg->pData[0],pNPIMsg->pData[1]);
+              evt.pEvtParams = &param;
 
-              // Send event back up to NP.
-              switch(pEvt.event)
+              switch(evt.event)
               {
                 case SNP_CONN_EST_EVT:
-                  {
-                    snpConnEstEvt_t connEstEvt;
-
-                    // Initialize Event
-                    connEstEvt.connHandle =
-                      BUILD_UINT16(pNPIMsg->pData[2],pNPIMsg->pData[3]);
-                    connEstEvt.connInterval =
-                      BUILD_UINT16(pNPIMsg->pData[4],pNPIMsg->pData[5]);
-                    connEstEvt.slaveLatency =
-                      BUILD_UINT16(pNPIMsg->pData[6],pNPIMsg->pData[7]);
-                    connEstEvt.supervisionTimeout =
-                      BUILD_UINT16(pNPIMsg->pData[8],pNPIMsg->pData[9]);
-                    connEstEvt.addressType = pNPIMsg->pData[10];
-
-                    memcpy(connEstEvt.pAddr, &pNPIMsg->pData[11],
-                           sizeof(connEstEvt.pAddr));
-
-                    pEvt.pEvtParams = (snpEventParam_t *)&connEstEvt;
-
-                    // Send to NP layer.
-                    if ( SNP_eventCB )
-                    {
-                      SNP_eventCB(&pEvt);
-                    }
-                  }
+                  SNP_unpackConnEstEvt(pParams, &param.connEstEvt);
                   break;
 
                 case SNP_CONN_TERM_EVT:
-                  {
-                    snpConnTermEvt_t connTermEvt;
-
-                    // Initialize Event
-                    connTermEvt.connHandle =
-                      BUILD_UINT16(pNPIMsg->pData[2],pNPIMsg->pData[3]);
-                    connTermEvt.reason = pNPIMsg->pData[4];
-
-                    pEvt.pEvtParams = (snpEventParam_t *)&connTermEvt;
-
-                    // Send to NP layer.
-                    if ( SNP_eventCB )
-                    {
-                      SNP_eventCB(&pEvt);
-                    }
-                  }
+                  SNP_unpackConnTermEvt(pParams, &param.connTermEvt);
                   break;
 
                 case SNP_CONN_PARAM_UPDATED_EVT:
-                  {
-                    snpUpdateConnParamEvt_t event;
-
-                    // Initialize Event
-                    event.connHandle =
-                      BUILD_UINT16(pNPIMsg->pData[2],pNPIMsg->pData[3]);
-                    event.connInterval =
-                      BUILD_UINT16(pNPIMsg->pData[4],pNPIMsg->pData[5]);
-                    event.slaveLatency =
-                      BUILD_UINT16(pNPIMsg->pData[6],pNPIMsg->pData[7]);
-                    event.supervisionTimeout =
-                      BUILD_UINT16(pNPIMsg->pData[8],pNPIMsg->pData[9]);
-
-                    pEvt.pEvtParams = (snpEventParam_t *)&event;
-
-                    // Send to NP layer.
-                    if ( SNP_eventCB )
-                    {
-                      SNP_eventCB(&pEvt);
-                    }
-                  }
+                  SNP_unpackUpdateConnParamEvt(pParams,
+                                               &param.updateConnParamEvt);
                   break;
 
                 case SNP_ADV_STARTED_EVT:
                 case SNP_ADV_ENDED_EVT:
-                  {
-                    snpAdvStatusEvt_t event;
-
-                    // Initialize Event
-                    event.status = pNPIMsg->pData[2];
-
-                    pEvt.pEvtParams = (snpEventParam_t *)&event;
-
-                    // Send to NP layer.
-                    if ( SNP_eventCB )
-                    {
-                      SNP_eventCB(&pEvt);
-                    }
-                  }
+                  SNP_unpackAdvStatusEvt(pParams, &param.advStatusEvt);
                   break;
 
                 case SNP_ATT_MTU_EVT:
-                  {
-                    snpATTMTUSizeEvt_t event;
-
-                    // Initialize Event
-                    event.connHandle =
-                      BUILD_UINT16(pNPIMsg->pData[2],pNPIMsg->pData[3]);
-                    event.attMtuSize =
-                      BUILD_UINT16(pNPIMsg->pData[4],pNPIMsg->pData[5]);
-
-                    pEvt.pEvtParams = (snpEventParam_t *)&event;
-
-                    // Send to NP layer.
-                    if ( SNP_eventCB )
-                    {
-                      SNP_eventCB(&pEvt);
-                    }
-                  }
+                  SNP_unpackATTMTUSizeEvt(pParams, &param.attMTUSizeEvt);
                   break;
 
                 case SNP_SECURITY_EVT:
-                  {
-                    snpSecurityEvt_t event;
-
-                    // Initialize Event
-                    event.state = pNPIMsg->pData[2];
-                    event.status = pNPIMsg->pData[3];
-
-                    pEvt.pEvtParams = (snpEventParam_t *)&event;
-
-                    // Send to NP layer.
-                    if ( SNP_eventCB )
-                    {
-                      SNP_eventCB(&pEvt);
-                    }
-                  }
+                  SNP_unpackSecurityEvt(pParams, &param.securityEvt);
                   break;
 
                 case SNP_AUTHENTICATION_EVT:
-                  {
-                    snpAuthenticationEvt_t event;
-
-                    // Initialize Event
-                    event.display = pNPIMsg->pData[2];
-                    event.input   = pNPIMsg->pData[3];
-                    event.numCmp = BUILD_UINT32(pNPIMsg->pData[4],
-                                                pNPIMsg->pData[5],
-                                                pNPIMsg->pData[6],
-                                                pNPIMsg->pData[7]);
-
-                    pEvt.pEvtParams = (snpEventParam_t *)&event;
-
-                    // Send to NP layer.
-                    if ( SNP_eventCB )
-                    {
-                      SNP_eventCB(&pEvt);
-                    }
-                  }
+                  SNP_unpackAuthenticationEvt(pParams,
+                                              &param.authenticationEvt);
+                  break;
+
+                default:
+                  // Not routed to the application
+                  evt.pEvtParams = NULL;
                   break;
               }
+
+              // Send to NP layer.
+              if ( evt.pEvtParams && SNP_eventCB )
+              {
+                SNP_eventCB(&evt);
+              }
             }
             break;
 
@@ -338,11 +259,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
           {
             npiRetMsg.len = msgLen;
 
-            // Explicitly copy response
-            npiRetMsg.pMsg->getStatusRsp.gapRoleStatus = pNPIMsg->pData[0];
-            npiRetMsg.pMsg->getStatusRsp.advStatus = pNPIMsg->pData[1];
-            npiRetMsg.pMsg->getStatusRsp.ATTstatus = pNPIMsg->pData[2];
-            npiRetMsg.pMsg->getStatusRsp.ATTmethod = pNPIMsg->pData[3];
+            SNP_unpackGetStatusCmdRsp(pNPIMsg->pData,
+                                      &npiRetMsg.pMsg->getStatusRsp);
           }
           break;
 
@@ -351,10 +269,7 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
           {
             snpTestCmdRsp_t rsp;
 
-            // Initialize Response Struct
-            rsp.memAlo = BUILD_UINT16(pNPIMsg->pData[0],pNPIMsg->pData[1]);
-            rsp.memMax = BUILD_UINT16(pNPIMsg->pData[2],pNPIMsg->pData[3]);
-            rsp.memSize = BUILD_UINT16(pNPIMsg->pData[4],pNPIMsg->pData[5]);
+            SNP_unpackTestCmdRsp(pNPIMsg->pData, &rsp);
 
             if (SNP_asyncCB)
             {
@@ -387,21 +302,20 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               snpSetAdvDataCnf_t cnf;
 
-              cnf.status = pNPIMsg->pData[0];
+              SNP_unpackStatusRsp(pNPIMsg->pData, &cnf);
 
               if (SNP_asyncCB)
               {
                 SNP_asyncCB(pNPIMsg->cmd1, (snp_msg_t *)&cnf, msgLen);
               }
             }
+            break;
 
           case SNP_UPDATE_CONN_PARAM_CNF:
             {
               snpUpdateConnParamCnf_t cnf;
 
-              cnf.status = pNPIMsg->pData[0];
-              cnf.connHandle =
-                BUILD_UINT16(pNPIMsg->pData[1], pNPIMsg->pData[2]);
+              SNP_unpackUpdateConnParamCnf(pNPIMsg->pData, &cnf);
 
               if (SNP_asyncCB)
               {
@@ -417,8 +331,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->setGapParamRsp.status = pNPIMsg->pData[0];
+              SNP_unpackStatusRsp(pNPIMsg->pData,
+                                  &npiRetMsg.pMsg->setGapParamRsp);
             }
             break;
 
@@ -428,12 +342,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->getGapParamRsp.status = pNPIMsg->pData[0];
-              npiRetMsg.pMsg->getGapParamRsp.paramId =
-                BUILD_UINT16(pNPIMsg->pData[1],pNPIMsg->pData[2]);
-              npiRetMsg.pMsg->getGapParamRsp.status =
-                BUILD_UINT16(pNPIMsg->pData[3],pNPIMsg->pData[4]);
+              SNP_unpackGetGapParamRsp(pNPIMsg->pData,
+                                       &npiRetMsg.pMsg->getGapParamRsp);
             }
             break;
 
@@ -443,8 +353,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->setSecParamRsp.status = pNPIMsg->pData[0];
+              SNP_unpackStatusRsp(pNPIMsg->pData,
+                                  &npiRetMsg.pMsg->setSecParamRsp);
             }
             break;
 
@@ -453,8 +363,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->setAuthDataRsp.status = pNPIMsg->pData[0];
+              SNP_unpackStatusRsp(pNPIMsg->pData,
+                                  &npiRetMsg.pMsg->setAuthDataRsp);
             }
             break;
 
@@ -463,8 +373,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              //Explicitly copy reponse
-              npiRetMsg.pMsg->setWhiteListRsp.status = pNPIMsg->pData[0];
+              SNP_unpackStatusRsp(pNPIMsg->pData,
+                                  &npiRetMsg.pMsg->setWhiteListRsp);
             }
             break;
 #endif //!SNP_LOCAL
@@ -486,8 +396,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->addServiceRsp.status = pNPIMsg->pData[0];
+              SNP_unpackStatusRsp(pNPIMsg->pData,
+                                  &npiRetMsg.pMsg->addServiceRsp);
             }
             break;
 
@@ -496,10 +406,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->addCharValueDecRsp.status = pNPIMsg->pData[0];
-              npiRetMsg.pMsg->addCharValueDecRsp.attrHandle =
-                BUILD_UINT16(pNPIMsg->pData[1],pNPIMsg->pData[2]);
+              SNP_unpackAddCharValueDeclRsp(pNPIMsg->pData,
+                                            &npiRetMsg.pMsg->addCharValueDecRsp);
             }
             break;
 
@@ -507,17 +415,17 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             if ( npiRetMsg.pMsg )
             {
               uint8_t i = 0;
+              const uint8_t *pHandles;
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->addCharDescDeclRsp.status = pNPIMsg->pData[0];
-              npiRetMsg.pMsg->addCharDescDeclRsp.header = pNPIMsg->pData[1];
+              pHandles = SNP_unpackAddCharDescDeclRsp(pNPIMsg->pData,
+                                          &npiRetMsg.pMsg->addCharDescDeclRsp);
 
               // Remaining Msg contents are uint16 handles
-              while(i < (msgLen - 2))
+              while(i < (msgLen - SNP_LEN_AddCharDescDeclRsp))
               {
                 npiRetMsg.pMsg->addCharDescDeclRsp.handles[(i/2)] =
-                  BUILD_UINT16(pNPIMsg->pData[2 + i],pNPIMsg->pData[3 + i]);
+                  BUILD_UINT16(pHandles[i], pHandles[i + 1]);
                 i += 2;
               }
             }
@@ -528,10 +436,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->addCharValueDecRsp.status = pNPIMsg->pData[0];
-              npiRetMsg.pMsg->addCharValueDecRsp.attrHandle =
-                BUILD_UINT16(pNPIMsg->pData[1],pNPIMsg->pData[2]);
+              SNP_unpackRegisterServiceRsp(pNPIMsg->pData,
+                                           &npiRetMsg.pMsg->registerService);
             }
             break;
 
@@ -540,8 +446,8 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->setGattParamRsp.status = pNPIMsg->pData[0];
+              SNP_unpackStatusRsp(pNPIMsg->pData,
+                                  &npiRetMsg.pMsg->setGattParamRsp);
             }
             break;
 
@@ -551,22 +457,51 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               npiRetMsg.len = msgLen;
 
-              // Explicitly copy response
-              npiRetMsg.pMsg->getGattParamRsp.serviceID = pNPIMsg->pData[0];
-              npiRetMsg.pMsg->getGattParamRsp.paramID = pNPIMsg->pData[1];
+              // Value follows the service and parameter IDs
               npiRetMsg.pMsg->getGattParamRsp.pData =
-                (uint8_t *)&pNPIMsg->pData[2];
+                (uint8_t *)SNP_unpackSetGattParamReq(pNPIMsg->pData,
+                                            &npiRetMsg.pMsg->getGattParamRsp);
             }
             break;
 
           // Get attribute value from NP response.
           case SNP_GET_ATTR_VALUE_RSP:
-            //RFU
+            if ( npiRetMsg.pMsg )
+            {
+              snpGetAttrValueRsp_t *pRsp = &npiRetMsg.pMsg->getAttrValueRsp;
+              const uint8_t *pVal;
+
+              if ( msgLen < SNP_LEN_GetAttrValueRsp )
+              {
+                npiRetMsg.status = SNP_FAILURE;
+                npiRetMsg.len = 0;
+                break;
+              }
+              pVal = SNP_unpackGetAttrValueRsp(pNPIMsg->pData, pRsp);
+
+              // Value follows the status and handle. Copy what fits into the
+              // caller's buffer, the frame is freed once this returns.
+              npiRetMsg.len = msgLen - SNP_LEN_GetAttrValueRsp;
+              if ( npiRetMsg.len > npiRetMsg.cap )
+              {
+                npiRetMsg.status = SNP_OUT_OF_RESOURCES;
+                npiRetMsg.len = npiRetMsg.cap;
+              }
+              if ( pRsp->pData )
+              {
+                memcpy(pRsp->pData, pVal, npiRetMsg.len);
+              }
+            }
             break;
 
           // Set attribute value on NP response.
           case SNP_SET_ATTR_VALUE_RSP:
-            //RFU
+            if ( npiRetMsg.pMsg )
+            {
+              npiRetMsg.len = msgLen;
+              SNP_unpackSetAttrValueRsp(pNPIMsg->pData,
+                                        &npiRetMsg.pMsg->setAttrValueRsp);
+            }
             break;
 #endif //!SNP_LOCAL
 
@@ -575,14 +510,7 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               snpCharReadInd_t readInd;
 
-              readInd.connHandle =
-                BUILD_UINT16(pNPIMsg->pData[0], pNPIMsg->pData[1]);
-              readInd.attrHandle =
-                BUILD_UINT16(pNPIMsg->pData[2], pNPIMsg->pData[3]);
-              readInd.offset =
-                BUILD_UINT16(pNPIMsg->pData[4], pNPIMsg->pData[5]);
-              readInd.maxSize =
-                BUILD_UINT16(pNPIMsg->pData[6], pNPIMsg->pData[7]);
+              SNP_unpackCharReadInd(pNPIMsg->pData, &readInd);
 
               SNP_asyncCB(pNPIMsg->cmd1, (snp_msg_t *)&readInd, msgLen);
             }
@@ -593,14 +521,23 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               snpCharWriteInd_t writeInd;
 
-              writeInd.connHandle =
-                BUILD_UINT16(pNPIMsg->pData[0], pNPIMsg->pData[1]);
-              writeInd.attrHandle =
-                BUILD_UINT16(pNPIMsg->pData[2], pNPIMsg->pData[3]);
-              writeInd.rspNeeded = pNPIMsg->pData[4];
-              writeInd.offset =
-                BUILD_UINT16(pNPIMsg->pData[5], pNPIMsg->pData[6]);
-              writeInd.pData = (uint8_t *)&pNPIMsg->pData[7];
+              // Too short to name the attribute, nothing to write or confirm
+              if (msgLen < SNP_LEN_CharWriteInd)
+              {
+                break;
+              }
+
+              // Value follows the fixed part of the indication
+              writeInd.pData =
+                (uint8_t *)SNP_unpackCharWriteInd(pNPIMsg->pData, &writeInd);
+
+              // Writes the application handles on the fast path skip the
+              // search of the service table
+              if (SNP_fastWriteCB &&
+                  SNP_fastWriteCB(&writeInd, msgLen - SNP_LEN_CharWriteInd))
+              {
+                break;
+              }
 
               if (SNP_asyncCB)
               {
@@ -614,9 +551,7 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               snpNotifIndCnf_t notifCnf;
 
-              notifCnf.status = pNPIMsg->pData[0];
-              notifCnf.connHandle =
-                BUILD_UINT16(pNPIMsg->pData[1], pNPIMsg->pData[2]);
+              SNP_unpackCharWriteCnf(pNPIMsg->pData, &notifCnf);
 
               SNP_asyncCB(pNPIMsg->cmd1, (snp_msg_t *)&notifCnf, msgLen);
             }
@@ -627,13 +562,7 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
             {
               snpCharCfgUpdatedInd_t cccdInd;
 
-              cccdInd.connHandle =
-                BUILD_UINT16(pNPIMsg->pData[0], pNPIMsg->pData[1]);
-              cccdInd.cccdHandle =
-                BUILD_UINT16(pNPIMsg->pData[2], pNPIMsg->pData[3]);
-              cccdInd.rspNeeded = pNPIMsg->pData[4];
-              cccdInd.value =
-                BUILD_UINT16(pNPIMsg->pData[5], pNPIMsg->pData[6]);
+              SNP_unpackCharCfgUpdatedInd(pNPIMsg->pData, &cccdInd);
 
               SNP_asyncCB(pNPIMsg->cmd1, (snp_msg_t *)&cccdInd, msgLen);
             }
@@ -654,11 +583,16 @@ void NPISS_BLE_SNP_msgFromSNP(_npiFrame_t *pNPIMsg)
 #ifndef SNP_LOCAL
   if (pNPIMsg->cmd0 == SNP_NPI_SYNC_RSP_TYPE)
   {
-    // This is a synchronous response, signal the application who requested this.
-    SNP_responseReceived();
+    // This is a synchronous response, signal the application who requested
+    // this, or expect the next one of its batch.
+    SNP_RPC_syncRspReceived();
   }
 #endif //SNP_LOCAL
 
   // Ok to deallocate
+#ifdef SNP_LOCAL
   SNP_free(pNPIMsg);
+#else //!SNP_LOCAL
+  NPITask_freeFrame(pNPIMsg);
+#endif //SNP_LOCAL
 }
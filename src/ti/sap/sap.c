@@ -64,10 +64,32 @@
 #define SAP_MAX_ADV_SCAN_DATA_LEN 31 // maximum of 31 bytes allowed in advertising
                                      // and scan reponse data by BLE protocol
 
+#ifndef SAP_MAX_SERVICES
+#define SAP_MAX_SERVICES          16 // services that can be registered at once
+#endif
+
+// Characteristics whose declarations SAP_registerService sends per batch,
+// each taking a value and a descriptor declaration
+#define SAP_CHAR_BATCH            (SNP_SYNC_BATCH_DEPTH / 2)
+
+#if SNP_SYNC_BATCH_DEPTH < 2
+#error "SNP_SYNC_BATCH_DEPTH must fit the two declarations of a characteristic"
+#endif
+
 /*********************************************************************
  * MACROS
  */
 
+#ifdef SNP_LOCAL
+#define SAP_BEGIN_BATCH()
+#define SAP_END_BATCH()           SNP_SUCCESS
+#define SAP_BATCH_ROOM()          SNP_SYNC_BATCH_DEPTH
+#else //!SNP_LOCAL
+#define SAP_BEGIN_BATCH()         SNP_RPC_beginSyncBatch()
+#define SAP_END_BATCH()           SNP_RPC_endSyncBatch()
+#define SAP_BATCH_ROOM()          SNP_RPC_syncBatchRoom()
+#endif //SNP_LOCAL
+
 
 /*********************************************************************
  * TYPEDEFS
@@ -92,7 +114,6 @@ typedef struct
 // Service node
 typedef struct
 {
-  struct serviceNode_t *next; // pointer to next service node in the list
   void *context; // stored context of service
   pfnGATTReadAttrCB_t charReadCB; // pointer to registered service read call back
   pfnGATTWriteAttrCB_t charWriteCB; // pointer to registered service write call back
@@ -107,8 +128,9 @@ eventCBNode_t *eventCBListRoot = NULL;
 // Root of the async callback list.
 asyncCBNode_t *asyncCBListRoot = NULL;
 
-// Root of the service list
-serviceNode_t *serviceListRoot = NULL;
+// Registered services, in increasing handle order
+static serviceNode_t serviceTable[SAP_MAX_SERVICES];
+static uint8_t serviceCount = 0;
 
 
 /* Default Remote Port UART */
@@ -248,13 +270,43 @@ static void getEventCallbacks(snpEvt_t *pEvt)
   }
 }
 
+/*
+ * Find the registered service whose handle range contains handle, or NULL.
+ * Binary search for the last service starting at or below handle.
+ */
+static serviceNode_t *findService(uint16_t handle)
+{
+  uint8_t lo = 0;
+  uint8_t hi = serviceCount;
+
+  while (lo < hi)
+  {
+    uint8_t mid = (lo + hi) / 2;
+
+    if (serviceTable[mid].minHandle <= handle)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  if (lo == 0 || handle > serviceTable[lo - 1].maxHandle)
+  {
+    return NULL;
+  }
+  return &serviceTable[lo - 1];
+}
+
 /*
  * Iterate through list of asynchronous callbacks and
  */
 void handleAsyncCB(uint8_t cmd1, snp_msg_t *pMsg, uint16_t msgLen)
 {
   asyncCBNode_t *iter = asyncCBListRoot;
-  serviceNode_t *curr = serviceListRoot;
+  serviceNode_t *curr;
 
   switch(SNP_GET_OPCODE_HDR_CMD1(cmd1))
   {
@@ -269,31 +321,25 @@ void handleAsyncCB(uint8_t cmd1, snp_msg_t *pMsg, uint16_t msgLen)
               uint16_t size = 0;
               snpCharReadInd_t *rI = (snpCharReadInd_t *)pMsg;
 
-              // Initialize Confirmation Struct
+              // Initialize Confirmation Struct. The service reads straight
+              // into the payload of the confirmation frame.
               lCnf.connHandle = rI->connHandle;
               lCnf.attrHandle = rI->attrHandle;
               lCnf.offset = rI->offset;
-              lCnf.pData = (uint8_t *)SNP_malloc(rI->maxSize);
+              lCnf.pData = SNP_RPC_allocReadCharCnf(rI->maxSize);
               lCnf.status = SNP_FAILURE;
 
               // Searching for service that contains handle
-              while (curr != NULL)
+              curr = findService(rI->attrHandle);
+
+              // Found correct service. If call back is registered invoke,
+              // else return error status
+              if (curr != NULL && curr->charReadCB && lCnf.pData)
               {
-                if (rI->attrHandle >= curr->minHandle &&
-                     rI->attrHandle <= curr->maxHandle)
-                {
-                  // Found correct service. If call back is registered invoke,
-                  // else return error status
-                  if (curr->charReadCB)
-                  {
-                    lCnf.status = curr->charReadCB(curr->context, rI->connHandle,
-                                                        rI->attrHandle, rI->offset,
-                                                        rI->maxSize, &size,
-                                                        lCnf.pData);
-                  }
-                  break;
-                }
-                curr = (serviceNode_t *)curr->next;
+                lCnf.status = curr->charReadCB(curr->context, rI->connHandle,
+                                               rI->attrHandle, rI->offset,
+                                               rI->maxSize, &size,
+                                               lCnf.pData);
               }
 
               /*
@@ -303,8 +349,6 @@ void handleAsyncCB(uint8_t cmd1, snp_msg_t *pMsg, uint16_t msgLen)
                * the application's context.
                */
               SNP_RPC_readCharCnf(&lCnf, size);
-
-              SNP_free(lCnf.pData);
             }
             break;
 
@@ -322,23 +366,15 @@ void handleAsyncCB(uint8_t cmd1, snp_msg_t *pMsg, uint16_t msgLen)
               lCnf.connHandle = wI->connHandle;
 
               // Searching for service that contains handle
-              while (curr != NULL)
+              curr = findService(wI->attrHandle);
+
+              // Found correct service. If call back is registered invoke,
+              // else return error status
+              if (curr != NULL && curr->charWriteCB)
               {
-                if (wI->attrHandle >= curr->minHandle &&
-                     wI->attrHandle <= curr->maxHandle)
-                {
-                  // Found correct service. If call back is registered invoke,
-                  // else return error status
-                  if (curr->charWriteCB)
-                  {
-
-                    lCnf.status = curr->charWriteCB(curr->context, wI->connHandle,
-                                                         wI->attrHandle, msgLen,
-                                                         wI->pData);
-                  }
-                  break;
-                }
-                curr = (serviceNode_t *)curr->next;
+                lCnf.status = curr->charWriteCB(curr->context, wI->connHandle,
+                                                wI->attrHandle, msgLen,
+                                                wI->pData);
               }
 
               /*
@@ -347,8 +383,12 @@ void handleAsyncCB(uint8_t cmd1, snp_msg_t *pMsg, uint16_t msgLen)
                * the stack, the confirmation is queued up to be executed within
                * the application's context.
                */
-              // Respond to write request
-              SNP_RPC_writeCharCnf(&lCnf);
+              // Respond to write request. Write commands from the client
+              // have no ATT response, so the NP expects no confirmation.
+              if (wI->rspNeeded)
+              {
+                SNP_RPC_writeCharCnf(&lCnf);
+              }
             }
             break;
 
@@ -361,22 +401,15 @@ void handleAsyncCB(uint8_t cmd1, snp_msg_t *pMsg, uint16_t msgLen)
               lRsp.status = SNP_FAILURE;
               lRsp.connHandle = cu->connHandle;
 
-              while (curr != NULL)
+              curr = findService(cu->cccdHandle);
+
+              // Found correct service. If call back is registered invoke,
+              // else return error status
+              if (curr != NULL && curr->cccdIndCB)
               {
-                if (cu->cccdHandle >= curr->minHandle &&
-                     cu->cccdHandle <= curr->maxHandle)
-                {
-                  if (curr->cccdIndCB)
-                  {
-                    // Found correct service. If call back is registered invoke,
-                    // else return error status
-                    lRsp.status = curr->cccdIndCB(curr->context, cu->connHandle,
-                                                       cu->cccdHandle, cu->rspNeeded,
-                                                       cu->value);
-                  }
-                  break;
-                }
-                curr = (serviceNode_t *)curr->next;
+                lRsp.status = curr->cccdIndCB(curr->context, cu->connHandle,
+                                              cu->cccdHandle, cu->rspNeeded,
+                                              cu->value);
               }
 
               /*
@@ -385,8 +418,11 @@ void handleAsyncCB(uint8_t cmd1, snp_msg_t *pMsg, uint16_t msgLen)
                * the stack, the confirmation is queued up to be executed within
                * the application's context.
                */
-              // Respond to CCCD Indication
-              SNP_RPC_charConfigUpdatedRsp(&lRsp);
+              // Respond to CCCD Indication, if the NP waits for it
+              if (cu->rspNeeded)
+              {
+                SNP_RPC_charConfigUpdatedRsp(&lRsp);
+              }
             }
             break;
 
@@ -455,6 +491,10 @@ uint8_t SAP_initParams(uint8_t portType, SAP_Params *params)
       status = SNP_INVALID_PARAMS;
 #endif //NPI_USE_SPI
     }
+    else
+    {
+      status = SNP_INVALID_PARAMS;
+    }
   }
 
   return status;
@@ -516,10 +556,20 @@ uint8_t SAP_open(SAP_Params *params)
 
   if (params->portType == SAP_PORT_REMOTE_UART)
   {
+    if (NPITask_Params_initPortType(&npiParams, NPI_SERIAL_TYPE_UART) !=
+        NPI_SUCCESS)
+    {
+      return SNP_FAILURE;
+    }
     npiParams.portParams.uartParams.baudRate = params->port.remote.bitRate;
   }
   else if (params->portType == SAP_PORT_REMOTE_SPI)
   {
+    if (NPITask_Params_initPortType(&npiParams, NPI_SERIAL_TYPE_SPI) !=
+        NPI_SUCCESS)
+    {
+      return SNP_FAILURE;
+    }
     npiParams.portParams.spiParams.bitRate = params->port.remote.bitRate;
   }
 
@@ -549,8 +599,6 @@ uint8_t SAP_close(void)
   asyncCBNode_t *aTempNode = NULL;
   eventCBNode_t *eNode = eventCBListRoot;
   eventCBNode_t *eTempNode = NULL;
-  serviceNode_t *sNode = serviceListRoot;
-  serviceNode_t *sTempNode = NULL;
 
   // Clean up call back and service lists
   while(aNode != NULL)
@@ -569,13 +617,7 @@ uint8_t SAP_close(void)
   }
   eventCBListRoot = NULL;
 
-  while(sNode != NULL)
-  {
-    sTempNode = (serviceNode_t *)sNode->next;
-    SNP_free(sNode);
-    sNode = sTempNode;
-  }
-  serviceListRoot = NULL;
+  serviceCount = 0;
 
   SNP_close();
 
@@ -636,10 +678,133 @@ uint8_t SAP_reset(void)
   return status;
 }
 
+/*
+ * Queue or send the value and descriptor declarations of one characteristic.
+ * Their responses land in pValRsp and pDescRsp.
+ */
+static uint8_t addChar(SAP_Char_t *ch, uint8_t *pHeader,
+                       snpAddCharValueDeclRsp_t *pValRsp,
+                       snpAddCharDescDeclRsp_t *pDescRsp)
+{
+  snpAddCharValueDeclReq_t lValReq;
+  uint8_t status;
+
+  // Initialize Request
+  lValReq.charValPerms = ch->permissions;
+  lValReq.charValProps = ch->properties;
+  lValReq.mgmtOption = ch->mgmtOption;
+  // The NP allocates the whole length up front for values it stores
+  lValReq.charValMaxLen = (ch->mgmtOption == SNP_CHAR_MANAGED_BY_NP) ?
+                          ch->maxLen : SNP_GATT_CHAR_MAX_LENGTH;
+  memcpy(lValReq.UUID, ch->UUID.pUUID, ch->UUID.len);
+
+  // Descriptors to add, kept to sort out the handles in the response
+  *pHeader = (ch->pCccd)? SNP_DESC_HEADER_CCCD : 0;
+  *pHeader |= (ch->pFormat)? SNP_DESC_HEADER_FORMAT : 0;
+  *pHeader |= (ch->pUserDesc)? SNP_DESC_HEADER_USER_DESC : 0;
+  *pHeader |= (ch->pShortUUID)? SNP_DESC_HEADER_GEN_SHORT_UUID: 0;
+  *pHeader |= (ch->pLongUUID)? SNP_DESC_HEADER_GEN_LONG_UUID: 0;
+
+  // Add the characteristic value
+#ifdef SNP_LOCAL
+  status = SNP_addCharValueDecl(&lValReq, ch->UUID.len, pValRsp);
+#else
+  status = SNP_RPC_addCharValueDec(&lValReq, ch->UUID.len, pValRsp);
+#endif //SNP_LOCAL
+
+  // If there are any descriptors
+  if (status == SNP_SUCCESS && *pHeader)
+  {
+    snpAddCharDescDeclReq_t lDescReq;
+
+    lDescReq.header = *pHeader;
+
+    // Initialize pointers to sub-structs
+    lDescReq.pCCCD = ch->pCccd;
+    lDescReq.pFormat = ch->pFormat;
+    lDescReq.pUserDesc = ch->pUserDesc;
+    lDescReq.pShortUUID = ch->pShortUUID;
+    lDescReq.pLongUUID = ch->pLongUUID;
+
+#ifdef SNP_LOCAL
+    status = SNP_addDescriptionValue(&lDescReq, pDescRsp);
+#else
+    status = SNP_RPC_addCharDescDec(&lDescReq, pDescRsp);
+#endif // SNP_LOCAL
+  }
+
+  return status;
+}
+
+/*
+ * Wait for the declarations of characteristics first to next - 1, then copy
+ * the handles the NP gave them into the service characteristic handle array,
+ * or hand them to the service's handles callback if it has none. pHeader
+ * holds the descriptors each characteristic asked for.
+ */
+static uint8_t saveCharHandles(SAP_Service_t *service, uint8_t first,
+                               uint8_t next, uint8_t *pHeader,
+                               snpAddCharValueDeclRsp_t *pValRsp,
+                               snpAddCharDescDeclRsp_t *pDescRsp)
+{
+  uint8_t status = SAP_END_BATCH();
+  uint8_t i;
+
+  for (i = 0; status == SNP_SUCCESS && i < next - first; i++)
+  {
+    SAP_CharHandle_t lHandles;
+    SAP_CharHandle_t *pHandles = &lHandles;
+    uint8_t hIdx = 0;
+
+    if (service->charAttrHandles)
+    {
+      pHandles = &service->charAttrHandles[first + i];
+    }
+
+    status = pValRsp[i].status;
+    pHandles->valueHandle = pValRsp[i].attrHandle;
+
+    if (status == SNP_SUCCESS && pHeader[i])
+    {
+      status = pDescRsp[i].status;
+    }
+    if (status != SNP_SUCCESS)
+    {
+      break;
+    }
+
+    // Copy handles from response into the service characteristic handle array
+    pHandles->sUUIDHandle = (pHeader[i] & SNP_DESC_HEADER_GEN_SHORT_UUID) ?
+                            pDescRsp[i].handles[hIdx++] : SNP_INVALID_HANDLE;
+    pHandles->lUUIDHandle = (pHeader[i] & SNP_DESC_HEADER_GEN_LONG_UUID) ?
+                            pDescRsp[i].handles[hIdx++] : SNP_INVALID_HANDLE;
+    pHandles->cccdHandle = (pHeader[i] & SNP_DESC_HEADER_CCCD) ?
+                           pDescRsp[i].handles[hIdx++] : SNP_INVALID_HANDLE;
+    pHandles->formatHandle = (pHeader[i] & SNP_DESC_HEADER_FORMAT) ?
+                             pDescRsp[i].handles[hIdx++] : SNP_INVALID_HANDLE;
+    pHandles->userDescHandle = (pHeader[i] & SNP_DESC_HEADER_USER_DESC) ?
+                               pDescRsp[i].handles[hIdx++] : SNP_INVALID_HANDLE;
+
+    if (service->charAttrHandles == NULL)
+    {
+      service->charHandlesCallback(service->context, first + i, pHandles);
+    }
+  }
+
+  return status;
+}
+
 /**
  * @fn          SAP_registerService
  *
- * @brief       Add a service to the GATT server.
+ * @brief       Add a service to the GATT server. The declarations are
+ *              streamed to the NP in batches, each request sent as soon as
+ *              the previous one is answered. A service without a
+ *              charTable declares each characteristic from its
+ *              charDeclCallback just before it is sent, and one without
+ *              charAttrHandles gets the handles through its
+ *              charHandlesCallback, so no table of the whole service has to
+ *              be built.
  *
  * @param       service - data to construct the service.
  *
@@ -651,113 +816,97 @@ uint8_t SAP_registerService(SAP_Service_t *service)
 {
   snpAddServiceReq_t lAddServReq;
   snpRegisterServiceRsp_t regServRsp;
-  serviceNode_t *newNode = NULL;
-  serviceNode_t *currNode = serviceListRoot;
+  snpAddCharValueDeclRsp_t lValRsp[SAP_CHAR_BATCH];
+  snpAddCharDescDeclRsp_t lDescRsp[SAP_CHAR_BATCH];
+  uint8_t lDescHeader[SAP_CHAR_BATCH];
+  SAP_Char_t lChar;
+  serviceNode_t *newNode;
+  uint8_t first = 0;
+  uint8_t i;
   uint8_t status;
+  uint8_t batchStatus;
+
+  // No room to route requests to another service
+  if (serviceCount == SAP_MAX_SERVICES)
+  {
+    return SNP_FAILURE;
+  }
 
   // Initialize Add Service Request Struct
   lAddServReq.type = service->serviceType;
   memcpy(lAddServReq.UUID, service->serviceUUID.pUUID,
          service->serviceUUID.len);
 
+  // None of the declarations depend on the responses to earlier ones
+  SAP_BEGIN_BATCH();
+
 #if defined SNP_LOCAL
   status = SNP_addService(&lAddServReq, service->serviceUUID.len, NULL);
 #else
-  // Add the service, Does not return until handle is received.
-  // NULL Passed for response, not currently checking status
+  // Add the service. NULL Passed for response, not currently checking status
   status = SNP_RPC_addService(&lAddServReq, service->serviceUUID.len,
                               NULL);
 #endif //SNP_LOCAL
 
-  if (status != SNP_SUCCESS)
-  {
-    return status;
-  }
-
   // Add the characteristics.
-  uint8_t i;
-  for (i = 0; i < service->charTableLen; i++)
+  for (i = 0; status == SNP_SUCCESS && i < service->charTableLen; i++)
   {
-    snpAddCharValueDeclReq_t lValReq;
-    snpAddCharValueDeclRsp_t lValRsp;
-    SAP_Char_t ch = service->charTable[i];
-
-    // Initialize Request
-    lValReq.charValPerms = ch.permissions;
-    lValReq.charValProps = ch.properties;
-    lValReq.mgmtOption = SNP_CHAR_MANAGED_BY_AP;
-    lValReq.charValMaxLen = SNP_GATT_CHAR_MAX_LENGTH;
-    memcpy(lValReq.UUID, ch.UUID.pUUID, ch.UUID.len);
-
-    // Add the characteristic value and save returned handle
-#ifdef SNP_LOCAL
-    status = SNP_addCharValueDecl(&lValReq, ch.UUID.len, &lValRsp);
-#else
-    status = SNP_RPC_addCharValueDec(&lValReq, ch.UUID.len, &lValRsp);
-#endif //SNP_LOCAL
-
-    if (status != SNP_SUCCESS)
+    // Collect the handles of the batch so far if another characteristic's
+    // declarations may not fit
+    if (i - first == SAP_CHAR_BATCH || SAP_BATCH_ROOM() < 2)
     {
-      return status;
+      status = saveCharHandles(service, first, i, lDescHeader, lValRsp,
+                               lDescRsp);
+      first = i;
+      SAP_BEGIN_BATCH();
     }
 
-    service->charAttrHandles[i].valueHandle = lValRsp.attrHandle;
-
-    // If there are any descriptors
-    if (ch.pUserDesc || ch.pCccd || ch.pFormat || ch.pShortUUID || ch.pLongUUID)
+    if (status == SNP_SUCCESS)
     {
-      uint8_t hIdx = 0;
-      snpAddCharDescDeclReq_t lDescReq;
-      snpAddCharDescDeclRsp_t lDescRsp;
-
-      // Build Header
-      lDescReq.header = (ch.pCccd)? SNP_DESC_HEADER_CCCD : 0;
-      lDescReq.header |= (ch.pFormat)? SNP_DESC_HEADER_FORMAT : 0;
-      lDescReq.header |= (ch.pUserDesc)? SNP_DESC_HEADER_USER_DESC : 0;
-      lDescReq.header |= (ch.pShortUUID)? SNP_DESC_HEADER_GEN_SHORT_UUID: 0;
-      lDescReq.header |= (ch.pLongUUID)? SNP_DESC_HEADER_GEN_LONG_UUID: 0;
-
-      // Initialize pointers to sub-structs
-      lDescReq.pCCCD = ch.pCccd;
-      lDescReq.pFormat = ch.pFormat;
-      lDescReq.pUserDesc = ch.pUserDesc;
-      lDescReq.pShortUUID = ch.pShortUUID;
-      lDescReq.pLongUUID = ch.pLongUUID;
-
-#ifdef SNP_LOCAL
-      status = SNP_addDescriptionValue(&lDescReq, &lDescRsp);
-#else
-      status = SNP_RPC_addCharDescDec(&lDescReq, &lDescRsp);
-#endif // SNP_LOCAL
+      SAP_Char_t *ch = &lChar;
 
-      if (status == SNP_SUCCESS)
+      if (service->charTable)
       {
-        // Copy handles from response into the service characteristic handle array
-        service->charAttrHandles[i].sUUIDHandle =
-          (ch.pShortUUID) ? lDescRsp.handles[hIdx++] : SNP_INVALID_HANDLE;
-        service->charAttrHandles[i].lUUIDHandle =
-          (ch.pLongUUID) ? lDescRsp.handles[hIdx++] : SNP_INVALID_HANDLE;
-        service->charAttrHandles[i].cccdHandle =
-          (ch.pCccd) ? lDescRsp.handles[hIdx++] : SNP_INVALID_HANDLE;
-        service->charAttrHandles[i].formatHandle =
-          (ch.pFormat) ? lDescRsp.handles[hIdx++] : SNP_INVALID_HANDLE;
-        service->charAttrHandles[i].userDescHandle =
-          (ch.pUserDesc) ? lDescRsp.handles[hIdx++] : SNP_INVALID_HANDLE;
+        ch = &service->charTable[i];
       }
       else
       {
-        // Return failure code
-        return lDescRsp.status;
+        service->charDeclCallback(service->context, i, &lChar);
       }
+      status = addChar(ch, &lDescHeader[i - first], &lValRsp[i - first],
+                       &lDescRsp[i - first]);
     }
   }
 
   // Register the service.
+  if (status == SNP_SUCCESS && SAP_BATCH_ROOM() == 0)
+  {
+    status = saveCharHandles(service, first, i, lDescHeader, lValRsp,
+                             lDescRsp);
+    first = i;
+    SAP_BEGIN_BATCH();
+  }
+
+  if (status == SNP_SUCCESS)
+  {
 #ifdef SNP_LOCAL
-  status = SNP_registerService(&regServRsp);
+    status = SNP_registerService(&regServRsp);
 #else
-  status = SNP_RPC_registerService(&regServRsp);
+    status = SNP_RPC_registerService(&regServRsp);
 #endif //SNP_LOCAL
+  }
+
+  // Always end the batch, it holds back other tasks
+  batchStatus = saveCharHandles(service, first, i, lDescHeader, lValRsp,
+                                lDescRsp);
+  if (status == SNP_SUCCESS)
+  {
+    status = batchStatus;
+  }
+  if (status == SNP_SUCCESS)
+  {
+    status = regServRsp.status;
+  }
 
   if (status != SNP_SUCCESS)
   {
@@ -767,47 +916,24 @@ uint8_t SAP_registerService(SAP_Service_t *service)
   // Set the service handle
   service->serviceHandle = regServRsp.startHandle;
 
-  // Create node
-  newNode = (serviceNode_t *)SNP_malloc(sizeof(serviceNode_t));
-
-  if (newNode != NULL)
-  {
-    // Tie service into service list
-    if (serviceListRoot == NULL)
-    {
-      serviceListRoot = newNode;
-    }
-    else
-    {
-      while(currNode != NULL)
-      {
-        if(currNode->next == NULL)
-        {
-          // Last service in list
-          currNode->next = (struct serviceNode_t *)newNode;
-          break;
-        }
-
-        currNode = (serviceNode_t *)currNode->next;
-      }
-    }
-
-    newNode->context = service->context;
-    newNode->charReadCB = service->charReadCallback;
-    newNode->charWriteCB = service->charWriteCallback;
-    newNode->cccdIndCB = service->cccdIndCallback;
-    newNode->next = NULL;
+  // The NP hands out handles in increasing order, so appending keeps the
+  // table sorted. Fill the entry before counting it, the NPI task may be
+  // searching the table.
+  newNode = &serviceTable[serviceCount];
+  newNode->context = service->context;
+  newNode->charReadCB = service->charReadCallback;
+  newNode->charWriteCB = service->charWriteCallback;
+  newNode->cccdIndCB = service->cccdIndCallback;
 
-    // Determine min handle of this service and determine the max handle of the prev service
-    newNode->minHandle = service->serviceHandle; //assumption min handle is service handle
-    newNode->maxHandle = 0xFFFF;
-
-    if (currNode != NULL)
-    {
-       currNode->maxHandle = service->serviceHandle - 1;
-    }
+  // Determine min handle of this service and determine the max handle of the prev service
+  newNode->minHandle = service->serviceHandle; //assumption min handle is service handle
+  newNode->maxHandle = 0xFFFF;
 
+  if (serviceCount > 0)
+  {
+     serviceTable[serviceCount - 1].maxHandle = service->serviceHandle - 1;
   }
+  serviceCount++;
 
   return SNP_SUCCESS;
 }
@@ -899,6 +1025,83 @@ uint8_t SAP_getServiceParam(uint8_t serviceID, uint8_t charID,
 #endif //SNP_LOCAL
 }
 
+/**
+ * @fn          SAP_setAttrValue
+ *
+ * @brief       Write the value of a characteristic managed by the NP.
+ *
+ * @param       attrHandle - handle of the characteristic value
+ * @param       len        - length of the data to write
+ * @param       pData      - pointer to buffer of data to write
+ *
+ * @return      SNP_SUCCESS: The write completed successfully.
+ *              SNP_FAILURE: The write failed.
+ */
+uint8_t SAP_setAttrValue(uint16_t attrHandle, uint16_t len, uint8_t *pData)
+{
+  snpSetAttrValueReq_t lReq;
+  snpSetAttrValueRsp_t lRsp;
+  uint8_t status;
+
+  // Initialize Request
+  lReq.attrHandle = attrHandle;
+  lReq.pData = pData;
+
+#ifdef SNP_LOCAL
+  status = SNP_setAttrValue(&lReq, len, &lRsp);
+#else
+  status = SNP_RPC_setAttrValue(&lReq, len, &lRsp);
+#endif //SNP_LOCAL
+
+  // The NP rejects unknown handles and values that are too long
+  if (status == SNP_SUCCESS)
+  {
+    status = lRsp.status;
+  }
+
+  return status;
+}
+
+/**
+ * @fn          SAP_getAttrValue
+ *
+ * @brief       Read the value of a characteristic managed by the NP.
+ *
+ * @param       attrHandle - handle of the characteristic value
+ * @param       len        - in: size of pData, out: length of the value
+ * @param       pData      - pointer to buffer to write to
+ *
+ * @return      SNP_SUCCESS: the read completed successfully.
+ *              SNP_OUT_OF_RESOURCES: the value is longer than *len. pData
+ *              holds its first *len bytes.
+ *              SNP_FAILURE: The read failed.
+ */
+uint8_t SAP_getAttrValue(uint16_t attrHandle, uint16_t *len, uint8_t *pData)
+{
+  snpGetAttrValueReq_t lReq;
+  snpGetAttrValueRsp_t lRsp;
+  uint8_t status;
+
+  // Initialize Request
+  lReq.attrHandle = attrHandle;
+
+  // Initialize Response data field. SNP call will copy into this buffer
+  lRsp.pData = pData;
+
+#ifdef SNP_LOCAL
+  status = SNP_getAttrValue(&lReq, &lRsp, len);
+#else
+  status = SNP_RPC_getAttrValue(&lReq, &lRsp, len);
+#endif //SNP_LOCAL
+
+  if (status == SNP_SUCCESS)
+  {
+    status = lRsp.status;
+  }
+
+  return status;
+}
+
 /**
  * @brief       Write to a stack parameter on the SAP. Some responses will
  *              Return immediately, others will generate an event for which
@@ -1157,9 +1360,11 @@ uint8_t SAP_setParam(uint8_t subsystemID, uint16_t paramID, uint16_t len,
           {
             snpSetSecParamRsp_t lRsp;
 
-            SNP_RPC_setSecurityParam(&lReq, &lRsp);
-
-            status = lRsp.status;
+            status = SNP_RPC_setSecurityParam(&lReq, &lRsp);
+            if (status == SNP_SUCCESS)
+            {
+              status = lRsp.status;
+            }
           }
 #endif //SNP_LOCAL
         }
@@ -1196,9 +1401,11 @@ uint8_t SAP_setParam(uint8_t subsystemID, uint16_t paramID, uint16_t len,
 #ifdef SNP_LOCAL
           status = SNP_setGapParam(&req);
 #else
-          SNP_RPC_setGAPparam(&req, &rsp);
-
-          status = rsp.status;
+          status = SNP_RPC_setGAPparam(&req, &rsp);
+          if (status == SNP_SUCCESS)
+          {
+            status = rsp.status;
+          }
 #endif //SNP_LOCAL
         }
         else
@@ -1287,10 +1494,12 @@ uint8_t SAP_getParam(uint8_t subsystemID, uint8_t paramID, uint16_t len,
 
           *pData = req.value;
 #else
-          SNP_RPC_getGAPparam(&req, &rsp);
-
-          status = rsp.status;
-          *pData = rsp.value;
+          status = SNP_RPC_getGAPparam(&req, &rsp);
+          if (status == SNP_SUCCESS)
+          {
+            status = rsp.status;
+            *pData = rsp.value;
+          }
 #endif //SNP_LOCAL
         }
         else
@@ -1472,6 +1681,58 @@ void SAP_getStatus(snpGetStatusCmdRsp_t *pRsp)
 #endif //SNP_LOCAL
 }
 
+/*********************************************************************
+ * @fn      SAP_verifyLink
+ *
+ * @brief   Round trip a SNP_GET_STATUS_REQ with a bounded wait
+ *
+ * @param   timeout - system ticks to wait for the response
+ *
+ * @return  SNP_SUCCESS if the NP answered, SNP_FAILURE otherwise
+ */
+uint8_t SAP_verifyLink(uint32_t timeout)
+{
+#ifdef SNP_LOCAL
+  return SNP_SUCCESS;
+#else
+  snpGetStatusCmdRsp_t rsp;
+
+  return SNP_RPC_getStatusTimeout(&rsp, timeout);
+#endif //SNP_LOCAL
+}
+
+/*********************************************************************
+ * @fn      SAP_setPortBitRate
+ *
+ * @brief   Ask the NP to move its UART to bitRate
+ *
+ * @param   bitRate - new UART bit rate
+ * @param   timeout - system ticks to wait for the response
+ *
+ * @return  SNP_SUCCESS if the NP switched, an error otherwise
+ */
+uint8_t SAP_setPortBitRate(uint32_t bitRate, uint32_t timeout)
+{
+#ifdef SNP_LOCAL
+  return SNP_CMD_REJECTED;
+#else
+  snpSetPortBitRateReq_t req;
+  snpSetPortBitRateRsp_t rsp;
+  uint8_t status;
+
+  req.bitRate = bitRate;
+
+  // An SNP without the command fails this with SNP_CMD_REJECTED
+  status = SNP_RPC_setPortBitRate(&req, &rsp, timeout);
+  if (status != SNP_SUCCESS)
+  {
+    return status;
+  }
+
+  return rsp.status;
+#endif //SNP_LOCAL
+}
+
 /*********************************************************************
 *********************************************************************/
 
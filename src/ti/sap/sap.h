@@ -139,7 +139,7 @@ extern "C"
  */
 #define SAP_PORT_LOCAL            0x00 //!< Locally running SAP (not supported)
 #define SAP_PORT_REMOTE_UART      0x01 //!< Remote connection w/ SAP over UART
-#define SAP_PORT_REMOTE_SPI       0x02 //!< Remote connection w/ SAP over SPI (not supported)
+#define SAP_PORT_REMOTE_SPI       0x02 //!< Remote connection w/ SAP over SPI
 /** @} End SAP_PORT_TYPES */
 
 /** @defgroup SAP_GAP_PARAMS SAP GAP Parameter IDs
@@ -271,8 +271,27 @@ typedef struct
   SAP_FormatAttr_t   *pFormat;    //!< User format.
   SAP_ShortUUID_t    *pShortUUID; //!< Generic Attribute Descriptor (Short UUID)
   SAP_LongUUID_t     *pLongUUID;  //!< Generic Attribute Descriptor (Long UUID)
+  uint8_t            mgmtOption;  //!< SNP_CHAR_MANAGED_BY_AP or SNP_CHAR_MANAGED_BY_NP
+  uint16_t           maxLen;      //!< Longest value the NP stores, if managed by the NP
 } SAP_Char_t;
 
+/** @defgroup SAP_GATT_CHAR_CB SAP Characteristic Declaration Callbacks.
+ * @{
+ */
+// Fills in characteristic index of a service without a charTable. What
+// pChar points to only has to last until the next call, SAP packs the
+// declaration into its request right away. It runs while SAP
+// holds the lock for synchronous requests, so it must not call any SAP or
+// SNP function; one that sends a request would never return.
+typedef void (*pfnCharDeclCB_t)(void *context, uint8_t index,
+                                SAP_Char_t *pChar);
+
+// Takes the handles of characteristic index of a service without
+// charAttrHandles.
+typedef void (*pfnCharHandlesCB_t)(void *context, uint8_t index,
+                                   SAP_CharHandle_t *pHandles);
+/** @} End SAP_GATT_CHAR_CB */
+
 /** @defgroup SAP_GATT_SERV_REG SAP GATT service registration parameter
  * @{
  */
@@ -288,6 +307,8 @@ typedef struct
   pfnCCCDIndCB_t       cccdIndCallback;   //!< Write callback function pointer: @ref SAP_CCCB_REQ_CB
   uint16_t             serviceHandle;     //!< Handle of the service characteristic
   SAP_CharHandle_t     *charAttrHandles;  //!< Array of handles for the characteristics
+  pfnCharDeclCB_t      charDeclCallback;  //!< Declares each characteristic if charTable is NULL: @ref SAP_GATT_CHAR_CB
+  pfnCharHandlesCB_t   charHandlesCallback; //!< Takes each characteristic's handles if charAttrHandles is NULL: @ref SAP_GATT_CHAR_CB
 } SAP_Service_t;
 /** @} End SAP_GATT_SERV_REG */
 
@@ -451,6 +472,35 @@ extern uint8_t SAP_getServiceParam(uint8_t serviceID, uint8_t charID,
 extern uint8_t SAP_setServiceParam(uint8_t serviceID, uint8_t charID,
                                    uint16_t len, uint8_t *pData);
 
+/**
+ * @brief       Write the value of a characteristic managed by the NP. The NP
+ *              answers client reads with it from then on.
+ *
+ * @param       attrHandle - handle of the characteristic value
+ * @param       len        - length of the data to write
+ * @param       pData      - pointer to buffer of data to write
+ *
+ * @return      SNP_SUCCESS: the write completed successfully.<BR>
+ *              SNP_FAILURE: the write failed or was rejected.<BR>
+ */
+extern uint8_t SAP_setAttrValue(uint16_t attrHandle, uint16_t len,
+                                uint8_t *pData);
+
+/**
+ * @brief       Read the value of a characteristic managed by the NP.
+ *
+ * @param       attrHandle - handle of the characteristic value
+ * @param       len        - in: size of pData, out: length of the value
+ * @param       pData      - pointer to buffer to write to
+ *
+ * @return      SNP_SUCCESS: the read completed successfully.<BR>
+ *              SNP_OUT_OF_RESOURCES: the value is longer than *len. pData
+ *              holds its first *len bytes.<BR>
+ *              SNP_FAILURE: the read failed or was rejected.<BR>
+ */
+extern uint8_t SAP_getAttrValue(uint16_t attrHandle, uint16_t *len,
+                                uint8_t *pData);
+
 /**
  * @brief       Write to a stack parameter on the SAP. Some responses will
  *              Return immediately, others will generate an event for which
@@ -558,6 +608,37 @@ extern void SAP_testCommand(void);
  */
 extern void SAP_getStatus(snpGetStatusCmdRsp_t *pRsp);
 
+/*********************************************************************
+ * @fn      SAP_verifyLink
+ *
+ * @brief   Round trip a SNP_GET_STATUS_REQ with a bounded wait. A link
+ *          dropping frames, e.g. on FCS errors, never sees the response.
+ *          If this fails the port must be closed before it is used again.
+ *
+ * @param   timeout - system ticks to wait for the response
+ *
+ * @return  SNP_SUCCESS if the NP answered, SNP_FAILURE otherwise
+ */
+extern uint8_t SAP_verifyLink(uint32_t timeout);
+
+/*********************************************************************
+ * @fn      SAP_setPortBitRate
+ *
+ * @brief   Ask the NP to move its UART to bitRate. On success the NP runs
+ *          at the new rate and the port must be reopened with it.
+ *          Needs an SNP image implementing SNP_SET_PORT_BIT_RATE_REQ; the
+ *          stock image answers with SNP_SYNC_ERROR_CMD_IND, which fails
+ *          this with SNP_CMD_REJECTED, and stays at its current bit rate.
+ *
+ * @param   bitRate - new UART bit rate
+ * @param   timeout - system ticks to wait for the response
+ *
+ * @return  SNP_SUCCESS if the NP switched, an error otherwise. If the NP
+ *          did not answer at all the port must be closed before it is
+ *          used again.
+ */
+extern uint8_t SAP_setPortBitRate(uint32_t bitRate, uint32_t timeout);
+
 
 /*********************************************************************
 *********************************************************************/
@@ -85,6 +85,7 @@ enum SNP_CMD1_HDR_TYPE {
 #define SNP_HCI_CMD_REQ                        0x04
 #define SNP_GET_STATUS_REQ                     0x06
 #define SNP_GET_RAND_REQ                       0x07
+#define SNP_SET_PORT_BIT_RATE_REQ              0x09  // Needs SNP support
 #define SNP_TEST_REQ                           0x10
 
 //! \brief list of indication/response for the device subgroup
@@ -96,6 +97,7 @@ enum SNP_CMD1_HDR_TYPE {
 #define SNP_GET_STATUS_RSP                     0x06
 #define SNP_SYNC_ERROR_CMD_IND                 0x07
 #define SNP_GET_RAND_RSP                       0x08
+#define SNP_SET_PORT_BIT_RATE_RSP              0x09  // Needs SNP support
 #define SNP_TEST_RSP                           0x10
 
 //! \brief list of command for the GAP subgroup
@@ -545,6 +547,23 @@ PACKED_TYPEDEF_STRUCT
   uint32_t  rand;            //!< 32-bit Random Number generated by TRNG
 } snpGetRandRsp_t;
 
+//! @brief parameter structure for the port bit rate request.
+//!
+//! Not part of the stock SNP image. The NP answers at the current bit rate
+//! and switches to the requested one once the response has been sent.
+//! This is a packed structure. see @ref TL_Parameter for more information.
+PACKED_TYPEDEF_STRUCT
+{
+  uint32_t  bitRate;         //!< UART bit rate to switch to
+} snpSetPortBitRateReq_t;
+
+//! @brief parameter structure for the port bit rate response
+//! This is a packed structure. see @ref TL_Parameter for more information.
+PACKED_TYPEDEF_STRUCT
+{
+  uint8_t   status;          //!< status of the request (SUCCESS or Error, @ref SNP_ERRORS)
+} snpSetPortBitRateRsp_t;
+
 //! @brief parameter structure for the status query response
 //! This is a packed structure. see @ref TL_Parameter for more information.
 PACKED_TYPEDEF_STRUCT
@@ -931,6 +950,10 @@ typedef union
   //Rand
   snpGetRandRsp_t          randRsp;             //!< Get Random Number Response
 
+  //Port bit rate
+  snpSetPortBitRateReq_t   setPortBitRateReq;   //!< Set port bit rate Request.
+  snpSetPortBitRateRsp_t   setPortBitRateRsp;   //!< Set port bit rate Response.
+
   //HCI
   snpHciCmdReq_t           hciCmdReq;           //!< HCI command request
   snpHciCmdRsp_t           hciCmdRsp;           //!< HCI command response (event)
@@ -990,6 +1013,12 @@ typedef union
   snpGetGattParamReq_t     getGattParamReq;     //!< Get GATT parameter response.
   snpGetGattParamRsp_t     getGattParamRsp;     //!< Get GATT parameter request.
 
+  //Attribute values managed by the NP
+  snpSetAttrValueReq_t     setAttrValueReq;     //!< Set attribute value request.
+  snpSetAttrValueRsp_t     setAttrValueRsp;     //!< Set attribute value response.
+  snpGetAttrValueReq_t     getAttrValueReq;     //!< Get attribute value request.
+  snpGetAttrValueRsp_t     getAttrValueRsp;     //!< Get attribute value response.
+
   //CCCD Updates
   snpCharCfgUpdatedInd_t   charCfgUpdatedReq;   //!< Characteristic configuration updated indication.
   snpCharCfgUpdatedRsp_t   charcfgUpdatedRsp;   //!< Characteristic configuration update response.
@@ -0,0 +1,458 @@
+/*
+ * Copyright (c) 2015-2016, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SNP_CODEC_H
+#define SNP_CODEC_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <string.h>
+#include <ti/npi/hal_defs.h>
+
+#include "snp.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/*
+ * Wire layouts of the SNP messages, the one description of each both the
+ * packers and the parsers are generated from.
+ *
+ * SNP_LAYOUT_<name>(X, a) lists the fields of a message in wire order as
+ * X(a, kind, field). kind is U8, U16 or U32 for little-endian integers and
+ * ARR for a fixed size byte array. A message that ends in a variable length
+ * payload (pData, UUID, pDesc, handles) only lists the fields before it;
+ * its packer returns where the payload goes and its parser where it
+ * starts, so the payload is never copied twice.
+ */
+#define SNP_LAYOUT_MaskEventReq(X, a) \
+  X(a, U16, eventMask)
+
+#define SNP_LAYOUT_MaskEventRsp(X, a) \
+  X(a, U16, maskedEvent)
+
+#define SNP_LAYOUT_TestCmdRsp(X, a) \
+  X(a, U16, memAlo) \
+  X(a, U16, memMax) \
+  X(a, U16, memSize)
+
+#define SNP_LAYOUT_HciCmdReq(X, a) \
+  X(a, U16, opcode)
+
+#define SNP_LAYOUT_HciCmdRsp(X, a) \
+  X(a, U8,  status) \
+  X(a, U16, opcode)
+
+#define SNP_LAYOUT_GetRevisionRsp(X, a) \
+  X(a, U8,  status) \
+  X(a, U16, snpVer) \
+  X(a, ARR, stackBuildVer)
+
+#define SNP_LAYOUT_GetRandRsp(X, a) \
+  X(a, U32, rand)
+
+#define SNP_LAYOUT_SetPortBitRateReq(X, a) \
+  X(a, U32, bitRate)
+
+#define SNP_LAYOUT_SetPortBitRateRsp(X, a) \
+  X(a, U8,  status)
+
+#define SNP_LAYOUT_GetStatusCmdRsp(X, a) \
+  X(a, U8,  gapRoleStatus) \
+  X(a, U8,  advStatus) \
+  X(a, U8,  ATTstatus) \
+  X(a, U8,  ATTmethod)
+
+#define SNP_LAYOUT_StartAdvReq(X, a) \
+  X(a, U8,  type) \
+  X(a, U16, timeout) \
+  X(a, U16, interval) \
+  X(a, U8,  filterPolicy) \
+  X(a, U8,  initiatorAddrType) \
+  X(a, ARR, initiatorAddress) \
+  X(a, U8,  behavior)
+
+#define SNP_LAYOUT_SetAdvDataReq(X, a) \
+  X(a, U8,  type)
+
+#define SNP_LAYOUT_TermConnReq(X, a) \
+  X(a, U16, connHandle) \
+  X(a, U8,  option)
+
+#define SNP_LAYOUT_UpdateConnParamReq(X, a) \
+  X(a, U16, connHandle) \
+  X(a, U16, intervalMin) \
+  X(a, U16, intervalMax) \
+  X(a, U16, slaveLatency) \
+  X(a, U16, supervisionTimeout)
+
+#define SNP_LAYOUT_UpdateConnParamCnf(X, a) \
+  X(a, U8,  status) \
+  X(a, U16, connHandle)
+
+// Also the Get GAP Parameter request, whose value the NP ignores.
+#define SNP_LAYOUT_SetGapParamReq(X, a) \
+  X(a, U16, paramId) \
+  X(a, U16, value)
+
+#define SNP_LAYOUT_GetGapParamRsp(X, a) \
+  X(a, U8,  status) \
+  X(a, U16, paramId) \
+  X(a, U16, value)
+
+// Shares its struct with the GAP parameter requests, but both fields are
+// single bytes on the wire.
+#define SNP_LAYOUT_SetSecParamReq(X, a) \
+  X(a, U8,  paramId) \
+  X(a, U8,  value)
+
+#define SNP_LAYOUT_SetAuthDataReq(X, a) \
+  X(a, U32, authData)
+
+#define SNP_LAYOUT_SetWhiteListReq(X, a) \
+  X(a, U8,  useWhiteList)
+
+#define SNP_LAYOUT_AddServiceReq(X, a) \
+  X(a, U8,  type)
+
+#define SNP_LAYOUT_AddCharValueDeclReq(X, a) \
+  X(a, U8,  charValPerms) \
+  X(a, U16, charValProps) \
+  X(a, U8,  mgmtOption) \
+  X(a, U16, charValMaxLen)
+
+#define SNP_LAYOUT_AddCharValueDeclRsp(X, a) \
+  X(a, U8,  status) \
+  X(a, U16, attrHandle)
+
+#define SNP_LAYOUT_AddAttrCccd(X, a) \
+  X(a, U8,  perms)
+
+#define SNP_LAYOUT_AddAttrFormat(X, a) \
+  X(a, U8,  format) \
+  X(a, U8,  exponent) \
+  X(a, U16, unit) \
+  X(a, U8,  name_space) \
+  X(a, U16, desc)
+
+#define SNP_LAYOUT_AddAttrUserDesc(X, a) \
+  X(a, U8,  perms) \
+  X(a, U16, maxLen) \
+  X(a, U16, initLen)
+
+#define SNP_LAYOUT_AddAttrGenShortUUID(X, a) \
+  X(a, U8,  perms) \
+  X(a, U16, maxLen) \
+  X(a, ARR, UUID)
+
+#define SNP_LAYOUT_AddAttrGenLongUUID(X, a) \
+  X(a, U8,  perms) \
+  X(a, U16, maxLen) \
+  X(a, ARR, UUID)
+
+#define SNP_LAYOUT_AddCharDescDeclRsp(X, a) \
+  X(a, U8,  status) \
+  X(a, U8,  header)
+
+#define SNP_LAYOUT_RegisterServiceRsp(X, a) \
+  X(a, U8,  status) \
+  X(a, U16, startHandle) \
+  X(a, U16, endHandle)
+
+#define SNP_LAYOUT_CharReadInd(X, a) \
+  X(a, U16, connHandle) \
+  X(a, U16, attrHandle) \
+  X(a, U16, offset) \
+  X(a, U16, maxSize)
+
+#define SNP_LAYOUT_CharReadCnf(X, a) \
+  X(a, U8,  status) \
+  X(a, U16, connHandle) \
+  X(a, U16, attrHandle) \
+  X(a, U16, offset)
+
+#define SNP_LAYOUT_CharWriteInd(X, a) \
+  X(a, U16, connHandle) \
+  X(a, U16, attrHandle) \
+  X(a, U8,  rspNeeded) \
+  X(a, U16, offset)
+
+// Also the CCCD update and notification/indication confirmations.
+#define SNP_LAYOUT_CharWriteCnf(X, a) \
+  X(a, U8,  status) \
+  X(a, U16, connHandle)
+
+#define SNP_LAYOUT_NotifIndReq(X, a) \
+  X(a, U16, connHandle) \
+  X(a, U16, attrHandle) \
+  X(a, U8,  authenticate) \
+  X(a, U8,  type)
+
+// Every response that only carries a status.
+#define SNP_LAYOUT_StatusRsp(X, a) \
+  X(a, U8,  status)
+
+// Also the Get GATT Parameter response.
+#define SNP_LAYOUT_SetGattParamReq(X, a) \
+  X(a, U8,  serviceID) \
+  X(a, U8,  paramID)
+
+#define SNP_LAYOUT_GetGattParamReq(X, a) \
+  X(a, U8,  serviceID) \
+  X(a, U8,  paramID)
+
+#define SNP_LAYOUT_SetAttrValueReq(X, a) \
+  X(a, U16, attrHandle)
+
+#define SNP_LAYOUT_SetAttrValueRsp(X, a) \
+  X(a, U8,  status) \
+  X(a, U16, attrHandle)
+
+#define SNP_LAYOUT_GetAttrValueReq(X, a) \
+  X(a, U16, attrHandle)
+
+#define SNP_LAYOUT_GetAttrValueRsp(X, a) \
+  X(a, U8,  status) \
+  X(a, U16, attrHandle)
+
+#define SNP_LAYOUT_CharCfgUpdatedInd(X, a) \
+  X(a, U16, connHandle) \
+  X(a, U16, cccdHandle) \
+  X(a, U8,  rspNeeded) \
+  X(a, U16, value)
+
+// Event parameters, which follow the 16 bit event code of SNP_EVENT_IND.
+#define SNP_LAYOUT_ConnEstEvt(X, a) \
+  X(a, U16, connHandle) \
+  X(a, U16, connInterval) \
+  X(a, U16, slaveLatency) \
+  X(a, U16, supervisionTimeout) \
+  X(a, U8,  addressType) \
+  X(a, ARR, pAddr)
+
+#define SNP_LAYOUT_ConnTermEvt(X, a) \
+  X(a, U16, connHandle) \
+  X(a, U8,  reason)
+
+#define SNP_LAYOUT_UpdateConnParamEvt(X, a) \
+  X(a, U16, connHandle) \
+  X(a, U16, connInterval) \
+  X(a, U16, slaveLatency) \
+  X(a, U16, supervisionTimeout)
+
+#define SNP_LAYOUT_AdvStatusEvt(X, a) \
+  X(a, U8,  status)
+
+#define SNP_LAYOUT_SecurityEvt(X, a) \
+  X(a, U8,  state) \
+  X(a, U8,  status)
+
+#define SNP_LAYOUT_ErrorEvt(X, a) \
+  X(a, U16, opcode) \
+  X(a, U8,  status)
+
+#define SNP_LAYOUT_ATTMTUSizeEvt(X, a) \
+  X(a, U16, connHandle) \
+  X(a, U16, attMtuSize)
+
+#define SNP_LAYOUT_AuthenticationEvt(X, a) \
+  X(a, U8,  display) \
+  X(a, U8,  input) \
+  X(a, U32, numCmp)
+
+/*
+ * Every message with a layout, as X(name, type). Each gets
+ * SNP_pack<name>(), SNP_unpack<name>() and SNP_LEN_<name>, the number of
+ * bytes its listed fields take on the wire.
+ */
+#define SNP_CODECS(X) \
+  X(MaskEventReq,        snpMaskEventReq_t) \
+  X(MaskEventRsp,        snpMaskEventRsp_t) \
+  X(TestCmdRsp,          snpTestCmdRsp_t) \
+  X(HciCmdReq,           snpHciCmdReq_t) \
+  X(HciCmdRsp,           snpHciCmdRsp_t) \
+  X(GetRevisionRsp,      snpGetRevisionRsp_t) \
+  X(GetRandRsp,          snpGetRandRsp_t) \
+  X(SetPortBitRateReq,   snpSetPortBitRateReq_t) \
+  X(SetPortBitRateRsp,   snpSetPortBitRateRsp_t) \
+  X(GetStatusCmdRsp,     snpGetStatusCmdRsp_t) \
+  X(StartAdvReq,         snpStartAdvReq_t) \
+  X(SetAdvDataReq,       snpSetAdvDataReq_t) \
+  X(TermConnReq,         snpTermConnReq_t) \
+  X(UpdateConnParamReq,  snpUpdateConnParamReq_t) \
+  X(UpdateConnParamCnf,  snpUpdateConnParamCnf_t) \
+  X(SetGapParamReq,      snpSetGapParamReq_t) \
+  X(GetGapParamRsp,      snpGetGapParamRsp_t) \
+  X(SetSecParamReq,      snpSetSecParamReq_t) \
+  X(SetAuthDataReq,      snpSetAuthDataReq_t) \
+  X(SetWhiteListReq,     snpSetWhiteListReq_t) \
+  X(AddServiceReq,       snpAddServiceReq_t) \
+  X(AddCharValueDeclReq, snpAddCharValueDeclReq_t) \
+  X(AddCharValueDeclRsp, snpAddCharValueDeclRsp_t) \
+  X(AddAttrCccd,         snpAddAttrCccd_t) \
+  X(AddAttrFormat,       snpAddAttrFormat_t) \
+  X(AddAttrUserDesc,     snpAddAttrUserDesc_t) \
+  X(AddAttrGenShortUUID, snpAddAttrGenShortUUID_t) \
+  X(AddAttrGenLongUUID,  snpAddAttrGenLongUUID_t) \
+  X(AddCharDescDeclRsp,  snpAddCharDescDeclRsp_t) \
+  X(RegisterServiceRsp,  snpRegisterServiceRsp_t) \
+  X(CharReadInd,         snpCharReadInd_t) \
+  X(CharReadCnf,         snpCharReadCnf_t) \
+  X(CharWriteInd,        snpCharWriteInd_t) \
+  X(CharWriteCnf,        snpCharWriteCnf_t) \
+  X(NotifIndReq,         snpNotifIndReq_t) \
+  X(StatusRsp,           snpSetGattParamRsp_t) \
+  X(SetGattParamReq,     snpSetGattParamReq_t) \
+  X(GetGattParamReq,     snpGetGattParamReq_t) \
+  X(SetAttrValueReq,     snpSetAttrValueReq_t) \
+  X(SetAttrValueRsp,     snpSetAttrValueRsp_t) \
+  X(GetAttrValueReq,     snpGetAttrValueReq_t) \
+  X(GetAttrValueRsp,     snpGetAttrValueRsp_t) \
+  X(CharCfgUpdatedInd,   snpCharCfgUpdatedInd_t) \
+  X(ConnEstEvt,          snpConnEstEvt_t) \
+  X(ConnTermEvt,         snpConnTermEvt_t) \
+  X(UpdateConnParamEvt,  snpUpdateConnParamEvt_t) \
+  X(AdvStatusEvt,        snpAdvStatusEvt_t) \
+  X(SecurityEvt,         snpSecurityEvt_t) \
+  X(ErrorEvt,            snpErrorEvt_t) \
+  X(ATTMTUSizeEvt,       snpATTMTUSizeEvt_t) \
+  X(AuthenticationEvt,   snpAuthenticationEvt_t)
+
+/*********************************************************************
+ * MACROS
+ */
+
+// Bytes each kind of field takes on the wire
+#define SNP_WIRE_LEN_U8(type, field)   1
+#define SNP_WIRE_LEN_U16(type, field)  2
+#define SNP_WIRE_LEN_U32(type, field)  4
+#define SNP_WIRE_LEN_ARR(type, field)  sizeof(((type *)0)->field)
+
+// Write a field at pBuf and step past it
+#define SNP_PUT_U8(pBuf, v)  (*(pBuf)++ = (uint8_t)(v))
+#define SNP_PUT_U16(pBuf, v) (SNP_PUT_U8(pBuf, LO_UINT16(v)), \
+                              SNP_PUT_U8(pBuf, HI_UINT16(v)))
+#define SNP_PUT_U32(pBuf, v) (SNP_PUT_U8(pBuf, BREAK_UINT32(v, 0)), \
+                              SNP_PUT_U8(pBuf, BREAK_UINT32(v, 1)), \
+                              SNP_PUT_U8(pBuf, BREAK_UINT32(v, 2)), \
+                              SNP_PUT_U8(pBuf, BREAK_UINT32(v, 3)))
+#define SNP_PUT_ARR(pBuf, v) (memcpy((pBuf), (v), sizeof(v)), \
+                              (pBuf) += sizeof(v))
+
+// Read a field at pBuf and step past it
+#define SNP_GET_U8(pBuf, v)  ((v) = *(pBuf)++)
+#define SNP_GET_U16(pBuf, v) ((v) = BUILD_UINT16((pBuf)[0], (pBuf)[1]), \
+                              (pBuf) += 2)
+#define SNP_GET_U32(pBuf, v) ((v) = BUILD_UINT32((pBuf)[0], (pBuf)[1], \
+                                                 (pBuf)[2], (pBuf)[3]), \
+                              (pBuf) += 4)
+#define SNP_GET_ARR(pBuf, v) (memcpy((v), (pBuf), sizeof(v)), \
+                              (pBuf) += sizeof(v))
+
+// Per field steps of the generated code
+#define SNP_FIELD_LEN(type, kind, field) + SNP_WIRE_LEN_##kind(type, field)
+#define SNP_FIELD_PUT(pMsg, kind, field) SNP_PUT_##kind(pBuf, (pMsg)->field);
+#define SNP_FIELD_GET(pMsg, kind, field) SNP_GET_##kind(pBuf, (pMsg)->field);
+
+#define SNP_CODEC_LEN(name, type) \
+  SNP_LEN_##name = 0 SNP_LAYOUT_##name(SNP_FIELD_LEN, type),
+
+#define SNP_CODEC_PROTOTYPES(name, type) \
+  extern uint8_t *SNP_pack##name(uint8_t *pBuf, const type *pMsg); \
+  extern const uint8_t *SNP_unpack##name(const uint8_t *pBuf, type *pMsg);
+
+#define SNP_CODEC_FUNCTIONS(name, type) \
+  uint8_t *SNP_pack##name(uint8_t *pBuf, const type *pMsg) \
+  { \
+    SNP_LAYOUT_##name(SNP_FIELD_PUT, pMsg) \
+    return pBuf; \
+  } \
+  const uint8_t *SNP_unpack##name(const uint8_t *pBuf, type *pMsg) \
+  { \
+    SNP_LAYOUT_##name(SNP_FIELD_GET, pMsg) \
+    return pBuf; \
+  }
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+enum
+{
+  SNP_CODECS(SNP_CODEC_LEN)
+};
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      SNP_pack<name>
+ *
+ * @brief   Write the fields of a message in wire order. Used by the AP
+ *          for requests, and by a simulated NP for responses and events.
+ *
+ * @param   pBuf - where the message goes, e.g. the pData of an NPI frame
+ * @param   pMsg - message to write
+ *
+ * @return  uint8_t * - first byte after the fields, where any payload goes
+ *
+ *********************************************************************
+ * @fn      SNP_unpack<name>
+ *
+ * @brief   Read the fields of a message from the wire into pMsg. Pointer
+ *          members are left alone.
+ *
+ * @param   pBuf - message as received, e.g. the pData of an NPI frame
+ * @param   pMsg - where the fields go
+ *
+ * @return  const uint8_t * - first byte after the fields, where any
+ *                            payload starts
+ */
+SNP_CODECS(SNP_CODEC_PROTOTYPES)
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SNP_CODEC_H */
@@ -36,9 +36,13 @@
 #include <string.h>
 #include <stdint.h>
 #include <ti/npi/hal_defs.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Task.h>
 
 #include <ti/npi/npi_task.h>
 #include <ti/npi/npi_data.h>
+#include "snp_codec.h"
 #include "snp_rpc_synchro.h"
 #include "snp_rpc.h"
 
@@ -58,16 +62,27 @@ uint8_t SNP_NumConns = 0;
 
 #ifdef SNP_LOCAL
 #define MALLOC_FRAME(paramLen) SNP_mallocNPIFrame(paramLen)
+#define FREE_FRAME(pPkt)       SNP_free(pPkt)
 #define SEND_MESSAGE(pReq)     SAP_SendMessage(pReq)
+#define SEND_ASYNC(pPkt)       (SAP_SendMessage(pPkt), NPI_SUCCESS)
 #define ENTER_CS()
 #define EXIT_CS()
 #else //!SNP_LOCAL
 #define MALLOC_FRAME(paramLen) NPITask_mallocFrame(paramLen)
+#define FREE_FRAME(pPkt)       NPITask_freeFrame(pPkt)
 #define SEND_MESSAGE(pReq)     NPITask_sendToHost(pReq)
+#define SEND_ASYNC(pPkt)       NPITask_sendToHostLane(pPkt, SNP_asyncLane(pPkt))
 #define ENTER_CS()             SNP_enterCS()
 #define EXIT_CS()              SNP_exitCS()
 #endif //SNP_LOCAL
 
+// Response opcode the NP answers a synchronous request with
+#define SNP_RSP_OPCODE(req)    (((req) == SNP_GET_RAND_REQ) ? \
+                                SNP_GET_RAND_RSP : (req))
+
+// Bytes of a notification request ahead of its data payload
+#define NOTIF_IND_REQ_LEN      SNP_LEN_NotifIndReq
+
 
 
 /*********************************************************************
@@ -82,6 +97,10 @@ SNP_RPC_eventCBRouter_t SNP_eventCB = NULL;
 // Applications must register there own callbacks for this callback to pass them on.
 SNP_RPC_asyncCB_t SNP_asyncCB = NULL;
 
+// Callback function to the NP API offered characteristic writes before they
+// go through the SAP service table.
+SNP_RPC_fastWriteCB_t SNP_fastWriteCB = NULL;
+
 /*********************************************************************
  * LOCAL VARIABLES
  */
@@ -90,46 +109,158 @@ SNP_RPC_asyncCB_t SNP_asyncCB = NULL;
 // when it arrives.
 snpSyncRspData_t npiRetMsg;
 
+// Read confirmation handed out by SNP_RPC_allocReadCharCnf, not sent yet.
+static _npiFrame_t *pReadCnfPkt = NULL;
+
+#ifndef SNP_LOCAL
+// A synchronous request queued by a batch, and where its response goes
+typedef struct
+{
+  _npiFrame_t *pReq;
+  uint8_t     opcode;
+  snp_msg_t   *pRsp;
+  uint16_t    *rspLen;
+} snpSyncBatchEntry_t;
+
+// Requests of the open or sending batch. Filled in by the requesting task
+// before any is sent, then only read by the NPI task.
+static snpSyncBatchEntry_t syncBatch[SNP_SYNC_BATCH_DEPTH];
+static uint8_t syncBatchCount = 0;
+static bool syncBatchOpen = false;
+static Task_Handle syncBatchTask = NULL;
+
+// Entry of the sending batch whose response is due next
+static uint8_t syncBatchNext = 0;
+#endif //SNP_LOCAL
+
+#ifndef SNP_LOCAL
+// System ticks a synchronous request waits for its response, 0 for
+// SNP_SYNC_RSP_TIMEOUT.
+static uint32_t syncRspTimeout = 0;
+#endif //SNP_LOCAL
+
 /*********************************************************************
  * HELPER FUNCTIONS
  */
 
 #ifndef SNP_LOCAL
-static void SNP_sendSynchronousCmd(_npiFrame_t *pReq, uint8_t opcode,
-                                   snp_msg_t *pRsp, uint16_t *rspLen)
+/*
+ Send a synchronous request and wait up to timeout system ticks for its
+ response. On a timeout the request is cancelled so NPI stops waiting for
+ it, and an answer still arriving later is dropped instead of being copied
+ into pRsp or taken for the answer to a later request.
+ */
+static uint8_t SNP_sendSynchronousCmdTimeout(_npiFrame_t *pReq, uint8_t opcode,
+                                             snp_msg_t *pRsp, uint16_t *rspLen,
+                                             uint32_t timeout)
 {
+  uint8_t status = SNP_SUCCESS;
+
   // Enter Critical Section.
   ENTER_CS();
 
   npiRetMsg.pMsg = pRsp;
+  npiRetMsg.opcode = SNP_RSP_OPCODE(opcode);
+  npiRetMsg.status = SNP_SUCCESS;
+  npiRetMsg.cap = rspLen ? *rspLen : 0;
 
   // Send command.
   SEND_MESSAGE(pReq);
 
-  // Wait for a response from the NP.
-  SNP_waitForResponse();
+  // Wait for a response from the NP, but not forever.
+  if (!SNP_waitForResponseTimeout(timeout))
+  {
+    // The NPI Task runs at a higher priority, so it is not part way through
+    // the response here. Once opcode is cleared none is copied, but one may
+    // have come in since the wait gave up.
+    npiRetMsg.opcode = 0;
+    if (!SNP_waitForResponseTimeout(0))
+    {
+      npiRetMsg.pMsg = NULL;
+      NPITask_cancelSyncReq();
+      status = SNP_FAILURE;
+    }
+  }
+
+  // The NP does not know the request and sent no response
+  if (status == SNP_SUCCESS)
+  {
+    status = npiRetMsg.status;
+  }
 
   // Update Length after response is received
-  if (rspLen)
+  if (status == SNP_SUCCESS && rspLen)
   {
     *rspLen = npiRetMsg.len;
   }
 
   // Exit Critical Section
   EXIT_CS();
+
+  return status;
+}
+
+static uint8_t SNP_sendSynchronousCmd(_npiFrame_t *pReq, uint8_t opcode,
+                                      snp_msg_t *pRsp, uint16_t *rspLen)
+{
+  // Hold the request back while this task has a batch open
+  if (syncBatchOpen && syncBatchTask == Task_self())
+  {
+    snpSyncBatchEntry_t *pEntry;
+
+    if (syncBatchCount == SNP_SYNC_BATCH_DEPTH)
+    {
+      FREE_FRAME(pReq);
+      return SNP_OUT_OF_RESOURCES;
+    }
+
+    pEntry = &syncBatch[syncBatchCount++];
+    pEntry->pReq = pReq;
+    pEntry->opcode = SNP_RSP_OPCODE(opcode);
+    pEntry->pRsp = pRsp;
+    pEntry->rspLen = rspLen;
+    return SNP_SUCCESS;
+  }
+
+  return SNP_sendSynchronousCmdTimeout(pReq, opcode, pRsp, rspLen,
+                                       syncRspTimeout ? syncRspTimeout :
+                                                        SNP_SYNC_RSP_TIMEOUT);
+}
+
+/*
+ Pick the NPI TX lane of an async command: confirmations the NP is holding a
+ client request for, notification data, and everything else.
+ */
+static uint8_t SNP_asyncLane(_npiFrame_t *pPkt)
+{
+  switch (pPkt->cmd1)
+  {
+    case SNP_CHAR_READ_CNF:
+    case SNP_CHAR_WRITE_CNF:
+    case SNP_CCCD_UPDATED_CNF:
+      return NPITASK_LANE_CNF;
+    case SNP_SEND_NOTIF_IND_REQ:
+      return NPITASK_LANE_BULK;
+    default:
+      return NPITASK_LANE_CONTROL;
+  }
 }
 #endif //SNP_LOCAL
 
-static void SNP_sendAsyncCmd(_npiFrame_t *pPkt)
+static uint8_t SNP_sendAsyncCmd(_npiFrame_t *pPkt)
 {
+  uint8_t status;
+
   // Enter Critical Section.
   ENTER_CS();
 
   // Send command.
-  SEND_MESSAGE(pPkt);
+  status = SEND_ASYNC(pPkt);
 
   // Exit Critical section
   EXIT_CS();
+
+  return status;
 }
 
 /*
@@ -170,6 +301,176 @@ void SNP_RPC_registerSAPCBs(SNP_RPC_asyncCB_t asyncCB,
   SNP_eventCB = eventCB;
 }
 
+/*********************************************************************
+ * @fn      SNP_RPC_registerFastWriteCB
+ *
+ * @brief   Register a callback offered every characteristic write
+ *          indication ahead of the SAP service table. It runs in the
+ *          NPI task, and returns true if it handled the write, including
+ *          the write confirmation.
+ *
+ * @param   fastWriteCB - pointer to fast write call back function, or NULL
+ *
+ * @return  none
+ */
+void SNP_RPC_registerFastWriteCB(SNP_RPC_fastWriteCB_t fastWriteCB)
+{
+  SNP_fastWriteCB = fastWriteCB;
+}
+
+#ifndef SNP_LOCAL
+/*********************************************************************
+ * @fn      SNP_RPC_setSyncTimeout
+ *
+ * @brief   Set how long synchronous requests wait for their response
+ *
+ * @param   timeout - system ticks, BIOS_WAIT_FOREVER to never give up,
+ *                    0 for SNP_SYNC_RSP_TIMEOUT
+ *
+ * @return  none
+ */
+void SNP_RPC_setSyncTimeout(uint32_t timeout)
+{
+  syncRspTimeout = timeout;
+}
+#endif //SNP_LOCAL
+
+#ifndef SNP_LOCAL
+/*********************************************************************
+ * @fn      SNP_RPC_beginSyncBatch
+ *
+ * @brief   Queue synchronous requests until SNP_RPC_endSyncBatch
+ *
+ * @return  none
+ */
+void SNP_RPC_beginSyncBatch(void)
+{
+  // Keep other tasks' requests out until the batch is answered
+  ENTER_CS();
+
+  syncBatchCount = 0;
+  syncBatchTask = Task_self();
+  syncBatchOpen = true;
+}
+#endif //SNP_LOCAL
+
+#ifndef SNP_LOCAL
+/*********************************************************************
+ * @fn      SNP_RPC_endSyncBatch
+ *
+ * @brief   Send the queued requests and wait for all their responses
+ *
+ * @return  uint8_t - SNP_SUCCESS, SNP_FAILURE on a timeout, SNP_CMD_REJECTED
+ *                    if the NP did not know one of the requests
+ */
+uint8_t SNP_RPC_endSyncBatch(void)
+{
+  uint8_t status = SNP_SUCCESS;
+  uint32_t timeout = syncRspTimeout ? syncRspTimeout : SNP_SYNC_RSP_TIMEOUT;
+  uint8_t i;
+
+  syncBatchOpen = false;
+
+  if (syncBatchCount)
+  {
+    // Each request gets the usual time for its response
+    if (timeout != BIOS_WAIT_FOREVER)
+    {
+      timeout *= syncBatchCount;
+    }
+
+    syncBatchNext = 0;
+    npiRetMsg.pMsg = syncBatch[0].pRsp;
+    npiRetMsg.opcode = syncBatch[0].opcode;
+    npiRetMsg.status = SNP_SUCCESS;
+    npiRetMsg.cap = syncBatch[0].rspLen ? *syncBatch[0].rspLen : 0;
+
+    // The NPI Task holds each request back until the previous one is
+    // answered, then sends it without waiting for this task.
+    for (i = 0; i < syncBatchCount; i++)
+    {
+      SEND_MESSAGE(syncBatch[i].pReq);
+    }
+
+    // Wait for the last response. See SNP_sendSynchronousCmdTimeout.
+    // Cancelling also frees the requests not sent yet, so the NP does not
+    // go on with a batch reported as failed.
+    if (!SNP_waitForResponseTimeout(timeout))
+    {
+      npiRetMsg.opcode = 0;
+      if (!SNP_waitForResponseTimeout(0))
+      {
+        npiRetMsg.pMsg = NULL;
+        NPITask_cancelSyncReq();
+        status = SNP_FAILURE;
+      }
+    }
+
+    // A request the NP did not know fails the batch
+    if (status == SNP_SUCCESS)
+    {
+      status = npiRetMsg.status;
+    }
+  }
+
+  syncBatchCount = 0;
+
+  // Exit Critical Section
+  EXIT_CS();
+
+  return status;
+}
+#endif //SNP_LOCAL
+
+#ifndef SNP_LOCAL
+/*********************************************************************
+ * @fn      SNP_RPC_syncBatchRoom
+ *
+ * @brief   Requests the open batch can still queue
+ *
+ * @return  uint8_t - free batch entries
+ */
+uint8_t SNP_RPC_syncBatchRoom(void)
+{
+  return syncBatchOpen ? SNP_SYNC_BATCH_DEPTH - syncBatchCount : 0;
+}
+#endif //SNP_LOCAL
+
+#ifndef SNP_LOCAL
+/*********************************************************************
+ * @fn      SNP_RPC_syncRspReceived
+ *
+ * @brief   Finish the response to the pending synchronous request
+ *
+ * @return  none
+ */
+void SNP_RPC_syncRspReceived(void)
+{
+  // Runs in the NPI Task; the requesting task only looks at the batch again
+  // once it is woken up.
+  if (syncBatchNext < syncBatchCount)
+  {
+    if (syncBatch[syncBatchNext].rspLen)
+    {
+      *syncBatch[syncBatchNext].rspLen = npiRetMsg.len;
+    }
+
+    if (++syncBatchNext < syncBatchCount)
+    {
+      npiRetMsg.pMsg = syncBatch[syncBatchNext].pRsp;
+      npiRetMsg.opcode = syncBatch[syncBatchNext].opcode;
+      npiRetMsg.cap = syncBatch[syncBatchNext].rspLen ?
+                      *syncBatch[syncBatchNext].rspLen : 0;
+      return;
+    }
+  }
+
+  // This is a synchronous response, signal the application who requested this.
+  npiRetMsg.opcode = 0;
+  SNP_responseReceived();
+}
+#endif //SNP_LOCAL
+
 /*********************************************************************
  * API FUNCTIONS
  */
@@ -193,18 +494,16 @@ uint8_t SNP_RPC_maskEvent(snpMaskEventReq_t *pReq,
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE , SNP_MASK_EVT_REQ,
-                            sizeof(snpMaskEventReq_t));
+                            SNP_LEN_MaskEventReq);
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
     // Initialize Request packet
-    pPkt->pData[0] = LO_UINT16(pReq->eventMask);
-    pPkt->pData[1] = HI_UINT16(pReq->eventMask);
+    SNP_packMaskEventReq(pPkt->pData, pReq);
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_MASK_EVT_REQ, (snp_msg_t *)pRsp,NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_MASK_EVT_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -232,10 +531,9 @@ uint8_t SNP_RPC_getRevision(snpGetRevisionRsp_t *pRsp)
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_GET_REVISION_REQ, (snp_msg_t *)pRsp, NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_GET_REVISION_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -263,10 +561,9 @@ uint8_t SNP_RPC_getRand(snpGetRandRsp_t *pRsp)
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_GET_RAND_REQ, (snp_msg_t *)pRsp, NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_GET_RAND_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -288,23 +585,18 @@ uint8_t SNP_RPC_getRand(snpGetRandRsp_t *pRsp)
 uint8_t SNP_RPC_sendHCICommand(snpHciCmdReq_t *pReq, uint8_t paramLen)
 {
   _npiFrame_t *pPkt;
-  uint16_t reqSize = sizeof(snpHciCmdReq_t) - sizeof(pReq->pData);
   uint8_t status = SNP_OUT_OF_RESOURCES;
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_HCI_CMD_REQ,
-                            paramLen + reqSize);
+                            SNP_LEN_HciCmdReq + paramLen);
 
   if ( pPkt )
   {
     status = SNP_SUCCESS;
 
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = LO_UINT16(pReq->opcode);
-    pPkt->pData[1] = HI_UINT16(pReq->opcode);
-
-    // Copy pointer members
-    memcpy(&pPkt->pData[reqSize], pReq->pData, paramLen);
+    // Copy the request, then its parameters behind it
+    memcpy(SNP_packHciCmdReq(pPkt->pData, pReq), pReq->pData, paramLen);
 
     // Send param
     SNP_sendAsyncCmd(pPkt);
@@ -335,10 +627,81 @@ uint8_t SNP_RPC_getStatus(snpGetStatusCmdRsp_t *pRsp)
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
+    // Send a synchronous command.
+    status = SNP_sendSynchronousCmd(pPkt, SNP_GET_STATUS_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
+  }
 
+  // Return Status
+  return status;
+}
+#endif //SNP_LOCAL
+
+#ifndef SNP_LOCAL
+/*********************************************************************
+ * @fn      SNP_RPC_getStatusTimeout
+ *
+ * @brief   Get SNP status, giving up if the NP does not answer in time
+ *
+ * @param   pRsp    - pointer to SNP response message
+ * @param   timeout - system ticks to wait for the response
+ *
+ * @return  uint8_t - SNP_SUCCESS, SNP_FAILURE if no response arrived
+ */
+uint8_t SNP_RPC_getStatusTimeout(snpGetStatusCmdRsp_t *pRsp, uint32_t timeout)
+{
+  _npiFrame_t *pPkt;
+  uint8_t status = SNP_OUT_OF_RESOURCES;
+
+  // Allocated an empty data NPI packet.
+  pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_GET_STATUS_REQ, 0);
+
+  if ( pPkt )
+  {
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_GET_STATUS_REQ, (snp_msg_t *)pRsp, NULL);
+    status = SNP_sendSynchronousCmdTimeout(pPkt, SNP_GET_STATUS_REQ,
+                                           (snp_msg_t *)pRsp, NULL, timeout);
+  }
+
+  // Return Status
+  return status;
+}
+#endif //SNP_LOCAL
+
+#ifndef SNP_LOCAL
+/*********************************************************************
+ * @fn      SNP_RPC_setPortBitRate
+ *
+ * @brief   Ask the NP to move its UART to a new bit rate. The NP answers
+ *          at the current bit rate and switches afterwards. Needs an SNP
+ *          image implementing SNP_SET_PORT_BIT_RATE_REQ; the stock image
+ *          answers with SNP_SYNC_ERROR_CMD_IND instead.
+ *
+ * @param   pReq    - pointer to SNP request message
+ * @param   pRsp    - pointer to SNP response message
+ * @param   timeout - system ticks to wait for the response
+ *
+ * @return  uint8_t - SNP_SUCCESS, SNP_FAILURE if no response arrived,
+ *                    SNP_CMD_REJECTED if the NP does not know the request
+ */
+uint8_t SNP_RPC_setPortBitRate(snpSetPortBitRateReq_t *pReq,
+                               snpSetPortBitRateRsp_t *pRsp, uint32_t timeout)
+{
+  _npiFrame_t *pPkt;
+  uint8_t status = SNP_OUT_OF_RESOURCES;
+
+  // Allocated an empty data NPI packet.
+  pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_SET_PORT_BIT_RATE_REQ,
+                            SNP_LEN_SetPortBitRateReq);
+
+  if ( pPkt )
+  {
+    // Initialize Request packet
+    SNP_packSetPortBitRateReq(pPkt->pData, pReq);
+
+    // Send a synchronous command.
+    status = SNP_sendSynchronousCmdTimeout(pPkt, SNP_SET_PORT_BIT_RATE_REQ,
+                                           (snp_msg_t *)pRsp, NULL, timeout);
   }
 
   // Return Status
@@ -401,23 +764,14 @@ uint8_t SNP_RPC_startAdvertising(snpStartAdvReq_t *pReq)
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_START_ADV_REQ,
-                            sizeof(snpStartAdvReq_t));
+                            SNP_LEN_StartAdvReq);
 
   if ( pPkt )
   {
     status = SNP_SUCCESS;
 
     // Copy members of request struct into packet
-    pPkt->pData[0] = pReq->type;
-    pPkt->pData[1] = LO_UINT16(pReq->timeout);
-    pPkt->pData[2] = HI_UINT16(pReq->timeout);
-    pPkt->pData[3] = LO_UINT16(pReq->interval);
-    pPkt->pData[4] = HI_UINT16(pReq->interval);
-    pPkt->pData[5] = pReq->filterPolicy;
-    pPkt->pData[6] = pReq->initiatorAddrType;
-    memcpy(&pPkt->pData[7], pReq->initiatorAddress,
-           sizeof(pReq->initiatorAddress));
-    pPkt->pData[13] = pReq->behavior;
+    SNP_packStartAdvReq(pPkt->pData, pReq);
 
     // Send Command
     SNP_sendAsyncCmd(pPkt);
@@ -475,21 +829,17 @@ uint8_t SNP_RPC_setAdvertisementData(snpSetAdvDataReq_t *pReq, uint8_t datalen)
   // Prepare Command
   _npiFrame_t *pPkt;
   uint8_t status = SNP_OUT_OF_RESOURCES;
-  uint16_t reqSize = sizeof(snpSetAdvDataReq_t) - sizeof(pReq->pData);
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_SET_ADV_DATA_REQ,
-                            reqSize + datalen);
+                            SNP_LEN_SetAdvDataReq + datalen);
 
   if ( pPkt )
   {
     status = SNP_SUCCESS;
 
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = pReq->type;
-
-    // Copy pointer members
-    memcpy(&pPkt->pData[reqSize], pReq->pData, datalen);
+    // Copy the request, then the advertising data behind it
+    memcpy(SNP_packSetAdvDataReq(pPkt->pData, pReq), pReq->pData, datalen);
 
     // Send Command
     SNP_sendAsyncCmd(pPkt);
@@ -518,16 +868,14 @@ uint8_t SNP_RPC_terminateConnection(snpTermConnReq_t *pReq)
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_TERMINATE_CONN_REQ,
-                            sizeof(snpTermConnReq_t));
+                            SNP_LEN_TermConnReq);
 
   if ( pPkt )
   {
     status = SNP_SUCCESS;
 
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = LO_UINT16(pReq->connHandle);
-    pPkt->pData[1] = HI_UINT16(pReq->connHandle);
-    pPkt->pData[2] = pReq->option;
+    // Copy members of request struct into packet
+    SNP_packTermConnReq(pPkt->pData, pReq);
 
     // Send Command
     SNP_sendAsyncCmd(pPkt);
@@ -556,24 +904,14 @@ uint8_t SNP_RPC_updateConnectionParams(snpUpdateConnParamReq_t *pReq)
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_UPDATE_CONN_PARAM_REQ,
-                            sizeof(snpUpdateConnParamReq_t));
-
+                            SNP_LEN_UpdateConnParamReq);
 
   if ( pPkt )
   {
     status = SNP_SUCCESS;
 
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = LO_UINT16(pReq->connHandle);
-    pPkt->pData[1] = HI_UINT16(pReq->connHandle);
-    pPkt->pData[2] = LO_UINT16(pReq->intervalMin);
-    pPkt->pData[3] = HI_UINT16(pReq->intervalMin);
-    pPkt->pData[4] = LO_UINT16(pReq->intervalMax);
-    pPkt->pData[5] = HI_UINT16(pReq->intervalMax);
-    pPkt->pData[6] = LO_UINT16(pReq->slaveLatency);
-    pPkt->pData[7] = HI_UINT16(pReq->slaveLatency);
-    pPkt->pData[8] = LO_UINT16(pReq->supervisionTimeout);
-    pPkt->pData[9] = HI_UINT16(pReq->supervisionTimeout);
+    // Copy members of request struct into packet
+    SNP_packUpdateConnParamReq(pPkt->pData, pReq);
 
     // Send Command
     SNP_sendAsyncCmd(pPkt);
@@ -603,21 +941,16 @@ uint8_t SNP_RPC_setGAPparam(snpSetGapParamReq_t *pReq,
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_SET_GAP_PARAM_REQ,
-                            sizeof(snpSetGapParamReq_t));
-
+                            SNP_LEN_SetGapParamReq);
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = LO_UINT16(pReq->paramId);
-    pPkt->pData[1] = HI_UINT16(pReq->paramId);
-    pPkt->pData[2] = LO_UINT16(pReq->value);
-    pPkt->pData[3] = HI_UINT16(pReq->value);
+    // Copy members of request struct into packet
+    SNP_packSetGapParamReq(pPkt->pData, pReq);
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_SET_GAP_PARAM_REQ, (snp_msg_t *)pRsp,NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_SET_GAP_PARAM_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -644,20 +977,16 @@ uint8_t SNP_RPC_getGAPparam(snpGetGapParamReq_t *pReq,
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_GET_GAP_PARAM_REQ,
-                            sizeof(snpSetGapParamReq_t));
+                            SNP_LEN_SetGapParamReq);
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = LO_UINT16(pReq->paramId);
-    pPkt->pData[1] = HI_UINT16(pReq->paramId);
-    pPkt->pData[2] = LO_UINT16(pReq->value);
-    pPkt->pData[3] = HI_UINT16(pReq->value);
+    // Copy members of request struct into packet
+    SNP_packSetGapParamReq(pPkt->pData, pReq);
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_ADD_SERVICE_REQ, (snp_msg_t *)pRsp,NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_ADD_SERVICE_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -684,18 +1013,15 @@ uint8_t SNP_RPC_setSecurityParam(snpSetSecParamReq_t *pReq,
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_SET_SECURITY_PARAM_REQ,
-                            sizeof(snpSetSecParamReq_t));
+                            SNP_LEN_SetSecParamReq);
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
-    pPkt->pData[0] = pReq->paramId;
-    pPkt->pData[1] = pReq->value;
+    SNP_packSetSecParamReq(pPkt->pData, pReq);
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_SET_SECURITY_PARAM_REQ, (snp_msg_t *)pRsp,
-                           NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_SET_SECURITY_PARAM_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -749,25 +1075,25 @@ uint8_t SNP_RPC_setAuthenticationData(snpSetAuthDataReq_t *pReq)
 {
   snpSetAuthDataRsp_t rsp;
   _npiFrame_t *pPkt;
-  uint8_t *ptr;
   uint8_t status = SNP_OUT_OF_RESOURCES;
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE,
-                            SNP_SET_AUTHENTICATION_DATA_REQ, 4);
+                            SNP_SET_AUTHENTICATION_DATA_REQ,
+                            SNP_LEN_SetAuthDataReq);
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
-    ptr = pPkt->pData;
-    UINT32_TO_BUF_LITTLE_ENDIAN(ptr, pReq->authData);
+    SNP_packSetAuthDataReq(pPkt->pData, pReq);
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_SET_AUTHENTICATION_DATA_REQ,
-                           (snp_msg_t *)&rsp, NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_SET_AUTHENTICATION_DATA_REQ,
+                                    (snp_msg_t *)&rsp, NULL);
 
-    status = rsp.status;
+    if (status == SNP_SUCCESS)
+    {
+      status = rsp.status;
+    }
   }
 
   // Return Status
@@ -793,19 +1119,21 @@ uint8_t SNP_RPC_setWhiteListParam(snpSetWhiteListReq_t *pReq)
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE,
-                            SNP_SET_WHITE_LIST_POLICY_REQ, 1);
+                            SNP_SET_WHITE_LIST_POLICY_REQ,
+                            SNP_LEN_SetWhiteListReq);
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
-    pPkt->pData[0] = pReq->useWhiteList;
+    SNP_packSetWhiteListReq(pPkt->pData, pReq);
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_SET_WHITE_LIST_POLICY_REQ, (snp_msg_t *)&rsp,
-                           NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_SET_WHITE_LIST_POLICY_REQ,
+                                    (snp_msg_t *)&rsp, NULL);
 
-    status = rsp.status;
+    if (status == SNP_SUCCESS)
+    {
+      status = rsp.status;
+    }
   }
 
   // Return Status
@@ -830,24 +1158,19 @@ uint8_t SNP_RPC_addService(snpAddServiceReq_t *pReq, uint8_t uuidLen,
 {
   _npiFrame_t *pPkt;
   uint8_t status = SNP_OUT_OF_RESOURCES;
-  uint16_t reqSize = sizeof(snpAddServiceReq_t) - sizeof(pReq->UUID);
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_ADD_SERVICE_REQ,
-                            reqSize + uuidLen);
+                            SNP_LEN_AddServiceReq + uuidLen);
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = pReq->type;
-
-    // Copy pointer members
-    memcpy(&pPkt->pData[reqSize],pReq->UUID, uuidLen);
+    // Copy the request, then the UUID behind it
+    memcpy(SNP_packAddServiceReq(pPkt->pData, pReq), pReq->UUID, uuidLen);
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_ADD_SERVICE_REQ, (snp_msg_t *)pRsp,NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_ADD_SERVICE_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -874,30 +1197,20 @@ uint8_t SNP_RPC_addCharValueDec(snpAddCharValueDeclReq_t *pReq, uint8_t uuidLen,
 {
   _npiFrame_t *pPkt;
   uint8_t status = SNP_OUT_OF_RESOURCES;
-  uint16_t reqSize = sizeof(snpAddCharValueDeclReq_t) - sizeof(pReq->UUID);
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_ADD_CHAR_VAL_DECL_REQ,
-                            reqSize + uuidLen);
+                            SNP_LEN_AddCharValueDeclReq + uuidLen);
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = pReq->charValPerms;
-    pPkt->pData[1] = LO_UINT16(pReq->charValProps);
-    pPkt->pData[2] = HI_UINT16(pReq->charValProps);
-    pPkt->pData[3] = pReq->mgmtOption;
-    pPkt->pData[4] = LO_UINT16(pReq->charValMaxLen);
-    pPkt->pData[5] = HI_UINT16(pReq->charValMaxLen);
-
-    // Copy pointer members
-    memcpy(&pPkt->pData[reqSize], pReq->UUID, uuidLen);
+    // Copy the request, then the UUID behind it
+    memcpy(SNP_packAddCharValueDeclReq(pPkt->pData, pReq), pReq->UUID,
+           uuidLen);
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_ADD_CHAR_VAL_DECL_REQ, (snp_msg_t *)pRsp,
-                           NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_ADD_CHAR_VAL_DECL_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -924,7 +1237,7 @@ uint8_t SNP_RPC_addCharDescDec(snpAddCharDescDeclReq_t *pReq,
   _npiFrame_t *pPkt;
   uint8_t status = SNP_OUT_OF_RESOURCES;
   uint16_t pktLen = 0;
-  uint16_t pktIdx = 0;
+  uint8_t *pBuf;
 
   // Verify only sending supported Attributes
   if (pReq->header & SNP_DESC_HEADER_UNSUPPORTED_MASK)
@@ -935,16 +1248,15 @@ uint8_t SNP_RPC_addCharDescDec(snpAddCharDescDeclReq_t *pReq,
   // Determine Size of Packet
   pktLen += sizeof(pReq->header);
   pktLen += (pReq->header & SNP_DESC_HEADER_GEN_SHORT_UUID) ?
-            sizeof(snpAddAttrGenShortUUID_t) : 0;
+            SNP_LEN_AddAttrGenShortUUID : 0;
   pktLen += (pReq->header & SNP_DESC_HEADER_GEN_LONG_UUID) ?
-            sizeof(snpAddAttrGenLongUUID_t) : 0;
+            SNP_LEN_AddAttrGenLongUUID : 0;
   pktLen += (pReq->header & SNP_DESC_HEADER_CCCD) ?
-            sizeof(snpAddAttrCccd_t) : 0;
+            SNP_LEN_AddAttrCccd : 0;
   pktLen += (pReq->header & SNP_DESC_HEADER_FORMAT) ?
-            sizeof(snpAddAttrFormat_t) : 0;
+            SNP_LEN_AddAttrFormat : 0;
   pktLen += (pReq->header & SNP_DESC_HEADER_USER_DESC) ?
-            sizeof(snpAddAttrUserDesc_t) - sizeof(pReq->pUserDesc->pDesc) +
-            pReq->pUserDesc->initLen : 0;
+            SNP_LEN_AddAttrUserDesc + pReq->pUserDesc->initLen : 0;
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_ADD_CHAR_DESC_DECL_REQ,
@@ -953,70 +1265,35 @@ uint8_t SNP_RPC_addCharDescDec(snpAddCharDescDeclReq_t *pReq,
   if ( pPkt )
   {
     status = SNP_SUCCESS;
-    // Copy statically sized members of struct
-    pPkt->pData[pktIdx++] = pReq->header;
+    pBuf = pPkt->pData;
+    *pBuf++ = pReq->header;
 
-    // Short UUID
+    // Attributes follow the header in the order of its bits
     if (pReq->header & SNP_DESC_HEADER_GEN_SHORT_UUID)
     {
-      pPkt->pData[pktIdx++] = pReq->pShortUUID->perms;
-      pPkt->pData[pktIdx++] = LO_UINT16(pReq->pShortUUID->maxLen);
-      pPkt->pData[pktIdx++] = HI_UINT16(pReq->pShortUUID->maxLen);
-      pPkt->pData[pktIdx++] = pReq->pShortUUID->UUID[0];
-      pPkt->pData[pktIdx++] = pReq->pShortUUID->UUID[1];
+      pBuf = SNP_packAddAttrGenShortUUID(pBuf, pReq->pShortUUID);
     }
-
-    // Long UUID
     if (pReq->header & SNP_DESC_HEADER_GEN_LONG_UUID)
     {
-      pPkt->pData[pktIdx++] = pReq->pLongUUID->perms;
-      pPkt->pData[pktIdx++] = LO_UINT16(pReq->pLongUUID->maxLen);
-      pPkt->pData[pktIdx++] = HI_UINT16(pReq->pLongUUID->maxLen);
-
-      memcpy(&pPkt->pData[pktIdx],pReq->pLongUUID->UUID,
-             sizeof(pReq->pLongUUID->UUID));
-      pktIdx += sizeof(pReq->pLongUUID->UUID);
+      pBuf = SNP_packAddAttrGenLongUUID(pBuf, pReq->pLongUUID);
     }
-
-    // CCCD
     if (pReq->header & SNP_DESC_HEADER_CCCD)
     {
-      // Copy statically sized members of struct
-      pPkt->pData[pktIdx++] = pReq->pCCCD->perms;
+      pBuf = SNP_packAddAttrCccd(pBuf, pReq->pCCCD);
     }
-
-    // Format
     if (pReq->header & SNP_DESC_HEADER_FORMAT)
     {
-      // Copy statically sized members of struct
-      pPkt->pData[pktIdx++] = pReq->pFormat->format;
-      pPkt->pData[pktIdx++] = pReq->pFormat->exponent;
-      pPkt->pData[pktIdx++] = LO_UINT16(pReq->pFormat->unit);
-      pPkt->pData[pktIdx++] = HI_UINT16(pReq->pFormat->unit);
-      pPkt->pData[pktIdx++] = pReq->pFormat->name_space;
-      pPkt->pData[pktIdx++] = LO_UINT16(pReq->pFormat->desc);
-      pPkt->pData[pktIdx++] = HI_UINT16(pReq->pFormat->desc);
+      pBuf = SNP_packAddAttrFormat(pBuf, pReq->pFormat);
     }
-
-    // User Desc
     if (pReq->header & SNP_DESC_HEADER_USER_DESC)
     {
-      // Copy statically sized members of struct
-      pPkt->pData[pktIdx++] = pReq->pUserDesc->perms;
-      pPkt->pData[pktIdx++] = LO_UINT16(pReq->pUserDesc->maxLen);
-      pPkt->pData[pktIdx++] = HI_UINT16(pReq->pUserDesc->maxLen);
-      pPkt->pData[pktIdx++] = LO_UINT16(pReq->pUserDesc->initLen);
-      pPkt->pData[pktIdx++] = HI_UINT16(pReq->pUserDesc->initLen);
-
-      // Copy dynamic sized members of struct
-      memcpy(&pPkt->pData[pktIdx],pReq->pUserDesc->pDesc,
-             pReq->pUserDesc->initLen);
-      pktIdx += pReq->pUserDesc->initLen;
+      pBuf = SNP_packAddAttrUserDesc(pBuf, pReq->pUserDesc);
+      memcpy(pBuf, pReq->pUserDesc->pDesc, pReq->pUserDesc->initLen);
     }
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_ADD_CHAR_DESC_DECL_REQ, (snp_msg_t *)pRsp,
-                           NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_ADD_CHAR_DESC_DECL_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -1047,11 +1324,9 @@ uint8_t SNP_RPC_registerService(snpRegisterServiceRsp_t *pRsp)
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_REGISTER_SERVICE_REQ, (snp_msg_t *)pRsp,
-                           NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_REGISTER_SERVICE_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -1059,6 +1334,27 @@ uint8_t SNP_RPC_registerService(snpRegisterServiceRsp_t *pRsp)
 }
 #endif //SNP_LOCAL
 
+/*********************************************************************
+ * @fn      SNP_RPC_allocReadCharCnf
+ *
+ * @brief   Allocate the confirmation to a characteristic read request
+ *          ahead of reading the value, so it can be read straight into the
+ *          frame. Pass the returned buffer as pData to SNP_RPC_readCharCnf.
+ *          Only one may be outstanding at a time.
+ *
+ * @param   maxSize - longest value the confirmation may carry
+ *
+ * @return  uint8_t * - buffer for the value, NULL if out of memory
+ */
+uint8_t *SNP_RPC_allocReadCharCnf(uint16_t maxSize)
+{
+  // Allocated an empty data NPI packet.
+  pReadCnfPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_CHAR_READ_CNF,
+                                   SNP_LEN_CharReadCnf + maxSize);
+
+  return pReadCnfPkt ? pReadCnfPkt->pData + SNP_LEN_CharReadCnf : NULL;
+}
+
 /*********************************************************************
  * @fn      SNP_RPC_readCharCnf
  *
@@ -1072,28 +1368,37 @@ uint8_t SNP_RPC_registerService(snpRegisterServiceRsp_t *pRsp)
 uint8_t SNP_RPC_readCharCnf(snpCharReadCnf_t *pCnf, uint16_t size)
 {
   // Prepare Command
-  _npiFrame_t *pPkt;
+  _npiFrame_t *pPkt = pReadCnfPkt;
   uint8_t status = SNP_OUT_OF_RESOURCES;
-  uint16_t reqSize = sizeof(snpCharReadCnf_t) - sizeof(pCnf->pData);
 
-  // Allocated an empty data NPI packet.
-  pPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_CHAR_READ_CNF,
-                            reqSize + size);
+  pReadCnfPkt = NULL;
+  if ( pPkt && pCnf->pData == pPkt->pData + SNP_LEN_CharReadCnf )
+  {
+    // The value is already in place, trim the frame to what was read
+    pPkt->dataLen = SNP_LEN_CharReadCnf + size;
+    SNP_packCharReadCnf(pPkt->pData, pCnf);
+  }
+  else
+  {
+    if ( pPkt )
+    {
+      FREE_FRAME(pPkt);
+    }
+
+    // Allocated an empty data NPI packet.
+    pPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_CHAR_READ_CNF,
+                              SNP_LEN_CharReadCnf + size);
+
+    if ( pPkt )
+    {
+      // Copy the confirmation, then the value read behind it
+      memcpy(SNP_packCharReadCnf(pPkt->pData, pCnf), pCnf->pData, size);
+    }
+  }
 
   if ( pPkt )
   {
     status = SNP_SUCCESS;
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = pCnf->status;
-    pPkt->pData[1] = LO_UINT16(pCnf->connHandle);
-    pPkt->pData[2] = HI_UINT16(pCnf->connHandle);
-    pPkt->pData[3] = LO_UINT16(pCnf->attrHandle);
-    pPkt->pData[4] = HI_UINT16(pCnf->attrHandle);
-    pPkt->pData[5] = LO_UINT16(pCnf->offset);
-    pPkt->pData[6] = HI_UINT16(pCnf->offset);
-
-    // Copy pointer members
-    memcpy(&pPkt->pData[reqSize], pCnf->pData, size);
 
     // Send Command
     SNP_sendAsyncCmd(pPkt);
@@ -1120,15 +1425,14 @@ uint8_t SNP_RPC_writeCharCnf(snpCharWriteCnf_t *pCnf)
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_CHAR_WRITE_CNF,
-                            sizeof(snpCharWriteCnf_t));
+                            SNP_LEN_CharWriteCnf);
 
   if ( pPkt )
   {
     status = SNP_SUCCESS;
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = pCnf->status;
-    pPkt->pData[1] = LO_UINT16(pCnf->connHandle);
-    pPkt->pData[2] = HI_UINT16(pCnf->connHandle);
+
+    // Copy members of confirmation struct into packet
+    SNP_packCharWriteCnf(pPkt->pData, pCnf);
 
     // Send Command
     SNP_sendAsyncCmd(pPkt);
@@ -1153,34 +1457,82 @@ uint8_t SNP_RPC_sendNotifInd(snpNotifIndReq_t *pReq, uint8_t dataLen)
   // Prepare Command
   _npiFrame_t *pPkt;
   uint8_t status = SNP_OUT_OF_RESOURCES;
-  uint16_t reqSize = sizeof(snpNotifIndReq_t) - sizeof(pReq->pData);
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_SEND_NOTIF_IND_REQ,
-                            reqSize + dataLen);
+                            NOTIF_IND_REQ_LEN + dataLen);
 
   if ( pPkt )
   {
     status = SNP_SUCCESS;
 
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = LO_UINT16(pReq->connHandle);
-    pPkt->pData[1] = HI_UINT16(pReq->connHandle);
-    pPkt->pData[2] = LO_UINT16(pReq->attrHandle);
-    pPkt->pData[3] = HI_UINT16(pReq->attrHandle);
-    pPkt->pData[4] = pReq->authenticate;
-    pPkt->pData[5] = pReq->type;
-
-    // Copy pointer members
-    memcpy(&pPkt->pData[reqSize], pReq->pData, dataLen);
+    // Copy the request, then the value behind it
+    memcpy(SNP_packNotifIndReq(pPkt->pData, pReq), pReq->pData, dataLen);
 
-    SNP_sendAsyncCmd(pPkt);
+    // The frame is freed if NPI has no room for it
+    if (SNP_sendAsyncCmd(pPkt) != NPI_SUCCESS)
+    {
+      status = SNP_OUT_OF_RESOURCES;
+    }
   }
 
   // Return Status
   return status;
 }
 
+/*********************************************************************
+ * @fn      SNP_RPC_waitNotifIndCredit
+ *
+ * @brief   Wait until NPI has room to queue a notification of dataLen
+ *          bytes for the NP
+ *
+ * @param   dataLen - length of the notification data payload
+ * @param   timeout - system ticks to wait, BIOS_NO_WAIT or BIOS_WAIT_FOREVER
+ *
+ * @return  uint8_t - SNP_SUCCESS, SNP_OUT_OF_RESOURCES if there was no room
+ *                    in time
+ */
+uint8_t SNP_RPC_waitNotifIndCredit(uint8_t dataLen, uint32_t timeout)
+{
+#ifdef SNP_LOCAL
+  return SNP_SUCCESS;
+#else //!SNP_LOCAL
+  return NPITask_waitTxCredit(NOTIF_IND_REQ_LEN + dataLen, timeout) ?
+         SNP_SUCCESS : SNP_OUT_OF_RESOURCES;
+#endif //SNP_LOCAL
+}
+
+/*********************************************************************
+ * @fn      SNP_RPC_notifIndCredit
+ *
+ * @brief   Count the notification data bytes NPI can queue for the NP
+ *          without waiting, sent in notifications of up to chunk bytes
+ *
+ * @param   chunk - most data bytes per notification
+ *
+ * @return  uint16_t - data bytes that can be queued
+ */
+uint16_t SNP_RPC_notifIndCredit(uint16_t chunk)
+{
+#ifdef SNP_LOCAL
+  return 0xFFFF;
+#else //!SNP_LOCAL
+  uint16_t frames, bytes;
+  uint16_t avail = 0;
+
+  NPITask_getTxCredit(&frames, &bytes);
+  while (frames-- && bytes > NOTIF_IND_REQ_LEN)
+  {
+    uint16_t size = MIN(chunk, bytes - NOTIF_IND_REQ_LEN);
+
+    avail += size;
+    bytes -= NOTIF_IND_REQ_LEN + size;
+  }
+
+  return avail;
+#endif //SNP_LOCAL
+}
+
 /*********************************************************************
  * @fn      SNP_RPC_charConfigUpdatedRsp
  *
@@ -1199,16 +1551,14 @@ uint8_t SNP_RPC_charConfigUpdatedRsp(snpCharCfgUpdatedRsp_t *pReq)
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_ASYNC_CMD_TYPE, SNP_CCCD_UPDATED_CNF,
-                            sizeof(snpCharCfgUpdatedRsp_t));
+                            SNP_LEN_CharWriteCnf);
 
   if ( pPkt )
   {
     status = SNP_SUCCESS;
 
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = pReq->status;
-    pPkt->pData[1] = LO_UINT16(pReq->connHandle);
-    pPkt->pData[2] = HI_UINT16(pReq->connHandle);
+    // Copy members of response struct into packet
+    SNP_packCharWriteCnf(pPkt->pData, pReq);
 
     // Send Command
     SNP_sendAsyncCmd(pPkt);
@@ -1235,25 +1585,19 @@ uint8_t SNP_RPC_setGATTParam(snpSetGattParamReq_t *pReq, uint16_t dataLen,
 {
   _npiFrame_t *pPkt;
   uint8_t status = SNP_OUT_OF_RESOURCES;
-  uint16_t reqSize = sizeof(snpSetGattParamReq_t) - sizeof(pReq->pData);
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_SET_GATT_PARAM_REQ,
-                            reqSize + dataLen);
+                            SNP_LEN_SetGattParamReq + dataLen);
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
-
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = pReq->serviceID;
-    pPkt->pData[1] = pReq->paramID;
-
-    // Copy pointer members
-    memcpy(&pPkt->pData[reqSize], pReq->pData, dataLen);
+    // Copy the request, then the value behind it
+    memcpy(SNP_packSetGattParamReq(pPkt->pData, pReq), pReq->pData, dataLen);
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_SET_GATT_PARAM_REQ, (snp_msg_t *)pRsp, NULL);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_SET_GATT_PARAM_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -1281,19 +1625,54 @@ uint8_t SNP_RPC_getGATTParam(snpGetGattParamReq_t *pReq,
 
   // Allocated an empty data NPI packet.
   pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_GET_GATT_PARAM_REQ,
-                            sizeof(snpGetGattParamReq_t));
+                            SNP_LEN_GetGattParamReq);
 
   if ( pPkt )
   {
-    status = SNP_SUCCESS;
+    // Copy members of request struct into packet
+    SNP_packGetGattParamReq(pPkt->pData, pReq);
+
+    // Send a synchronous command.
+    status = SNP_sendSynchronousCmd(pPkt, SNP_GET_GATT_PARAM_REQ,
+                                    (snp_msg_t *)pRsp, dataLen);
+  }
+
+  // Return Status
+  return status;
+}
+#endif //SNP_LOCAL
 
-    // Copy non-pointer members of request struct
-    pPkt->pData[0] = pReq->serviceID;
-    pPkt->pData[1] = pReq->paramID;
+
+#ifndef SNP_LOCAL
+/*********************************************************************
+ * @fn      SNP_RPC_setAttrValue
+ *
+ * @brief   Write the value of a characteristic managed by the NP.
+ *
+ * @param   pReq - pointer to SNP request message
+ * @param   dataLen - Length of data field in request message
+ * @param   pRsp - pointer to SNP response message
+ *
+ * @return  uint8_t - SNP_SUCCESS
+ */
+uint8_t SNP_RPC_setAttrValue(snpSetAttrValueReq_t *pReq, uint16_t dataLen,
+                             snpSetAttrValueRsp_t *pRsp)
+{
+  _npiFrame_t *pPkt;
+  uint8_t status = SNP_OUT_OF_RESOURCES;
+
+  // Allocated an empty data NPI packet.
+  pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_SET_ATTR_VALUE_REQ,
+                            SNP_LEN_SetAttrValueReq + dataLen);
+
+  if ( pPkt )
+  {
+    // Copy the handle, then the value behind it
+    memcpy(SNP_packSetAttrValueReq(pPkt->pData, pReq), pReq->pData, dataLen);
 
     // Send a synchronous command.
-    SNP_sendSynchronousCmd(pPkt, SNP_GET_GATT_PARAM_REQ, (snp_msg_t *)&pRsp,
-                           dataLen);
+    status = SNP_sendSynchronousCmd(pPkt, SNP_SET_ATTR_VALUE_REQ,
+                                    (snp_msg_t *)pRsp, NULL);
   }
 
   // Return Status
@@ -1301,6 +1680,44 @@ uint8_t SNP_RPC_getGATTParam(snpGetGattParamReq_t *pReq,
 }
 #endif //SNP_LOCAL
 
+#ifndef SNP_LOCAL
+/*********************************************************************
+ * @fn      SNP_RPC_getAttrValue
+ *
+ * @brief   Read the value of a characteristic managed by the NP.
+ *
+ * @param   pReq - pointer to SNP request message
+ * @param   pRsp - pointer to SNP response message
+ * @param   dataLen - in: room in pRsp->pData, out: length of the value
+ *
+ * @return  uint8_t - SNP_SUCCESS, or SNP_OUT_OF_RESOURCES if the value did
+ *                    not fit. pRsp->pData then holds the first *dataLen
+ *                    bytes of it.
+ */
+uint8_t SNP_RPC_getAttrValue(snpGetAttrValueReq_t *pReq,
+                             snpGetAttrValueRsp_t *pRsp, uint16_t *dataLen)
+{
+  _npiFrame_t *pPkt;
+  uint8_t status = SNP_OUT_OF_RESOURCES;
+
+  // Allocated an empty data NPI packet.
+  pPkt = SNP_buildNPIPacket(SNP_NPI_SYNC_REQ_TYPE, SNP_GET_ATTR_VALUE_REQ,
+                            SNP_LEN_GetAttrValueReq);
+
+  if ( pPkt )
+  {
+    // Copy members of request struct into packet
+    SNP_packGetAttrValueReq(pPkt->pData, pReq);
+
+    // Send a synchronous command.
+    status = SNP_sendSynchronousCmd(pPkt, SNP_GET_ATTR_VALUE_REQ,
+                                    (snp_msg_t *)pRsp, dataLen);
+  }
+
+  // Return Status
+  return status;
+}
+#endif //SNP_LOCAL
 
 /*********************************************************************
 *********************************************************************/
@@ -52,17 +52,34 @@ extern "C"
  * CONSTANTS
  */
 
+// System ticks a synchronous request waits for its response unless
+// SNP_RPC_setSyncTimeout says otherwise.
+#ifndef SNP_SYNC_RSP_TIMEOUT
+#define SNP_SYNC_RSP_TIMEOUT  (1000000 / Clock_tickPeriod)
+#endif
+
+// Synchronous requests one batch can queue, see SNP_RPC_beginSyncBatch.
+// Each holds an NPI frame until it is sent, so keep it below the NPI frame
+// pool and NPITASK_QUEUE_SIZE.
+#ifndef SNP_SYNC_BATCH_DEPTH
+#define SNP_SYNC_BATCH_DEPTH  6
+#endif
+
   /*********************************************************************
  * TYPEDEFS
  */
 
 typedef void (* SNP_RPC_eventCBRouter_t)(snpEvt_t *pEvt);
 typedef void (* SNP_RPC_asyncCB_t)(uint8_t cmd1, snp_msg_t *pMsg, uint16_t msgLen);
+typedef bool (* SNP_RPC_fastWriteCB_t)(snpCharWriteInd_t *pInd, uint16_t len);
 
 typedef struct
 {
   uint16_t   len;     // Length of the received message
   snp_msg_t  *pMsg;   // SNP message format.  This is a pointer to the application's buffer.
+  uint8_t    opcode;  // Response being waited for, 0 while none is
+  uint8_t    status;  // SNP_CMD_REJECTED once the NP turned a request down
+  uint16_t   cap;     // Room in the application's buffer for a variable length value
 } snpSyncRspData_t;
 
 /*********************************************************************
@@ -82,6 +99,80 @@ typedef struct
 extern void SNP_RPC_registerSAPCBs(SNP_RPC_asyncCB_t asyncCB,
                                    SNP_RPC_eventCBRouter_t eventCB);
 
+/*********************************************************************
+ * @fn      SNP_RPC_registerFastWriteCB
+ *
+ * @brief   Register a callback offered every characteristic write
+ *          indication ahead of the SAP service table. It runs in the
+ *          NPI task, and returns true if it handled the write, including
+ *          the write confirmation.
+ *
+ * @param   fastWriteCB - pointer to fast write call back function, or NULL
+ *
+ * @return  none
+ */
+extern void SNP_RPC_registerFastWriteCB(SNP_RPC_fastWriteCB_t fastWriteCB);
+
+/*********************************************************************
+ * @fn      SNP_RPC_setSyncTimeout
+ *
+ * @brief   Set how long synchronous requests wait for their response.
+ *          A request that times out returns SNP_FAILURE and is cancelled,
+ *          a late response to it is dropped.
+ *
+ * @param   timeout - system ticks, BIOS_WAIT_FOREVER to never give up,
+ *                    0 for SNP_SYNC_RSP_TIMEOUT
+ *
+ * @return  none
+ */
+extern void SNP_RPC_setSyncTimeout(uint32_t timeout);
+
+/*********************************************************************
+ * @fn      SNP_RPC_beginSyncBatch
+ *
+ * @brief   Queue the synchronous requests of this task instead of sending
+ *          them, up to SNP_SYNC_BATCH_DEPTH, until SNP_RPC_endSyncBatch.
+ *          Requests that do not depend on each other's responses can then
+ *          go out back to back. Until the batch ends a queued request
+ *          returns SNP_SUCCESS and its response buffer is not filled in
+ *          yet. Synchronous requests of other tasks wait for the batch.
+ *
+ * @return  none
+ */
+extern void SNP_RPC_beginSyncBatch(void);
+
+/*********************************************************************
+ * @fn      SNP_RPC_endSyncBatch
+ *
+ * @brief   Send the requests queued since SNP_RPC_beginSyncBatch and wait
+ *          for all their responses. The NP answers one request at a time;
+ *          the NPI task sends the next as soon as a response is in.
+ *
+ * @return  uint8_t - SNP_SUCCESS, or SNP_FAILURE if the responses did not
+ *                    all arrive in time
+ */
+extern uint8_t SNP_RPC_endSyncBatch(void);
+
+/*********************************************************************
+ * @fn      SNP_RPC_syncBatchRoom
+ *
+ * @brief   Requests the open batch can still queue.
+ *
+ * @return  uint8_t - free batch entries, 0 if no batch is open
+ */
+extern uint8_t SNP_RPC_syncBatchRoom(void);
+
+/*********************************************************************
+ * @fn      SNP_RPC_syncRspReceived
+ *
+ * @brief   Called by the NPI subsystem once the response to the pending
+ *          synchronous request is copied. Moves on to the next response of
+ *          a batch, or wakes the requesting task.
+ *
+ * @return  none
+ */
+extern void SNP_RPC_syncRspReceived(void);
+
 /*********************************************************************
  * FUNCTIONS
  */
@@ -154,6 +245,34 @@ extern uint8_t SNP_RPC_testCommand(void);
  */
 extern uint8_t SNP_RPC_getStatus(snpGetStatusCmdRsp_t *pRsp);
 
+/*********************************************************************
+ * @fn      SNP_RPC_getStatusTimeout
+ *
+ * @brief   Get SNP status, giving up if the NP does not answer in time
+ *
+ * @param   pRsp    - pointer to SNP response message
+ * @param   timeout - system ticks to wait for the response
+ *
+ * @return  uint8_t - SNP_SUCCESS, SNP_FAILURE if no response arrived
+ */
+extern uint8_t SNP_RPC_getStatusTimeout(snpGetStatusCmdRsp_t *pRsp,
+                                        uint32_t timeout);
+
+/*********************************************************************
+ * @fn      SNP_RPC_setPortBitRate
+ *
+ * @brief   Ask the NP to move its UART to a new bit rate
+ *
+ * @param   pReq    - pointer to SNP request message
+ * @param   pRsp    - pointer to SNP response message
+ * @param   timeout - system ticks to wait for the response
+ *
+ * @return  uint8_t - SNP_SUCCESS, SNP_FAILURE if no response arrived
+ */
+extern uint8_t SNP_RPC_setPortBitRate(snpSetPortBitRateReq_t *pReq,
+                                      snpSetPortBitRateRsp_t *pRsp,
+                                      uint32_t timeout);
+
 /*********************************************************************
  * @fn      SNP_RPC_startAdvertising
  *
@@ -353,6 +472,20 @@ extern uint8_t SNP_RPC_addCharDescDec(snpAddCharDescDeclReq_t *pReq,
  */
 extern uint8_t SNP_RPC_registerService(snpRegisterServiceRsp_t *pRsp);
 
+/*********************************************************************
+ * @fn      SNP_RPC_allocReadCharCnf
+ *
+ * @brief   Allocate the confirmation to a characteristic read request
+ *          ahead of reading the value, so it can be read straight into the
+ *          frame. Pass the returned buffer as pData to SNP_RPC_readCharCnf.
+ *          Only one may be outstanding at a time.
+ *
+ * @param   maxSize - longest value the confirmation may carry
+ *
+ * @return  uint8_t * - buffer for the value, NULL if out of memory
+ */
+extern uint8_t *SNP_RPC_allocReadCharCnf(uint16_t maxSize);
+
 /*********************************************************************
  * @fn      SNP_RPC_readCharCnf
  *
@@ -388,6 +521,32 @@ extern uint8_t SNP_RPC_writeCharCnf(snpCharWriteCnf_t *pCnf);
  */
 extern uint8_t SNP_RPC_sendNotifInd(snpNotifIndReq_t *pReq, uint8_t dataLen);
 
+/*********************************************************************
+ * @fn      SNP_RPC_waitNotifIndCredit
+ *
+ * @brief   Wait until NPI has room to queue a notification of dataLen
+ *          bytes for the NP
+ *
+ * @param   dataLen - length of the notification data payload
+ * @param   timeout - system ticks to wait, BIOS_NO_WAIT or BIOS_WAIT_FOREVER
+ *
+ * @return  uint8_t - SNP_SUCCESS, SNP_OUT_OF_RESOURCES if there was no room
+ *                    in time
+ */
+extern uint8_t SNP_RPC_waitNotifIndCredit(uint8_t dataLen, uint32_t timeout);
+
+/*********************************************************************
+ * @fn      SNP_RPC_notifIndCredit
+ *
+ * @brief   Count the notification data bytes NPI can queue for the NP
+ *          without waiting, sent in notifications of up to chunk bytes
+ *
+ * @param   chunk - most data bytes per notification
+ *
+ * @return  uint16_t - data bytes that can be queued
+ */
+extern uint16_t SNP_RPC_notifIndCredit(uint16_t chunk);
+
 /*********************************************************************
  * @fn      SNP_RPC_charConfigUpdatedRsp
  *
@@ -429,6 +588,38 @@ extern uint8_t SNP_RPC_getGATTParam(snpGetGattParamReq_t *pReq,
                                     snpGetGattParamRsp_t *pRsp,
                                     uint16_t *dataLen);
 
+/*********************************************************************
+ * @fn      SNP_RPC_setAttrValue
+ *
+ * @brief   Write the value of a characteristic managed by the NP.
+ *
+ * @param   pReq - pointer to SNP request message
+ * @param   dataLen - Length of data field in request message
+ * @param   pRsp - pointer to SNP response message
+ *
+ * @return  uint8_t - SNP_RPC_SUCCESS
+ */
+extern uint8_t SNP_RPC_setAttrValue(snpSetAttrValueReq_t *pReq, uint16_t dataLen,
+                                    snpSetAttrValueRsp_t *pRsp);
+
+/*********************************************************************
+ * @fn      SNP_RPC_getAttrValue
+ *
+ * @brief   Read the value of a characteristic managed by the NP.
+ *
+ * @param   pReq - pointer to SNP request message
+ * @param   pRsp - pointer to SNP response message, pData pointing to a
+ *                 buffer as long as the characteristic's maximum length
+ * @param   dataLen - in: room in pRsp->pData, out: length of the value
+ *
+ * @return  uint8_t - SNP_SUCCESS, or SNP_OUT_OF_RESOURCES if the value did
+ *                    not fit. pRsp->pData then holds the first *dataLen
+ *                    bytes of it.
+ */
+extern uint8_t SNP_RPC_getAttrValue(snpGetAttrValueReq_t *pReq,
+                                    snpGetAttrValueRsp_t *pRsp,
+                                    uint16_t *dataLen);
+
 /*********************************************************************
 *********************************************************************/
 
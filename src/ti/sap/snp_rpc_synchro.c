@@ -123,6 +123,12 @@ void SNP_waitForResponse(void)
   Semaphore_pend(waitRsp_sem, BIOS_WAIT_FOREVER);
 }
 
+bool SNP_waitForResponseTimeout(uint32_t timeout)
+{
+  // Wait for a response, give up after timeout system ticks.
+  return Semaphore_pend(waitRsp_sem, timeout);
+}
+
 
 void SNP_responseReceived(void)
 {
@@ -46,6 +46,8 @@ extern "C"
 #include <ti/sysbios/knl/Event.h>
 #endif //SNP_LOCAL
 
+#include <stdbool.h>
+
 #include <ti/npi/npi_data.h>
 
 /*********************************************************************
@@ -109,6 +111,10 @@ extern void SNP_exitCS(void);
 // Block an application until a response is received.
 extern void SNP_waitForResponse(void);
 
+// Block an application until a response is received or timeout (in system
+// ticks) expires. Returns false on timeout.
+extern bool SNP_waitForResponseTimeout(uint32_t timeout);
+
 // Unblock application from running.
 extern void SNP_responseReceived(void);
 #endif //SNP_LOCAL